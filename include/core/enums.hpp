@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string_view>
+
+namespace taxbroker {
+
+// Inventory list of a Doh-KDVP item. Only PLVP (securities) is generated today.
+enum class InventoryListType {
+    PLVP,
+    PLVPSHORT,
+    PLVPGB,
+    PLVPGBSHORT,
+    PLD,
+    PLVPZOK
+};
+
+// Method of acquisition (F2). Exchange purchases are always B.
+enum class GainType {
+    A, // Investment of capital.
+    B, // Purchase.
+    C, // Capital increase from the company's own resources.
+    D, // No data.
+    E, // Change of capital.
+    F, // Inheritance.
+    G, // Gift.
+};
+
+enum class FormType {
+    Original,
+    SelfReport
+};
+
+enum class DhoPayer {
+    TradeRepublic,
+    Unknown
+};
+
+[[nodiscard]] constexpr std::string_view ToString(InventoryListType aType) noexcept {
+    switch (aType) {
+    case InventoryListType::PLVP:
+        return "PLVP";
+    case InventoryListType::PLVPSHORT:
+        return "PLVPSHORT";
+    case InventoryListType::PLVPGB:
+        return "PLVPGB";
+    case InventoryListType::PLVPGBSHORT:
+        return "PLVPGBSHORT";
+    case InventoryListType::PLD:
+        return "PLD";
+    case InventoryListType::PLVPZOK:
+        return "PLVPZOK";
+    }
+    return "PLVP";
+}
+
+[[nodiscard]] constexpr std::string_view ToString(GainType aType) noexcept {
+    switch (aType) {
+    case GainType::A:
+        return "A";
+    case GainType::B:
+        return "B";
+    case GainType::C:
+        return "C";
+    case GainType::D:
+        return "D";
+    case GainType::E:
+        return "E";
+    case GainType::F:
+        return "F";
+    case GainType::G:
+        return "G";
+    }
+    return "B";
+}
+
+// DocumentWorkflowName of the form.
+[[nodiscard]] constexpr std::string_view ToString(FormType aType) noexcept {
+    return aType == FormType::SelfReport ? "SelfReport" : "Original";
+}
+
+// DocumentWorkflowID of the form.
+[[nodiscard]] constexpr std::string_view WorkflowId(FormType aType) noexcept {
+    return aType == FormType::SelfReport ? "S" : "O";
+}
+
+} // namespace taxbroker
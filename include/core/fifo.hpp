@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "taxbroker/types.hpp"
+
+namespace taxbroker {
+
+/*
+    Buy lot still (partially) held after FIFO matching.
+    mConsumed is the partial-consumption offset: units of the lot already
+    matched against sells. Remaining units are mUnits - mConsumed.
+*/
+struct OpenLot {
+    Date mDate{};
+    Money mUnitPrice{};
+    Units mUnits{};
+    Units mConsumed{};
+    Currency mCurrency{Currency::EUR};
+    std::uint32_t mTransactionIndex{}; // Index of the originating buy transaction.
+};
+
+/*
+    One slice of a sell matched against one buy lot.
+    A sell spanning several lots produces one slice per consumed lot.
+*/
+struct LotMatch {
+    std::uint32_t mSellIndex{};
+    std::uint32_t mBuyIndex{};
+    Date mBuyDate{};
+    Date mSellDate{};
+    Money mBuyUnitPrice{};
+    Money mSellUnitPrice{};
+    Units mUnits{};
+    Currency mBuyCurrency{Currency::EUR}; // Not EUR when FX normalization had no rate.
+    Currency mSellCurrency{Currency::EUR};
+};
+
+/*
+    Original buys inside a compacted lot: mCount buys of mUnits each with consecutive
+    transaction indices starting at mTransactionIndex. Parts are kept in FIFO order,
+    so the parts of consecutive lots form a single queue consumed alongside the lots.
+*/
+struct LotPart {
+    std::uint32_t mTransactionIndex{};
+    Units mUnits{};
+    std::uint32_t mCount{1};
+};
+
+/*
+    Open-lot state of one instrument after the last transaction of mYear.
+    Resuming FIFO from a snapshot plus later transactions gives the same matches as
+    replaying the whole history, while only the new transactions are processed.
+*/
+struct OpenLotSnapshot {
+    Isin mIsin;
+    int mYear{};
+    std::uint32_t mNextTransactionIndex{}; // Index assigned to the first transaction after mYear.
+    std::vector<OpenLot> mOpenLots;        // Oldest first.
+};
+
+/*
+    Contiguous FIFO queue of open lots or their parts.
+
+    Elements live in a power-of-two ring buffer addressed by a head index, so consuming
+    from the front never shifts the remaining ones (no vector front erase). Growing
+    the ring relinearizes it once; the amortized cost per element stays O(1).
+*/
+template <typename Element>
+class FifoRing {
+  public:
+    FifoRing() = default;
+
+    [[nodiscard]] bool empty() const noexcept {
+        return mSize == 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return mSize;
+    }
+
+    void reserve(std::size_t aCapacity) {
+        if (aCapacity > mSlots.size()) {
+            relinearize(RoundUpToPowerOfTwo(aCapacity));
+        }
+    }
+
+    void pushBack(const Element& aElement) {
+        if (mSize == mSlots.size()) {
+            relinearize(mSlots.empty() ? kInitialCapacity : mSlots.size() * 2);
+        }
+        mSlots[(mHead + mSize) & (mSlots.size() - 1)] = aElement;
+        ++mSize;
+    }
+
+    [[nodiscard]] Element& front() noexcept {
+        return mSlots[mHead];
+    }
+
+    [[nodiscard]] const Element& front() const noexcept {
+        return mSlots[mHead];
+    }
+
+    [[nodiscard]] Element& back() noexcept {
+        return mSlots[(mHead + mSize - 1) & (mSlots.size() - 1)];
+    }
+
+    void popFront() noexcept {
+        mHead = (mHead + 1) & (mSlots.size() - 1);
+        --mSize;
+    }
+
+    // Element at FIFO position aIndex (0 is the oldest).
+    [[nodiscard]] const Element& operator[](std::size_t aIndex) const noexcept {
+        return mSlots[(mHead + aIndex) & (mSlots.size() - 1)];
+    }
+
+    [[nodiscard]] std::vector<Element> toVector() const {
+        std::vector<Element> elements;
+        elements.reserve(mSize);
+        for (std::size_t index = 0; index < mSize; ++index) {
+            elements.push_back((*this)[index]);
+        }
+        return elements;
+    }
+
+  private:
+    static constexpr std::size_t kInitialCapacity = 16;
+
+    static std::size_t RoundUpToPowerOfTwo(std::size_t aValue) {
+        std::size_t capacity = kInitialCapacity;
+        while (capacity < aValue) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    void relinearize(std::size_t aCapacity) {
+        std::vector<Element> slots(aCapacity);
+        for (std::size_t index = 0; index < mSize; ++index) {
+            slots[index] = (*this)[index];
+        }
+        mSlots.swap(slots);
+        mHead = 0;
+    }
+
+    std::vector<Element> mSlots;
+    std::size_t mHead{};
+    std::size_t mSize{};
+};
+
+using LotRing = FifoRing<OpenLot>;
+
+} // namespace taxbroker
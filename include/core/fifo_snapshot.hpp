@@ -0,0 +1,31 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/fifo.hpp"
+
+namespace taxbroker {
+
+/*
+    Compact binary encoding of year-end open-lot snapshots.
+    Lots are stored as varints with date and price deltas against the previous lot,
+    so a snapshot costs a few bytes per open lot.
+*/
+[[nodiscard]] std::string SerializeSnapshots(std::span<const OpenLotSnapshot> aSnapshots);
+
+// Returns std::nullopt for truncated, corrupted or foreign data.
+[[nodiscard]] std::optional<std::vector<OpenLotSnapshot>>
+DeserializeSnapshots(std::string_view aBuffer);
+
+[[nodiscard]] bool WriteSnapshotFile(const std::filesystem::path& aPath,
+                                     std::span<const OpenLotSnapshot> aSnapshots);
+
+[[nodiscard]] std::optional<std::vector<OpenLotSnapshot>>
+ReadSnapshotFile(const std::filesystem::path& aPath);
+
+} // namespace taxbroker
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/fifo.hpp"
+#include "taxbroker/types.hpp"
+
+namespace taxbroker {
+
+// Decoded provenance of one lot slice: which buy a sell consumed and how much of it.
+struct AuditEntry {
+    std::uint32_t mSellIndex{};
+    std::uint32_t mBuyIndex{};
+    Date mSellDate{};
+    Date mBuyDate{};
+    Units mUnits{};
+};
+
+/*
+    Compact, always-on record of FIFO match provenance, queryable by scope, ISIN and
+    sell date. A scope separates the runs sharing one log, e.g. the taxpayers of a
+    batch; runs in different scopes never touch each other's entries.
+
+    Every instrument of a scope owns one byte log. Slices are appended in sell order as varints of
+    deltas against the previous slice (sell index, buy index, sell day) plus the holding
+    days and units, which keeps a slice at a handful of bytes. Every CHECKPOINT_INTERVAL
+    slices a checkpoint stores the decoder state, so a date-range query binary-searches
+    the checkpoints and decodes only from the one before the range.
+
+    Thread-safe; the FIFO stages of several instruments may record concurrently.
+*/
+class MatchAuditLog {
+  public:
+    static constexpr std::size_t CHECKPOINT_INTERVAL = 64;
+
+    // Replaces the slices of aIsin in aScope with those of one matching run.
+    void record(std::string_view aScope, std::string_view aIsin,
+                std::span<const LotMatch> aMatches);
+
+    // Appends the slices of a run resumed from a snapshot of the recorded one.
+    void extend(std::string_view aScope, std::string_view aIsin,
+                std::span<const LotMatch> aMatches);
+
+    // Slices of aIsin in aScope whose sell date lies in [aFrom, aTo], in sell order.
+    [[nodiscard]] std::vector<AuditEntry> query(std::string_view aScope, std::string_view aIsin,
+                                                Date aFrom, Date aTo) const;
+
+    [[nodiscard]] std::size_t entryCount() const;
+
+    [[nodiscard]] std::size_t encodedBytes() const;
+
+  private:
+    struct DecoderState {
+        std::uint32_t mSellIndex{};
+        std::uint32_t mBuyIndex{};
+        std::int32_t mSellDay{};
+    };
+
+    struct Checkpoint {
+        std::size_t mOffset{}; // Byte offset of the first slice after the checkpoint.
+        DecoderState mState;   // State before that slice.
+    };
+
+    struct InstrumentLog {
+        std::string mBytes;
+        std::vector<Checkpoint> mCheckpoints;
+        DecoderState mLast;
+        std::size_t mCount{};
+    };
+
+    using ScopeLogs = std::unordered_map<std::string, InstrumentLog>; // By ISIN.
+
+    static void append(InstrumentLog& aLog, const LotMatch& aMatch);
+
+    mutable std::mutex mMutex;
+    std::unordered_map<std::string, ScopeLogs> mScopes;
+};
+
+} // namespace taxbroker
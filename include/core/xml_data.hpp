@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/enums.hpp"
+#include "taxbroker/types.hpp"
+
+namespace taxbroker {
+
+/*
+    Form model of the FURS Doh-KDVP, Doh-Div and Doh-DHO documents.
+    Field names follow the form columns (F1..F11); amounts are fixed-point and
+    in EUR, so generators format them without a floating-point round trip.
+*/
+
+/*
+    One row of an inventory list: a purchase (F1..F5, F11) or a sale (F6, F7, F9,
+    F10), and the stock after it (F8). Both kinds share the date, quantity and
+    per-unit value, and mFields says which fields are present, so a row is a
+    small block of plain data that the generator writes without optional checks.
+*/
+struct KdvpRow {
+    // Bits of mFields.
+    static constexpr std::uint16_t SALE = 1U << 0;       // Sale row, else purchase.
+    static constexpr std::uint16_t DATE = 1U << 1;       // F1 or F6.
+    static constexpr std::uint16_t F2 = 1U << 2;         // Purchase only.
+    static constexpr std::uint16_t QUANTITY = 1U << 3;   // F3 or F7.
+    static constexpr std::uint16_t UNIT_VALUE = 1U << 4; // F4 or F9.
+    static constexpr std::uint16_t F5 = 1U << 5;         // Purchase only.
+    static constexpr std::uint16_t F11 = 1U << 6;        // Purchase only.
+    static constexpr std::uint16_t F10 = 1U << 7;        // Sale only.
+    static constexpr std::uint16_t F8 = 1U << 8;
+
+    Date mDate{};         // Date of acquisition (F1) or disposal (F6).
+    Units mQuantity{};    // F3 or F7.
+    Money mUnitValue{};   // Value per unit at purchase (F4) or disposal (F9).
+    Money mF5{};          // Inheritance and gift tax paid.
+    Money mF11{};         // Reduced purchase value per unit.
+    Units mF8{};          // Stock after the row; may be negative.
+    std::int32_t mId{};
+    GainType mF2{GainType::B}; // Method of acquisition.
+    std::uint16_t mFields{};
+    bool mF10{false}; // Loss disallowed by the repurchase rule (97.č ZDoh-2).
+
+    [[nodiscard]] constexpr bool isSale() const noexcept {
+        return (mFields & SALE) != 0;
+    }
+
+    [[nodiscard]] constexpr bool has(std::uint16_t aField) const noexcept {
+        return (mFields & aField) != 0;
+    }
+};
+
+// Purchase row with F1 to F4.
+[[nodiscard]] constexpr KdvpRow MakePurchaseRow(Date aF1, GainType aF2, Units aF3,
+                                                Money aF4) noexcept {
+    KdvpRow row;
+    row.mDate = aF1;
+    row.mF2 = aF2;
+    row.mQuantity = aF3;
+    row.mUnitValue = aF4;
+    row.mFields = KdvpRow::DATE | KdvpRow::F2 | KdvpRow::QUANTITY | KdvpRow::UNIT_VALUE;
+    return row;
+}
+
+// Sale row with F6, F7, F9 and F10.
+[[nodiscard]] constexpr KdvpRow MakeSaleRow(Date aF6, Units aF7, Money aF9, bool aF10) noexcept {
+    KdvpRow row;
+    row.mDate = aF6;
+    row.mQuantity = aF7;
+    row.mUnitValue = aF9;
+    row.mF10 = aF10;
+    row.mFields = KdvpRow::SALE | KdvpRow::DATE | KdvpRow::QUANTITY | KdvpRow::UNIT_VALUE |
+                  KdvpRow::F10;
+    return row;
+}
+
+struct Securities {
+    std::optional<Isin> mIsin;
+    std::optional<std::string> mCode; // Ticker.
+    std::string mName;
+    bool mIsFond{false};
+    std::optional<std::string> mResolution;
+    std::optional<Date> mResolutionDate;
+    std::vector<KdvpRow> mRows;
+};
+
+struct KdvpItem {
+    std::optional<int> mItemId;
+    InventoryListType mType{InventoryListType::PLVP};
+    std::optional<bool> mHasForeignTax;
+    std::optional<Money> mForeignTaxAmount;
+    std::optional<std::string> mForeignCountryId;
+    std::optional<Securities> mSecurities;
+};
+
+struct DivPayer {
+    std::optional<std::string> mTaxId;
+    Isin mIsin;
+    std::optional<std::string> mName;
+    std::optional<std::string> mAddress;
+    std::optional<std::string> mCountryCode;
+};
+
+struct DivItem {
+    Date mDate{};
+    DivPayer mPayer;
+    std::string mType{"1"}; // 1 regular dividend, 2 non-natural person, 3 loan gains.
+    Money mGrossIncome{};
+    std::optional<Money> mWithholdingTax;
+    std::optional<std::string> mSourceCountryCode;
+    std::optional<bool> mForeignTaxPaid{true};
+};
+
+struct DhoItem {
+    DhoPayer mPayer{DhoPayer::TradeRepublic};
+    Money mAmount{};      // Non-negative.
+    Money mWithholdTax{}; // Non-negative.
+};
+
+struct FormData {
+    FormType mDocId{FormType::Original};
+    int mYear{};
+    bool mIsResident{true};
+    std::optional<std::string> mTelephoneNumber;
+    std::optional<std::string> mEmail;
+};
+
+struct DohKdvpData : FormData {
+    std::vector<KdvpItem> mItems;
+};
+
+struct DohDivData : FormData {
+    std::vector<DivItem> mItems;
+};
+
+struct DohDhoData : FormData {
+    std::vector<DhoItem> mItems;
+};
+
+struct TaxPayer {
+    std::string mTaxNumber;  // 8 digits.
+    std::string mType{"FO"}; // FO: natural person.
+    std::optional<std::string> mName;
+    std::optional<std::string> mAddress1;
+    std::optional<std::string> mAddress2;
+    std::optional<std::string> mCity;
+    std::optional<std::string> mPostNumber;
+    std::optional<std::string> mPostName;
+    std::optional<Date> mBirthDate;
+    bool mResident{true};
+};
+
+} // namespace taxbroker
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "taxbroker/types.hpp"
+
+namespace taxbroker {
+
+// Stable date sort; same-day transactions keep their input order. No-op if already sorted.
+template <typename Transaction>
+void SortByDate(std::vector<Transaction>& aTransactions) {
+    const auto byDate = [](const Transaction& aLeft, const Transaction& aRight) {
+        return aLeft.mDate < aRight.mDate;
+    };
+    if (!std::is_sorted(aTransactions.begin(), aTransactions.end(), byDate)) {
+        std::stable_sort(aTransactions.begin(), aTransactions.end(), byDate);
+    }
+}
+
+// Half-open range of transaction positions.
+struct YearRange {
+    std::size_t mBegin{};
+    std::size_t mEnd{};
+
+    [[nodiscard]] bool empty() const noexcept {
+        return mBegin == mEnd;
+    }
+};
+
+/*
+    Year -> [begin, end) offset table over one instrument's date-sorted transactions.
+
+    Built in one pass over the dates; afterwards a stage interested in one year reads
+    its range and sell flag in O(1) instead of scanning the whole history, and can skip
+    an instrument outright when the year has nothing to report.
+    Example:
+        2022: [0, 3), 2023: [3, 3), 2024: [3, 7)
+*/
+class YearIndex {
+  public:
+    YearIndex() = default;
+
+    // aTransactions must be sorted by date (see SortByDate).
+    explicit YearIndex(std::span<const TradeTransaction> aTransactions);
+
+    explicit YearIndex(std::span<const DividendTransaction> aTransactions);
+
+    [[nodiscard]] bool empty() const noexcept {
+        return mOffsets.empty();
+    }
+
+    [[nodiscard]] int firstYear() const noexcept {
+        return mFirstYear;
+    }
+
+    [[nodiscard]] int lastYear() const noexcept {
+        return mFirstYear + static_cast<int>(mHasSells.size()) - 1;
+    }
+
+    [[nodiscard]] YearRange range(int aYear) const noexcept {
+        if (!covers(aYear)) {
+            return {};
+        }
+        const auto slot = static_cast<std::size_t>(aYear - mFirstYear);
+        return YearRange{mOffsets[slot], mOffsets[slot + 1]};
+    }
+
+    [[nodiscard]] bool hasTransactions(int aYear) const noexcept {
+        return !range(aYear).empty();
+    }
+
+    // Always false for dividend indices.
+    [[nodiscard]] bool hasSells(int aYear) const noexcept {
+        return covers(aYear) && mHasSells[static_cast<std::size_t>(aYear - mFirstYear)] != 0;
+    }
+
+  private:
+    template <typename Transaction>
+    void build(std::span<const Transaction> aTransactions);
+
+    [[nodiscard]] bool covers(int aYear) const noexcept {
+        return !mOffsets.empty() && aYear >= mFirstYear && aYear <= lastYear();
+    }
+
+    int mFirstYear{};
+    std::vector<std::size_t> mOffsets;  // mOffsets[y - mFirstYear] = first position of year y.
+    std::vector<std::uint8_t> mHasSells; // One flag per year.
+};
+
+} // namespace taxbroker
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+#include "core/xml_data.hpp"
+#include "generators/xml_generator.hpp"
+#include "taxbroker/final_report.hpp"
+
+namespace taxbroker {
+
+/*
+    One interest line per interest payment of the report's tax year. Interest is
+    only parsed from Trade Republic statements, so every line names that payer.
+    Payments whose currency had no EUR rate are left out with a logged warning.
+*/
+[[nodiscard]] DohDhoData BuildDhoData(const FinalReport& aReport, const FormData& aForm);
+
+// Streams the complete Doh-DHO document of aData into aWriter, totals included.
+void WriteDho(XmlWriter& aWriter, const DohDhoData& aData, const TaxPayer& aTaxPayer);
+
+// Doh-DHO document of aData as a string.
+[[nodiscard]] std::string GenerateDho(const DohDhoData& aData, const TaxPayer& aTaxPayer);
+
+} // namespace taxbroker
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+#include "core/xml_data.hpp"
+#include "generators/xml_generator.hpp"
+#include "taxbroker/final_report.hpp"
+
+namespace taxbroker {
+
+/*
+    One Dividend line per aggregated (payer, day) group of the report's tax year.
+    Groups whose currency had no EUR rate are left out with a logged warning.
+*/
+[[nodiscard]] DohDivData BuildDivData(const FinalReport& aReport, const FormData& aForm);
+
+// Streams the complete Doh-Div document of aData into aWriter.
+void WriteDiv(XmlWriter& aWriter, const DohDivData& aData, const TaxPayer& aTaxPayer);
+
+// Doh-Div document of aData as a string.
+[[nodiscard]] std::string GenerateDiv(const DohDivData& aData, const TaxPayer& aTaxPayer);
+
+} // namespace taxbroker
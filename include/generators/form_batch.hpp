@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/xml_data.hpp"
+#include "generators/xml_schema.hpp"
+
+namespace taxbroker {
+
+// Small forms of one taxpayer in a bulk filing; absent forms are skipped.
+struct BatchFiling {
+    TaxPayer mTaxPayer;
+    std::optional<DohDivData> mDiv;
+    std::optional<DohDhoData> mDho;
+};
+
+// A rendered document: its bytes in FormBatch::mArena, its file name in mFileNames.
+struct BatchDocument {
+    std::size_t mFiling{}; // Index of the BatchFiling.
+    XmlSchema mForm{XmlSchema::DohDiv};
+    std::size_t mOffset{};
+    std::size_t mLength{};
+    std::size_t mFileNameOffset{};
+    std::size_t mFileNameLength{};
+};
+
+struct FormBatch {
+    std::string mArena;     // All documents back to back.
+    std::string mFileNames; // <tax number>_<year>_Doh_Div.xml or _Doh_DHO.xml, back to back.
+    std::vector<BatchDocument> mDocuments; // In filing order, Doh-Div before Doh-DHO.
+    std::vector<std::string> mErrors; // Schema violations and skipped filings, by file name.
+
+    [[nodiscard]] std::string_view document(const BatchDocument& aDocument) const noexcept {
+        return std::string_view{mArena}.substr(aDocument.mOffset, aDocument.mLength);
+    }
+
+    [[nodiscard]] std::string_view fileName(const BatchDocument& aDocument) const noexcept {
+        return std::string_view{mFileNames}.substr(aDocument.mFileNameOffset,
+                                                   aDocument.mFileNameLength);
+    }
+};
+
+/*
+    Renders the Doh-Div and Doh-DHO documents of many taxpayers into one arena,
+    reserved up front from the item counts. One XmlWriter and one validator per
+    form are reused for every document, so a document costs its content and not
+    the setup of a writer; the envelope comes from the shared skeletons. Filings
+    whose tax number is not alphanumeric are skipped, as it names their files, and
+    so is a document with the tax number, year and form of an earlier one.
+*/
+[[nodiscard]] FormBatch RenderFormBatch(std::span<const BatchFiling> aFilings);
+
+/*
+    Writes every document of aBatch to its own file in aDirectory in one pass:
+    the directory is opened once and each file is created relative to it and
+    written with a single write, without stdio. File names are unique within a
+    batch; files left by an earlier run are replaced.
+    Returns the number of files written; failures are logged.
+*/
+[[nodiscard]] std::size_t WriteFormBatch(const FormBatch& aBatch, const std::string& aDirectory);
+
+} // namespace taxbroker
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/xml_data.hpp"
+#include "generators/fragment_cache.hpp"
+#include "taxbroker/final_report.hpp"
+#include "utils/thread_pool.hpp"
+#include "utils/zip_writer.hpp"
+
+namespace taxbroker {
+
+// Entries of a form bundle, see WriteFormBundle().
+constexpr std::string_view BUNDLE_KDVP_ENTRY = "Doh_KDVP.xml";
+constexpr std::string_view BUNDLE_DIV_ENTRY = "Doh_Div.xml";
+constexpr std::string_view BUNDLE_DHO_ENTRY = "Doh_DHO.xml";
+constexpr std::string_view BUNDLE_AUDIT_ENTRY = "audit/matches.csv";
+
+struct FormSelection {
+    bool mKdvp{true};
+    bool mDiv{true};
+    bool mDho{true};
+};
+
+// Rendered documents; a form is empty when it was not selected.
+struct GeneratedForms {
+    std::optional<std::string> mKdvp;
+    std::optional<std::string> mDiv;
+    std::optional<std::string> mDho;
+    std::vector<std::string> mValidationErrors; // Schema violations of all forms, see XmlValidator.
+};
+
+/*
+    Renders the selected forms of one computed report at the same time on aPool.
+    The report is only read, so the generators share it without copies or locks.
+    Doh-Div and Doh-DHO run as pool tasks while the calling thread renders Doh-KDVP,
+    whose items are spread over the pool as well. aKdvpCache is passed on to
+    WriteKdvp() to reuse the fragments of unchanged securities. Every form is
+    validated against its schema while it is written.
+*/
+[[nodiscard]] GeneratedForms GenerateForms(const FinalReport& aReport, const FormData& aForm,
+                                           const TaxPayer& aTaxPayer, ThreadPool& aPool,
+                                           FormSelection aSelection = {},
+                                           FragmentCache* aKdvpCache = nullptr);
+
+/*
+    Streams the selected forms of aReport into aArchive, followed by an audit trail
+    of its FIFO matches (isin, indices, dates, units and unit prices as CSV). Doh-KDVP
+    goes from the XmlWriter straight into its entry; Doh-Div and Doh-DHO, which are
+    small, are rendered on aPool meanwhile and added after it. Nothing is written to
+    intermediate files. The archive is left open for more entries; call finish() on
+    it. Returns the schema violations of all forms.
+*/
+[[nodiscard]] std::vector<std::string>
+WriteFormBundle(ZipWriter& aArchive, const FinalReport& aReport, const FormData& aForm,
+                const TaxPayer& aTaxPayer, ThreadPool& aPool, FormSelection aSelection = {},
+                FragmentCache* aKdvpCache = nullptr);
+
+} // namespace taxbroker
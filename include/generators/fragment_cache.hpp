@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "utils/hash.hpp"
+#include "utils/lru_byte_cache.hpp"
+
+namespace taxbroker {
+
+/*
+    Thread-safe LRU cache of rendered XML fragments, keyed by a content hash of
+    everything the fragment is rendered from. Entries are charged by their byte size;
+    inserting beyond the memory budget evicts the least recently used entries first.
+*/
+class FragmentCache : private LruByteCache<ContentHash, std::string, ContentHashHasher> {
+  public:
+    using LruByteCache::LruByteCache;
+
+    using LruByteCache::find;
+    using LruByteCache::hitCount;
+    using LruByteCache::memoryUsage;
+    using LruByteCache::missCount;
+    using LruByteCache::size;
+
+    void insert(const ContentHash& aKey, std::shared_ptr<const std::string> aFragment);
+};
+
+} // namespace taxbroker
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "core/xml_data.hpp"
+#include "generators/fragment_cache.hpp"
+#include "generators/xml_generator.hpp"
+#include "generators/xml_validator.hpp"
+#include "taxbroker/final_report.hpp"
+#include "utils/hash.hpp"
+#include "utils/thread_pool.hpp"
+
+namespace taxbroker {
+
+// Bump whenever the XML of a KDVPItem changes, so cached fragments are not reused.
+constexpr std::uint32_t KDVP_RENDER_VERSION = 2;
+
+// Render tasks per pool thread; several per thread let idle workers steal uneven items.
+constexpr std::size_t KDVP_CHUNKS_PER_THREAD = 4;
+
+// Items the pool WriteKdvp() renders before writing them; bounds the fragments in memory.
+constexpr std::size_t KDVP_BATCH_ITEMS = 1024;
+
+/*
+    One PLVP item per instrument sold in the report's tax year. Rows show the buys
+    consumed by those sales and the sales themselves, in date order, so the running
+    stock (F8) ends at zero. An instrument with a match in a currency that had no
+    EUR rate is left out with a logged warning, as partial rows would break F8.
+*/
+[[nodiscard]] DohKdvpData BuildKdvpData(const FinalReport& aReport, const FormData& aForm);
+
+// Streams the complete Doh-KDVP document of aData into aWriter, one KDVPItem at a time.
+void WriteKdvp(XmlWriter& aWriter, const DohKdvpData& aData, const TaxPayer& aTaxPayer);
+
+/*
+    Same document as the serial overload. Items are rendered to separate fragments
+    on aPool, KDVP_BATCH_ITEMS at a time, and each batch is spliced into aWriter in
+    item order with one XmlWriter::fragments() call, so a streaming writer never holds
+    more than one batch. With aCache, unchanged items reuse their fragment
+    from the previous run, so regeneration costs only what changed. A validator on
+    aWriter also checks every item while it is rendered.
+*/
+void WriteKdvp(XmlWriter& aWriter, const DohKdvpData& aData, const TaxPayer& aTaxPayer,
+               ThreadPool& aPool, FragmentCache* aCache = nullptr);
+
+/*
+    Cache key of an item's fragment: the content of the item and its rows, the form
+    settings (workflow, year, residency) and KDVP_RENDER_VERSION. The ItemID is left
+    out, so an item moved by an insertion above it still hits. Fragments that passed
+    validation are kept under their own keys (aValidated).
+*/
+[[nodiscard]] ContentHash MakeKdvpItemKey(const KdvpItem& aItem, const FormData& aForm,
+                                          bool aValidated = false);
+
+// Complete <KDVPItem> element of aItem.
+[[nodiscard]] std::string RenderKdvpItem(const KdvpItem& aItem);
+
+/*
+    One fragment per item of aData, in item order, rendered in chunks on aPool. The
+    fragments leave out ItemID, which WriteKdvp() adds for each item's position.
+    With aValidator, each item is validated as it is rendered and the errors are
+    merged into aValidator below its current element.
+*/
+[[nodiscard]] std::vector<std::shared_ptr<const std::string>>
+RenderKdvpItems(const DohKdvpData& aData, ThreadPool& aPool, FragmentCache* aCache = nullptr,
+                XmlValidator* aValidator = nullptr);
+
+// Doh-KDVP document of aData as a string.
+[[nodiscard]] std::string GenerateKdvp(const DohKdvpData& aData, const TaxPayer& aTaxPayer);
+
+[[nodiscard]] std::string GenerateKdvp(const DohKdvpData& aData, const TaxPayer& aTaxPayer,
+                                       ThreadPool& aPool, FragmentCache* aCache = nullptr);
+
+} // namespace taxbroker
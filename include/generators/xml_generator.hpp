@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/xml_data.hpp"
+#include "generators/xml_schema.hpp"
+#include "generators/xml_skeleton.hpp"
+
+namespace taxbroker {
+
+class XmlValidator;
+class ZipWriter;
+
+constexpr std::string_view NS_EDP = "http://edavki.durs.si/Documents/Schemas/EDP-Common-1.xsd";
+constexpr std::string_view NS_DOH_KDVP = "http://edavki.durs.si/Documents/Schemas/Doh_KDVP_9.xsd";
+constexpr std::string_view NS_DOH_DIV = "http://edavki.durs.si/Documents/Schemas/Doh_Div_3.xsd";
+constexpr std::string_view NS_DOH_DHO = "http://edavki.durs.si/Documents/Schemas/Doh_DHO_4.xsd";
+
+/*
+    Streaming XML writer used by all form generators.
+
+    Tags, attributes and escaped text are appended straight to the output: either a
+    caller-owned string, or an internal buffer that is written to a file descriptor
+    or to the open entry of a ZipWriter whenever it reaches the flush threshold.
+    Only the names of the open elements and the namespace prefixes in scope are
+    kept, so memory depends on nesting depth and not on the number of rows in the
+    document.
+
+    Nesting and prefixes are tracked in every build. Debug builds assert on misuse:
+    unbalanced end tags, attributes after content, undeclared prefixes, more than
+    one root element or an unfinished document. Schema rules are checked by an
+    attached XmlValidator, which sees every element and text event as it is written.
+*/
+class XmlWriter {
+  public:
+    static constexpr std::size_t DEFAULT_FLUSH_THRESHOLD = 64 * 1024;
+
+    // Appends the document to aOutput.
+    explicit XmlWriter(std::string& aOutput);
+
+    // Writes the document to aFd, which stays owned by the caller.
+    explicit XmlWriter(int aFd, std::size_t aFlushThreshold = DEFAULT_FLUSH_THRESHOLD);
+
+    // Writes the document to the open entry of aArchive, which stays owned by the caller.
+    explicit XmlWriter(ZipWriter& aArchive,
+                       std::size_t aFlushThreshold = DEFAULT_FLUSH_THRESHOLD);
+
+    XmlWriter(const XmlWriter&) = delete;
+    XmlWriter& operator=(const XmlWriter&) = delete;
+
+    ~XmlWriter();
+
+    // Forwards all following events to aValidator, which stays owned by the caller.
+    void setValidator(XmlValidator* aValidator) noexcept {
+        mValidator = aValidator;
+    }
+
+    [[nodiscard]] XmlValidator* validator() const noexcept {
+        return mValidator;
+    }
+
+    // <?xml version="1.0" encoding="UTF-8"?>, before the root element.
+    void declaration();
+
+    void startElement(std::string_view aName);
+
+    // Only valid right after startElement() or another attribute.
+    void attribute(std::string_view aName, std::string_view aValue);
+
+    // xmlns or xmlns:aPrefix attribute; the prefix stays in scope until the element ends.
+    void namespaceDeclaration(std::string_view aPrefix, std::string_view aUri);
+
+    void text(std::string_view aText);
+
+    // Elements without content are closed as <name/>.
+    void endElement();
+
+    // <aName>aText</aName>
+    void element(std::string_view aName, std::string_view aText);
+
+    void integerElement(std::string_view aName, std::int64_t aValue);
+
+    void booleanElement(std::string_view aName, bool aValue);
+
+    void dateElement(std::string_view aName, Date aDate);
+
+    // Fixed-point aValue with aScaleDigits implied decimals, see FormatDecimal().
+    void decimalElement(std::string_view aName, std::int64_t aValue, int aScaleDigits,
+                        int aPrecision);
+
+    /*
+        Splices pre-rendered, well-formed fragments at the current position. A
+        descriptor or archive sink hands the pending buffer and all fragments on
+        in one call instead of copying them. aElement names the root element of every fragment
+        for the validator, which checks only their position.
+    */
+    void fragments(std::span<const std::string_view> aFragments, std::string_view aElement = {}) {
+        fragments(aFragments, aElement, aFragments.size());
+    }
+
+    // As above, with fragments split over several chunks: aElementCount roots in all.
+    void fragments(std::span<const std::string_view> aChunks, std::string_view aElement,
+                   std::size_t aElementCount);
+
+    /*
+        Writes aSkeleton with the escaped aSlots in place of its XML_SLOT markers.
+        Each static segment is a single append; nesting, prefixes and the validator
+        are updated from the events parsed at compile time, as if the same elements
+        had been written one by one.
+    */
+    template <std::size_t Length>
+    void skeleton(const XmlSkeleton<Length>& aSkeleton, std::span<const std::string_view> aSlots) {
+        writeSkeleton(aSkeleton.text(), aSkeleton.events(), aSlots);
+    }
+
+    // Writes out everything pending. False if any write to the descriptor or archive failed.
+    [[nodiscard]] bool finish();
+
+    /*
+        Starts another document right after the finished one, in the same output and
+        with the allocations of this writer. bytesWritten() counts from here.
+    */
+    void nextDocument();
+
+    [[nodiscard]] std::size_t depth() const noexcept {
+        return mNameOffsets.size();
+    }
+
+    // Bytes of the document produced so far, flushed or not.
+    [[nodiscard]] std::uint64_t bytesWritten() const noexcept {
+        return mFlushedBytes + mBuffer->size() - mInitialSize;
+    }
+
+    [[nodiscard]] bool failed() const noexcept {
+        return mFailed;
+    }
+
+  private:
+    struct NamespaceScope {
+        std::string mPrefix;
+        std::size_t mDepth{};
+    };
+
+    void writeSkeleton(std::string_view aText, std::span<const XmlSkeletonEvent> aEvents,
+                       std::span<const std::string_view> aSlots);
+    void closeStartTag();
+    void popElement();
+    void appendEscaped(std::string_view aText, std::string_view aSpecials);
+    [[nodiscard]] bool streams() const noexcept {
+        return mFd >= 0 || mArchive != nullptr;
+    }
+    void flushIfFull();
+    void flush();
+    [[nodiscard]] bool isPrefixDeclared(std::string_view aName) const;
+
+    std::string mOwnBuffer;
+    std::string* mBuffer;
+    std::size_t mInitialSize{};
+    int mFd{-1};
+    ZipWriter* mArchive{};
+    std::size_t mFlushThreshold{};
+    std::uint64_t mFlushedBytes{};
+
+    std::string mNames;                    // Names of the open elements, back to back.
+    std::vector<std::size_t> mNameOffsets; // Start of every open element name in mNames.
+    std::vector<NamespaceScope> mNamespaces;
+
+    XmlValidator* mValidator{};
+
+    bool mIsDocument{false}; // Declaration written; fragments get no trailing newline.
+    bool mStartTagOpen{false};
+    bool mRootClosed{false};
+    bool mFailed{false};
+};
+
+/*
+    Opens the FURS envelope of aForm: declaration, <Envelope> with the form and
+    edp namespaces, the edp:Header with taxpayer and workflow, and edp:Signatures.
+    <body> is left open for the form content. The constant markup comes from
+    skeletons built at compile time; only the taxpayer and workflow are formatted.
+*/
+void WriteEnvelopeStart(XmlWriter& aWriter, XmlSchema aForm, FormType aWorkflow,
+                        const TaxPayer& aTaxPayer);
+
+// Closes <body> and <Envelope>.
+void WriteEnvelopeEnd(XmlWriter& aWriter);
+
+} // namespace taxbroker
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+
+namespace taxbroker {
+
+enum class XmlSchema : std::uint8_t {
+    DohKdvp,
+    DohDiv,
+    DohDho,
+};
+
+enum class XmlContent : std::uint8_t {
+    Elements,    // Child elements only, see XmlType::mChildren.
+    String,      // Text of at most mMaxLength characters.
+    Boolean,     // true, false, 1 or 0.
+    Date,        // YYYY-MM-DD.
+    Integer,     // xs:int, unsigned unless mSigned.
+    Year,        // Four digits without a leading zero.
+    Digits,      // Exactly mMaxLength decimal digits.
+    Decimal,     // Digit limits as in the schema patterns and facets.
+    Enumeration, // One of mValues.
+};
+
+constexpr std::uint32_t XML_UNBOUNDED = std::numeric_limits<std::uint32_t>::max();
+
+struct XmlParticle;
+
+/*
+    Content model of an element, compiled by hand from the FURS XSDs in
+    legacy-QT-GUI/resources/xml/edavk/schemas. Only the facets the generators can
+    get wrong are kept: required elements, order, occurrences, digit counts of
+    decimals, lengths and enumerations.
+*/
+struct XmlType {
+    XmlContent mContent{XmlContent::Elements};
+    std::span<const XmlParticle> mChildren{};    // Sequence for XmlContent::Elements.
+    std::span<const std::string_view> mValues{}; // XmlContent::Enumeration.
+    std::uint16_t mMaxLength{};                  // Characters, 0 is unlimited.
+    std::uint8_t mIntegerDigits{};               // Decimal: digits before the point, 0 is any.
+    std::uint8_t mFractionDigits{};              // Decimal: digits after the point.
+    std::uint8_t mTotalDigits{};                 // Decimal: significant digits, 0 is any.
+    bool mSigned{true};                          // Integer and Decimal: '-' is allowed.
+};
+
+/*
+    Element of a sequence. Consecutive particles with mAlternative set form an
+    xs:choice together with the particle before them.
+*/
+struct XmlParticle {
+    std::string_view mName{}; // Qualified as written by the generators, e.g. "edp:Header".
+    const XmlType* mType{};
+    std::uint32_t mMinOccurs{1};
+    std::uint32_t mMaxOccurs{1};
+    bool mAlternative{false};
+};
+
+// <Envelope> of aSchema.
+[[nodiscard]] const XmlParticle& SchemaRoot(XmlSchema aSchema);
+
+// First element named aName below the root of aSchema, nullptr if there is none.
+[[nodiscard]] const XmlParticle* FindSchemaElement(XmlSchema aSchema, std::string_view aName);
+
+} // namespace taxbroker
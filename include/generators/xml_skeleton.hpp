@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+namespace taxbroker {
+
+// Marks a variable text field in a skeleton; U+0001 cannot occur in XML 1.0.
+constexpr char XML_SLOT = '\x01';
+
+constexpr std::size_t XML_SKELETON_MAX_EVENTS = 32;
+
+/*
+    What XmlWriter::skeleton() replays, in document order. Static markup is one
+    Markup event; the element and namespace events after it describe the tags in
+    that markup, so the writer can track nesting without parsing at run time.
+*/
+struct XmlSkeletonEvent {
+    enum class Type : std::uint8_t {
+        Declaration, // The markup starts with <?xml ...?>.
+        Markup,      // Static text at mOffset.
+        Slot,        // Variable text number mOffset.
+        Namespace,   // Prefix at mOffset, empty for xmlns, declared on the next Start.
+        Start,       // Element name at mOffset.
+        End,
+    };
+
+    Type mType{Type::Markup};
+    std::uint16_t mOffset{};
+    std::uint16_t mLength{};
+};
+
+/*
+    Mostly constant markup with XML_SLOT markers for the variable text, parsed at
+    compile time into static segments and element events. It may close elements
+    opened before it and leave elements open, e.g. the FURS envelope up to <body>.
+
+    The parser handles the subset skeletons need: a declaration, start, end and
+    empty-element tags, and attributes in double or single quotes. Slots take
+    element text only; their values are escaped when written.
+*/
+template <std::size_t Length>
+class XmlSkeleton {
+  public:
+    consteval explicit XmlSkeleton(const std::array<char, Length>& aText) : mText(aText) {
+        static_assert(Length <= std::numeric_limits<std::uint16_t>::max());
+
+        std::size_t position = 0;
+        if (text().starts_with("<?xml")) {
+            add(XmlSkeletonEvent::Type::Declaration, 0, 0);
+        }
+        std::size_t markup = add(XmlSkeletonEvent::Type::Markup, 0, 0);
+
+        while (position < Length) {
+            const char character = mText[position];
+            if (character == XML_SLOT) {
+                finishMarkup(markup, position);
+                add(XmlSkeletonEvent::Type::Slot, mSlotCount++, 0);
+                markup = add(XmlSkeletonEvent::Type::Markup, position + 1, 0);
+                ++position;
+            } else if (character == '<') {
+                position = parseTag(position);
+            } else {
+                ++position;
+            }
+        }
+        finishMarkup(markup, Length);
+    }
+
+    [[nodiscard]] constexpr std::string_view text() const noexcept {
+        return {mText.data(), Length};
+    }
+
+    [[nodiscard]] constexpr std::span<const XmlSkeletonEvent> events() const noexcept {
+        return {mEvents.data(), mEventCount};
+    }
+
+    [[nodiscard]] constexpr std::size_t slotCount() const noexcept {
+        return mSlotCount;
+    }
+
+  private:
+    consteval std::size_t add(XmlSkeletonEvent::Type aType, std::size_t aOffset,
+                              std::size_t aLength) {
+        if (mEventCount == XML_SKELETON_MAX_EVENTS) {
+            throw std::length_error("XML skeleton has too many events");
+        }
+        mEvents[mEventCount] = XmlSkeletonEvent{aType, static_cast<std::uint16_t>(aOffset),
+                                                static_cast<std::uint16_t>(aLength)};
+        return mEventCount++;
+    }
+
+    consteval void finishMarkup(std::size_t aEvent, std::size_t aEnd) {
+        mEvents[aEvent].mLength = static_cast<std::uint16_t>(aEnd - mEvents[aEvent].mOffset);
+    }
+
+    consteval std::size_t find(std::string_view aToken, std::size_t aFrom) const {
+        const std::size_t found = text().find(aToken, aFrom);
+        if (found == std::string_view::npos) {
+            throw std::invalid_argument("XML skeleton has an unterminated tag");
+        }
+        return found;
+    }
+
+    // Adds the events of the tag at aPosition, returns the position after it.
+    consteval std::size_t parseTag(std::size_t aPosition) {
+        const std::string_view skeleton = text();
+        if (skeleton.substr(aPosition, 2) == "<?") {
+            return find("?>", aPosition) + 2;
+        }
+        if (skeleton.substr(aPosition, 2) == "</") {
+            add(XmlSkeletonEvent::Type::End, 0, 0);
+            return find(">", aPosition) + 1;
+        }
+
+        const std::size_t name = aPosition + 1;
+        const std::size_t nameEnd = skeleton.find_first_of(" \t\n/>", name);
+        if (nameEnd == std::string_view::npos || nameEnd == name) {
+            throw std::invalid_argument("XML skeleton has a tag without a name");
+        }
+
+        // Declarations come first, so the element's own prefix is in scope at its Start.
+        std::size_t position = nameEnd;
+        while (true) {
+            position = skeleton.find_first_not_of(" \t\n", position);
+            if (position == std::string_view::npos) {
+                throw std::invalid_argument("XML skeleton has an unterminated tag");
+            }
+            if (skeleton[position] == '>' || skeleton[position] == '/') {
+                break;
+            }
+
+            const std::size_t equals = find("=", position);
+            const std::string_view attribute = skeleton.substr(position, equals - position);
+            if (attribute == "xmlns") {
+                add(XmlSkeletonEvent::Type::Namespace, equals, 0);
+            } else if (attribute.starts_with("xmlns:")) {
+                add(XmlSkeletonEvent::Type::Namespace, position + 6, attribute.size() - 6);
+            }
+            const char quote = skeleton[equals + 1];
+            if (quote != '"' && quote != '\'') {
+                throw std::invalid_argument("XML skeleton has an unquoted attribute");
+            }
+            position = find(std::string_view{&skeleton[equals + 1], 1}, equals + 2) + 1;
+        }
+
+        add(XmlSkeletonEvent::Type::Start, name, nameEnd - name);
+        if (skeleton[position] == '/') {
+            add(XmlSkeletonEvent::Type::End, 0, 0);
+        }
+        return find(">", position) + 1;
+    }
+
+    std::array<char, Length> mText{};
+    std::array<XmlSkeletonEvent, XML_SKELETON_MAX_EVENTS> mEvents{};
+    std::size_t mEventCount{};
+    std::size_t mSlotCount{};
+};
+
+// Concatenation of Parts for an XmlSkeleton, e.g. markup around namespace constants.
+template <const std::string_view&... Parts>
+consteval auto JoinSkeletonText() {
+    std::array<char, (Parts.size() + ...)> text{};
+    std::size_t position = 0;
+    for (const std::string_view part : {Parts...}) {
+        for (const char character : part) {
+            text[position++] = character;
+        }
+    }
+    return text;
+}
+
+} // namespace taxbroker
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "generators/xml_schema.hpp"
+
+namespace taxbroker {
+
+// Errors kept per validator; later violations still make it invalid.
+constexpr std::size_t MAX_XML_VALIDATION_ERRORS = 32;
+
+/*
+    Single-pass schema check of the events an XmlWriter produces, attached with
+    XmlWriter::setValidator(). Each open element keeps its position in the parent's
+    sequence, so a child is matched in O(siblings) and text is checked once at the
+    end tag: no DOM, no second parse, no external tool.
+
+    Errors carry the element path, e.g.
+        Envelope/body/Doh_KDVP/KDVPItem/Securities/Row/F3: more than 8 fraction digits
+*/
+class XmlValidator {
+  public:
+    // Validates a whole document of aSchema, rooted at <Envelope>.
+    explicit XmlValidator(XmlSchema aSchema);
+
+    // Validates a document or fragment whose root element is aRoot.
+    explicit XmlValidator(const XmlParticle& aRoot);
+
+    void startElement(std::string_view aName);
+
+    void text(std::string_view aText);
+
+    void endElement();
+
+    /*
+        aCount pre-rendered aName siblings spliced at the current position. Only
+        their place in the sequence is checked; their content is validated by the
+        validators that rendered them, see merge().
+    */
+    void fragments(std::string_view aName, std::size_t aCount);
+
+    // Adds the errors of a fragment validator below the current element.
+    void merge(const XmlValidator& aFragment);
+
+    // Reports a root element that is missing or still open.
+    void finish();
+
+    // Forgets the document and its errors, to validate another one with the same allocations.
+    void reset();
+
+    [[nodiscard]] bool valid() const noexcept {
+        return mErrorCount == 0;
+    }
+
+    [[nodiscard]] std::size_t errorCount() const noexcept {
+        return mErrorCount;
+    }
+
+    // First MAX_XML_VALIDATION_ERRORS errors, in document order.
+    [[nodiscard]] const std::vector<std::string>& errors() const noexcept {
+        return mErrors;
+    }
+
+  private:
+    static constexpr std::uint32_t kNoMatch = UINT32_MAX;
+
+    struct Frame {
+        std::string_view mName;
+        const XmlType* mType{}; // nullptr inside an unexpected element.
+        std::uint32_t mGroup{}; // First particle of the current sequence group.
+        std::uint32_t mMatched{kNoMatch};
+        std::uint32_t mCount{}; // Occurrences of mMatched so far.
+    };
+
+    [[nodiscard]] const XmlParticle* matchChild(Frame& aParent, std::string_view aName);
+    [[nodiscard]] bool groupSatisfied(const Frame& aFrame, std::uint32_t aGroup) const;
+    [[nodiscard]] std::uint32_t groupEnd(const Frame& aFrame, std::uint32_t aGroup) const;
+    void checkComplete(const Frame& aFrame);
+    void checkValue(const Frame& aFrame);
+    void addError(std::string_view aMessage, std::string_view aDetail = {});
+
+    const XmlParticle& mRoot;
+    std::vector<Frame> mFrames;
+    std::string mText;
+    bool mRootSeen{false};
+    bool mRootClosed{false};
+    std::size_t mErrorCount{};
+    std::vector<std::string> mErrors;
+};
+
+} // namespace taxbroker
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "taxbroker/types.hpp"
+
+namespace taxbroker::ibkr {
+
+// Row of the IBKR "Dividends" section. Reversals carry a negative amount.
+struct DividendRow {
+    Isin mIsin;
+    std::string mName;
+    Date mDate{};
+    Money mAmount{};
+    Currency mCurrency{Currency::EUR};
+    std::size_t mRowIndex{};
+};
+
+// Row of the IBKR "Withholding Tax" section. Tax withheld is negative, refunds positive.
+struct WithholdingRow {
+    Isin mIsin;
+    Date mDate{};
+    Money mAmount{};
+    Currency mCurrency{Currency::EUR};
+    std::size_t mRowIndex{};
+};
+
+/*
+    Joins dividend rows with their withholding-tax rows on (ISIN, pay date).
+
+    Both sections are folded into one hash table, so rows on the same key net out
+    (gross dividend and its reversal, tax and its refund) in O(n). A row dated after
+    the payment it corrects (a later adjustment or reversal) has no exact key; it is
+    applied to the latest earlier payment of the same ISIN, found by binary search in
+    that instrument's payments sorted by day. Payments netting to zero are dropped.
+
+    Instruments keep the order of first appearance; transactions are sorted by date.
+*/
+[[nodiscard]] std::vector<DividendInstrument>
+JoinDividendWithholding(std::span<const DividendRow> aDividends,
+                        std::span<const WithholdingRow> aWithholdings,
+                        std::string_view aSourceFile, std::vector<ParseWarning>& aWarnings);
+
+} // namespace taxbroker::ibkr
@@ -4,6 +4,13 @@
 
 namespace taxbroker::ibkr {
 
+/*
+    Interactive Brokers activity statement (CSV export).
+
+    Reads the Dividends and Withholding Tax sections and joins them per payment
+    (see JoinDividendWithholding). Trades and Interest are not imported yet; each
+    such section is reported once as an UnsupportedRowType warning.
+*/
 class IbkrParser final : public CsvParser {
   public:
     ParseResult parse(const std::filesystem::path& csvPath) override;
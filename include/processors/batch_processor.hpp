@@ -0,0 +1,115 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "processors/report_processor.hpp"
+
+namespace taxbroker {
+
+// One taxpayer's return: all broker exports of one tax year.
+struct BatchJob {
+    std::string mTaxpayerId;
+    int mTaxYear{};
+    std::vector<std::filesystem::path> mInputFiles;
+};
+
+/*
+    Reads a batch manifest, one job per line:
+        <taxpayer id>;<tax year>;<file>[,<file>...]
+    Empty lines and lines starting with '#' are skipped. Relative file paths are
+    resolved against aBaseDirectory. Returns std::nullopt if any line is malformed.
+*/
+[[nodiscard]] std::optional<std::vector<BatchJob>>
+ParseBatchManifest(std::istream& aManifest, const std::filesystem::path& aBaseDirectory = {});
+
+[[nodiscard]] std::optional<std::vector<BatchJob>>
+ReadBatchManifest(const std::filesystem::path& aManifestPath);
+
+// Picks the parser for an input file; nullptr if the format is not recognised.
+using ParserResolver = std::function<std::shared_ptr<CsvParser>(const std::filesystem::path&)>;
+
+struct BatchOptions {
+    std::size_t mMaxConcurrentJobs{0}; // 0 -> one job per pool worker.
+    std::size_t mMemoryBudgetBytes{0}; // Estimated bytes of all running jobs; 0 -> unlimited.
+    const FxRateTable* mFxRates{nullptr};
+    TaxResultCache* mCache{nullptr}; // Shared by all jobs.
+    MatchAuditLog* mAuditLog{nullptr}; // Shared by all jobs, each under its BatchAuditScope.
+};
+
+// Audit log scope of one job's provenance: "<taxpayer id>/<tax year>".
+[[nodiscard]] std::string BatchAuditScope(const BatchJob& aJob);
+
+enum class BatchJobStatus {
+    Completed,
+    Failed
+};
+
+struct BatchJobResult {
+    std::string mTaxpayerId;
+    int mTaxYear{};
+    BatchJobStatus mStatus{BatchJobStatus::Completed};
+    std::optional<FinalReport> mReport; // Set when completed.
+    std::string mError;                 // Set when failed.
+    std::size_t mInputBytes{};
+    std::size_t mReservedBytes{}; // Memory reserved at admission.
+    std::size_t mReportBytes{};   // Estimated footprint of the finished report.
+    std::chrono::milliseconds mDuration{};
+};
+
+struct BatchSummary {
+    std::size_t mJobCount{};
+    std::size_t mCompletedCount{};
+    std::size_t mFailedCount{};
+    std::size_t mInstrumentCount{};
+    std::size_t mWarningCount{}; // Parse and processing warnings of completed jobs.
+    std::size_t mPeakReservedBytes{};
+    std::size_t mPeakConcurrentJobs{};
+    std::chrono::milliseconds mWallTime{};
+};
+
+struct BatchResult {
+    std::vector<BatchJobResult> mJobs; // In manifest order.
+    BatchSummary mSummary;
+};
+
+/*
+    Processes many taxpayers' returns on one shared thread pool.
+
+    Compared to one process per client, all jobs share the workers, the FX table and
+    the tax result cache, and no per-process start-up cost is paid. Jobs are admitted
+    largest input first (so a big client does not become the tail of the batch) while
+    two limits hold: at most mMaxConcurrentJobs running, and the summed admission
+    estimate of running jobs within mMemoryBudgetBytes. A job larger than the whole
+    budget still runs, but alone.
+
+    Every job runs its stages sequentially per instrument; parallelism comes from
+    running jobs side by side, which keeps all workers busy without queue hand-offs.
+    A failing job is reported in its result and does not stop the batch.
+*/
+class BatchProcessor {
+  public:
+    // Admission estimate: parsed statement and report relative to the raw input size.
+    static constexpr std::size_t MEMORY_PER_INPUT_BYTE = 8;
+
+    BatchProcessor(ThreadPool& aPool, ParserResolver aResolver)
+        : mPool(aPool), mResolver(std::move(aResolver)) {}
+
+    [[nodiscard]] BatchResult run(std::span<const BatchJob> aJobs, const BatchOptions& aOptions);
+
+  private:
+    [[nodiscard]] BatchJobResult runJob(const BatchJob& aJob, const BatchOptions& aOptions);
+
+    ThreadPool& mPool;
+    ParserResolver mResolver;
+};
+
+} // namespace taxbroker
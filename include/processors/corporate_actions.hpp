@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "taxbroker/types.hpp"
+
+namespace taxbroker {
+
+/*
+    Exact rational factor by which a unit count is multiplied when a holding
+    is carried through one or more corporate actions.
+    Example:
+        2-for-1 split followed by 1-for-3 reverse split -> 2/3
+*/
+struct UnitsFactor {
+    std::int64_t mNumerator{1};
+    std::int64_t mDenominator{1};
+};
+
+/*
+    Cumulative corporate-action table for a single instrument.
+
+    Actions are sorted by date and a suffix product of their factors is built once,
+    so restating a transaction is a single binary search over k actions instead of
+    replaying every action that happened after the trade.
+
+    Ratio convention for CorporateAction::mRatio (as quoted by brokers):
+        Split        -> new units per old unit (4-for-1 -> 4.0)
+        ReverseSplit -> old units per new unit (1-for-10 -> 10.0)
+        Merger       -> new units per old unit (may be below 1.0)
+
+    An action dated D applies to every transaction strictly before D. Trades on D
+    are expected to be reported on the post-action basis already.
+*/
+class CorporateActionTable {
+  public:
+    CorporateActionTable() = default;
+
+    explicit CorporateActionTable(std::span<const CorporateAction> aActions);
+
+    [[nodiscard]] bool empty() const noexcept {
+        return mDates.empty();
+    }
+
+    // Combined factor of all actions dated after aDate. O(log k).
+    [[nodiscard]] UnitsFactor factorAfter(Date aDate) const;
+
+    [[nodiscard]] Units restateUnits(Date aDate, Units aUnits) const;
+
+    [[nodiscard]] Money restateUnitPrice(Date aDate, Money aUnitPrice) const;
+
+    [[nodiscard]] TradeTransaction restate(const TradeTransaction& aTransaction) const;
+
+  private:
+    std::vector<Date> mDates;
+    std::vector<UnitsFactor> mCumulative; // mCumulative[i] = product of factors [i, k)
+};
+
+// Copy of the instrument's transactions restated onto the latest post-action basis.
+[[nodiscard]] std::vector<TradeTransaction>
+RestateTransactions(const TradeInstrument& aInstrument);
+
+} // namespace taxbroker
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "core/year_index.hpp"
+#include "taxbroker/types.hpp"
+
+namespace taxbroker {
+
+// Dividends of one payer paid on one day in one currency, as reported on one Doh-Div line.
+struct DividendGroup {
+    Isin mIsin;
+    std::string mName;
+    Date mDate{};
+    // ISO 3166 alpha-2 from the ISIN prefix; empty for non-country prefixes such as XS or EU.
+    std::string mSourceCountry;
+    Currency mCurrency{Currency::EUR}; // Not EUR only when no FX rate was available.
+    Money mGrossAmount{};
+    Money mTaxPaid{};
+    std::uint32_t mTransactionCount{};
+};
+
+struct DividendAggregation {
+    std::vector<DividendGroup> mGroups; // Ordered by ISIN, date, then currency.
+    Money mGrossTotal{};                // EUR groups only.
+    Money mTaxPaidTotal{};
+};
+
+/*
+    Groups dividend income and foreign withholding by (payer, pay date, currency) in one
+    pass over all transactions.
+
+    Groups are found through a flat open-addressing table keyed by one packed 64-bit word
+    (payer id, day, currency) and summed into columnar Money arrays; the form totals are
+    then plain reductions over those columns. Amounts are expected to be EUR-normalized;
+    ones that could not be converted form their own groups and stay out of the totals.
+*/
+[[nodiscard]] DividendAggregation
+AggregateDividends(std::span<const DividendInstrument> aInstruments);
+
+// Only dividends paid in aTaxYear; transactions must be sorted by date (see SortByDate).
+[[nodiscard]] DividendAggregation
+AggregateDividends(std::span<const DividendInstrument> aInstruments, int aTaxYear);
+
+// As above, slicing with aYears[i], the index of aInstruments[i], so one index serves all years.
+[[nodiscard]] DividendAggregation
+AggregateDividends(std::span<const DividendInstrument> aInstruments,
+                   std::span<const YearIndex> aYears, int aTaxYear);
+
+// Sum of a Money column; written as a plain loop so the compiler vectorizes it.
+[[nodiscard]] Money SumMoney(std::span<const Money> aValues) noexcept;
+
+} // namespace taxbroker
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include "core/fifo.hpp"
+#include "core/match_audit_log.hpp"
+#include "taxbroker/types.hpp"
+#include "utils/thread_pool.hpp"
+
+namespace taxbroker {
+
+// FIFO matching outcome for a single instrument.
+struct InstrumentMatches {
+    Isin mIsin;
+    std::string mName;
+    std::vector<LotMatch> mMatches;  // In sell order, then lot order.
+    std::vector<OpenLot> mOpenLots;  // Oldest first.
+    Units mUnmatchedSellUnits{};     // Sold units without an open lot (short or missing history).
+    std::vector<OpenLotSnapshot> mYearEndSnapshots; // Only with mEmitYearEndSnapshots.
+};
+
+struct FifoMatcherOptions {
+    // Emit an open-lot snapshot after the last transaction of every year with activity.
+    bool mEmitYearEndSnapshots{false};
+
+    /*
+        Merge consecutive buys with identical date, unit price and currency into one
+        lot while matching (savings plans, fractional shares). Matches and open lots
+        are expanded back to the original buys, so results are unchanged.
+    */
+    bool mCompactLots{false};
+
+    /*
+        Receives the match provenance of every run under mAuditScope; cheap enough to stay
+        on in production. A run replaces the instrument's entries, a resumed run extends them.
+    */
+    MatchAuditLog* mAuditLog{nullptr};
+    std::string mAuditScope{};
+};
+
+/*
+    Matches sells against the oldest open buy lots of the same instrument.
+    Transactions are processed in date order; same-day transactions keep their input order.
+    Indices in LotMatch/OpenLot refer to positions in TradeInstrument::mTransactions,
+    offset by OpenLotSnapshot::mNextTransactionIndex when resuming from a snapshot.
+*/
+class FifoMatcher {
+  public:
+    explicit FifoMatcher(FifoMatcherOptions aOptions = {}) : mOptions(aOptions) {}
+
+    [[nodiscard]] InstrumentMatches match(const TradeInstrument& aInstrument) const;
+
+    /*
+        Continues matching from a year-end snapshot. aInstrument holds only the
+        transactions after aResumeFrom.mYear; older ones are skipped with a warning.
+    */
+    [[nodiscard]] InstrumentMatches match(const TradeInstrument& aInstrument,
+                                          const OpenLotSnapshot& aResumeFrom) const;
+
+    /*
+        Matches every instrument independently on aPool.
+        Instruments are scheduled largest first (by transaction count) so a single huge
+        ISIN starts early instead of becoming the tail; idle workers steal the rest.
+        The result order equals the input order, identical to a serial run.
+        Instruments with an entry in aResumeFrom (latest year per ISIN) resume from it.
+    */
+    [[nodiscard]] std::vector<InstrumentMatches>
+    matchAll(std::span<const TradeInstrument> aInstruments, ThreadPool& aPool,
+             std::span<const OpenLotSnapshot> aResumeFrom = {}) const;
+
+  private:
+    InstrumentMatches matchFrom(const TradeInstrument& aInstrument,
+                                const OpenLotSnapshot* aResumeFrom) const;
+
+    FifoMatcherOptions mOptions;
+};
+
+} // namespace taxbroker
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "taxbroker/errors.hpp"
+#include "taxbroker/types.hpp"
+
+namespace taxbroker {
+
+/*
+    Fixed-point exchange rate with 8 decimal precision, quoted like the ECB
+    reference rates: units of foreign currency per 1 EUR.
+    Example:
+        108250000 -> 1.0825 USD per EUR
+*/
+using FxRate = std::int64_t;
+constexpr FxRate FX_RATE_SCALE = 100000000;
+
+/*
+    Daily reference rates per currency. Lookups use the latest rate on or before
+    the requested date, so weekends and holidays resolve to the previous fixing.
+*/
+class FxRateTable {
+  public:
+    // Keeps fixings sorted; appending in date order (as published) is O(1).
+    void addRate(Currency aCurrency, Date aDate, FxRate aRate);
+
+    // Rate valid on aDate; EUR is always 1. O(log n) per lookup.
+    [[nodiscard]] std::optional<FxRate> rateOn(Currency aCurrency, Date aDate) const;
+
+  private:
+    struct Fixing {
+        Date mDate{};
+        FxRate mRate{};
+    };
+
+    static constexpr std::size_t kCurrencyCount = static_cast<std::size_t>(Currency::Unknown) + 1;
+
+    std::array<std::vector<Fixing>, kCurrencyCount> mFixings; // Each sorted by date.
+};
+
+// Converts aAmount in aCurrency to EUR with the rate of aDate.
+[[nodiscard]] std::optional<Money> ConvertToEur(const FxRateTable& aRates, Currency aCurrency,
+                                                Date aDate, Money aAmount);
+
+/*
+    Restates prices/amounts to EUR in place. Entries without a rate keep their
+    original currency and add a MissingFxRate warning.
+*/
+void NormalizeToEur(TradeInstrument& aInstrument, const FxRateTable& aRates,
+                    std::vector<ProcessingWarning>& aWarnings);
+
+void NormalizeToEur(DividendInstrument& aInstrument, const FxRateTable& aRates,
+                    std::vector<ProcessingWarning>& aWarnings);
+
+void NormalizeToEur(std::vector<InterestTransaction>& aTransactions, const FxRateTable& aRates,
+                    std::vector<ProcessingWarning>& aWarnings);
+
+} // namespace taxbroker
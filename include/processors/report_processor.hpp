@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "parsers/csv_parser.hpp"
+#include "processors/fx_normalizer.hpp"
+#include "processors/tax_cache.hpp"
+#include "taxbroker/final_report.hpp"
+#include "utils/thread_pool.hpp"
+
+namespace taxbroker {
+
+struct ReportSource {
+    std::filesystem::path mPath;
+    std::shared_ptr<CsvParser> mParser;
+};
+
+enum class PipelineMode {
+    Pipelined,  // One thread per stage, connected by bounded queues.
+    Sequential  // All stages per instrument on the calling thread.
+};
+
+struct ReportOptions {
+    int mTaxYear{};
+    // processYears() reports mTaxYear..mLastTaxYear; process() ignores it.
+    int mLastTaxYear{};
+    const FxRateTable* mFxRates{nullptr}; // Without rates non-EUR amounts are kept as-is.
+    PipelineMode mMode{PipelineMode::Pipelined};
+    std::size_t mQueueCapacity{64};    // Instruments in flight between two stages.
+    bool mCompactLots{false};          // See FifoMatcherOptions::mCompactLots.
+    TaxResultCache* mCache{nullptr};   // Reuses results of instruments whose inputs are unchanged.
+    /*
+        Receives the FIFO provenance of the sales in the reported years under mAuditScope,
+        for computed, cached and skipped instruments alike.
+    */
+    MatchAuditLog* mAuditLog{nullptr};
+    std::string mAuditScope{};
+};
+
+/*
+    Orchestrates parse -> FX normalize -> corporate actions -> FIFO -> tax.
+
+    In pipelined mode every stage runs on its own thread for the duration of the run and
+    hands instruments to the next stage through a BoundedQueue, so stages overlap and
+    latency approaches the slowest stage instead of the sum of all stages. Output is
+    ordered like the input regardless of timing.
+
+    With a TaxResultCache, instruments whose normalized inputs hash to cached keys for
+    every year of the run skip corporate actions, FIFO and tax; only changed instruments
+    are recomputed. Entries are per instrument and year, so single- and multi-year runs
+    share them.
+
+    The stage threads block on their queues, so they are owned by the run instead of
+    taken from the thread pool, which only parses sources. Other work queued on the
+    pool, or a caller that is itself a pool task, therefore cannot starve the pipeline.
+*/
+class ReportProcessor {
+  public:
+    static constexpr std::size_t PIPELINE_STAGE_COUNT = 5;
+
+    explicit ReportProcessor(ThreadPool& aPool) : mPool(aPool) {}
+
+    // Parses all sources (in parallel) and merges instruments by ISIN before streaming them.
+    [[nodiscard]] FinalReport process(std::span<const ReportSource> aSources,
+                                      const ReportOptions& aOptions);
+
+    [[nodiscard]] FinalReport process(ParseResult aParsed, const ReportOptions& aOptions);
+
+    /*
+        One report per tax year from mTaxYear to mLastTaxYear, oldest first. FIFO and tax
+        run once over the full history; each InstrumentReport covers its own year, as
+        one from process() does.
+    */
+    [[nodiscard]] std::vector<FinalReport> processYears(std::span<const ReportSource> aSources,
+                                                        const ReportOptions& aOptions);
+
+    [[nodiscard]] std::vector<FinalReport> processYears(ParseResult aParsed,
+                                                        const ReportOptions& aOptions);
+
+  private:
+    [[nodiscard]] ParseResult parseAll(std::span<const ReportSource> aSources);
+
+    ThreadPool& mPool;
+};
+
+} // namespace taxbroker
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "taxbroker/final_report.hpp"
+#include "utils/hash.hpp"
+#include "utils/lru_byte_cache.hpp"
+
+namespace taxbroker {
+
+/*
+    Content address of an instrument's tax result: hash of ISIN, name, transactions,
+    corporate actions, TAX_RULESET_VERSION and tax year. Transactions should already
+    be FX-normalized so changed rates produce a different key.
+*/
+[[nodiscard]] ContentHash MakeTaxCacheKey(const TradeInstrument& aInstrument, int aTaxYear);
+
+// Keys of aFirstTaxYear..aLastTaxYear, oldest first; the history is hashed only once.
+[[nodiscard]] std::vector<ContentHash>
+MakeTaxCacheKeys(const TradeInstrument& aInstrument, int aFirstTaxYear, int aLastTaxYear);
+
+// Estimated heap footprint of a report; what the cache charges against its budget.
+[[nodiscard]] std::size_t EstimateFootprint(const InstrumentReport& aReport);
+
+/*
+    Thread-safe LRU cache of per-instrument FIFO and tax results.
+    Entries are charged by their estimated heap footprint; inserting beyond the
+    memory budget evicts the least recently used entries first.
+*/
+class TaxResultCache : private LruByteCache<ContentHash, InstrumentReport, ContentHashHasher> {
+  public:
+    using LruByteCache::LruByteCache;
+
+    using LruByteCache::find;
+    using LruByteCache::hitCount;
+    using LruByteCache::memoryUsage;
+    using LruByteCache::missCount;
+    using LruByteCache::size;
+
+    void insert(const ContentHash& aKey, InstrumentReport aReport);
+};
+
+} // namespace taxbroker
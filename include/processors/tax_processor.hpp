@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "processors/fifo_matcher.hpp"
+#include "taxbroker/types.hpp"
+
+namespace taxbroker {
+
+// Bump whenever a rule change alters results, so cached results are not reused.
+constexpr std::uint32_t TAX_RULESET_VERSION = 1;
+
+// Window of the loss-disallowance rule (97.č ZDoh-2): repurchase within 30 days.
+constexpr std::int32_t REPURCHASE_WINDOW_DAYS = 30;
+
+/*
+    Holding-period buckets of the capital gains rate (ZDoh-2, 96. člen):
+        0: < 5 years, 1: 5-10 years, 2: 10-15 years, 3: 15-20 years, 4: >= 20 years
+*/
+constexpr std::size_t HOLDING_PERIOD_BUCKET_COUNT = 5;
+constexpr int HOLDING_PERIOD_STEP_YEARS = 5;
+constexpr std::array<int, HOLDING_PERIOD_BUCKET_COUNT> CAPITAL_GAINS_RATE_PERCENT{
+    25, 20, 15, 10, 0};
+
+struct HoldingPeriodTotals {
+    std::array<Money, HOLDING_PERIOD_BUCKET_COUNT> mGains{};
+    std::array<Money, HOLDING_PERIOD_BUCKET_COUNT> mLosses{}; // Recognized losses, negative.
+};
+
+/*
+    Sums lot-slice gains per holding-period bucket in one branch-free columnar pass.
+    aHeldKeys are CalendarKey(sell) - CalendarKey(buy) per slice; aLossRecognized is 0
+    for slices of sales whose loss is disallowed.
+*/
+[[nodiscard]] HoldingPeriodTotals SumByHoldingPeriod(std::span<const std::int32_t> aHeldKeys,
+                                                     std::span<const Money> aGains,
+                                                     std::span<const std::uint8_t> aLossRecognized);
+
+// Tax view of one sell transaction, aggregated over all lot slices it consumed.
+struct SaleAssessment {
+    std::uint32_t mSellIndex{};
+    Date mSellDate{};
+    Units mUnits{};
+    Money mProceeds{};
+    Money mCostBasis{};
+    bool mLossDisallowed{false}; // Loss not recognized because of a repurchase (F10).
+};
+
+struct InstrumentTaxResult {
+    Isin mIsin;
+    std::string mName;
+    int mTaxYear{};
+    std::vector<SaleAssessment> mSales; // Sales dated in mTaxYear, in sell order.
+    HoldingPeriodTotals mHoldingPeriods;
+};
+
+/*
+    Evaluates FIFO matches of one instrument for a range of tax years.
+
+    The loss rule is checked against a day-serial index of the instrument's buy lots
+    (consumed and still open). Buy lots are already chronological in FIFO order, so
+    the index needs no sort and each loss sale costs two binary searches.
+
+    Sales are chronological, so one walk over the matches partitions them into all
+    years of the range; back filings for several years cost a single pass.
+*/
+class TaxProcessor {
+  public:
+    explicit TaxProcessor(int aTaxYear) : mFirstTaxYear(aTaxYear), mLastTaxYear(aTaxYear) {}
+
+    TaxProcessor(int aFirstTaxYear, int aLastTaxYear)
+        : mFirstTaxYear(aFirstTaxYear), mLastTaxYear(aLastTaxYear) {}
+
+    // Result of the first tax year of the range.
+    [[nodiscard]] InstrumentTaxResult process(const InstrumentMatches& aMatches) const;
+
+    // One result per tax year of the range, oldest first.
+    [[nodiscard]] std::vector<InstrumentTaxResult>
+    processYears(const InstrumentMatches& aMatches) const;
+
+  private:
+    int mFirstTaxYear{};
+    int mLastTaxYear{};
+};
+
+} // namespace taxbroker
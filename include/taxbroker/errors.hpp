@@ -19,4 +19,15 @@ struct ParseWarning {
     std::string mMessage;
 };
 
+enum class ProcessingWarningCode {
+    MissingFxRate,
+    UnmatchedSell
+};
+
+struct ProcessingWarning {
+    ProcessingWarningCode mCode{};
+    std::string mIsin;
+    std::string mMessage;
+};
+
 } // namespace taxbroker
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include "processors/dividend_aggregator.hpp"
+#include "processors/fifo_matcher.hpp"
+#include "processors/tax_processor.hpp"
+#include "taxbroker/errors.hpp"
+#include "taxbroker/types.hpp"
+
+namespace taxbroker {
+
+/*
+    FIFO and tax results of one traded instrument for one tax year, whichever entry
+    point produced it: the matches of the sales dated in that year and the lots still
+    open at its end. FIFO itself runs over the full history; mUnmatchedSellUnits
+    describes that whole history and is the same on every year.
+    Instruments without a sale in any year of the run are not matched; both parts
+    then carry only ISIN and name.
+*/
+struct InstrumentReport {
+    InstrumentMatches mMatches;
+    InstrumentTaxResult mTax;
+};
+
+/*
+    Fully computed report for one taxpayer and tax year. All amounts are in EUR
+    unless an FX warning says otherwise. This is the single input of the
+    Doh-KDVP, Doh-Div and Doh-DHO generators.
+*/
+struct FinalReport {
+    int mTaxYear{};
+    std::vector<InstrumentReport> mInstruments; // In first-seen order across input files.
+    std::vector<DividendInstrument> mDividendInstruments;
+    DividendAggregation mDividends; // Doh-Div lines of the tax year.
+    std::vector<InterestTransaction> mInterestTransactions;
+    std::vector<ParseWarning> mParseWarnings;
+    std::vector<ProcessingWarning> mWarnings;
+};
+
+} // namespace taxbroker
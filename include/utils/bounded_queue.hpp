@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace taxbroker {
+
+/*
+    Blocking multi-producer/multi-consumer queue with a fixed capacity.
+    A full queue blocks producers (backpressure), an empty one blocks consumers.
+    close() wakes everybody: further pushes fail, pops drain what is left and then
+    return std::nullopt.
+*/
+template <typename T>
+class BoundedQueue {
+  public:
+    explicit BoundedQueue(std::size_t aCapacity) : mCapacity(aCapacity > 0 ? aCapacity : 1) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool push(T aItem) {
+        std::unique_lock lock(mMutex);
+        mNotFull.wait(lock, [this]() { return mClosed || mItems.size() < mCapacity; });
+        if (mClosed) {
+            return false;
+        }
+
+        mItems.push_back(std::move(aItem));
+        lock.unlock();
+        mNotEmpty.notify_one();
+        return true;
+    }
+
+    [[nodiscard]] std::optional<T> pop() {
+        std::unique_lock lock(mMutex);
+        mNotEmpty.wait(lock, [this]() { return mClosed || !mItems.empty(); });
+        if (mItems.empty()) {
+            return std::nullopt;
+        }
+
+        T item = std::move(mItems.front());
+        mItems.pop_front();
+        lock.unlock();
+        mNotFull.notify_one();
+        return item;
+    }
+
+    void close() {
+        {
+            const std::lock_guard lock(mMutex);
+            mClosed = true;
+        }
+        mNotFull.notify_all();
+        mNotEmpty.notify_all();
+    }
+
+  private:
+    const std::size_t mCapacity;
+    std::mutex mMutex;
+    std::condition_variable mNotFull;
+    std::condition_variable mNotEmpty;
+    std::deque<T> mItems;
+    bool mClosed{false};
+};
+
+} // namespace taxbroker
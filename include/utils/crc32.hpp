@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace taxbroker {
+
+/*
+    CRC-32 of aData as used by ZIP and gzip (reflected polynomial 0xEDB88320),
+    continuing from aCrc, the result for the bytes before aData. Starting from 0,
+    Crc32(a + b) == Crc32(b, Crc32(a)).
+
+    ARMv8 builds with the CRC extension use its instructions, eight bytes at a time.
+    On x86-64 CPUs with PCLMULQDQ (detected at run time) inputs of 64 bytes and more
+    are folded 64 bytes per step with carry-less multiplies; the SSE4.2 crc32
+    instruction computes CRC-32C, a different polynomial. Everything else, and the
+    last bytes, go through eight lookup tables built at compile time (slicing-by-8).
+*/
+[[nodiscard]] std::uint32_t Crc32(std::string_view aData, std::uint32_t aCrc = 0) noexcept;
+
+} // namespace taxbroker
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "taxbroker/types.hpp"
+
+namespace taxbroker {
+
+[[nodiscard]] Date MakeDate(int aYear, unsigned aMonth, unsigned aDay);
+
+[[nodiscard]] int YearOf(Date aDate);
+
+constexpr std::size_t ISO_DATE_LENGTH = 10;
+
+// YYYY-MM-DD (xs:date) without a heap allocation; years must be within 0..9999.
+[[nodiscard]] std::array<char, ISO_DATE_LENGTH> FormatIsoDate(Date aDate);
+
+// Days since 1970-01-01, the representation used for date arithmetic in hot loops.
+[[nodiscard]] constexpr std::int32_t DaySerial(Date aDate) noexcept {
+    return static_cast<std::int32_t>(aDate.time_since_epoch().count());
+}
+
+/*
+    Order-preserving packed calendar date: year * 512 + month * 32 + day.
+    Two keys differ by at least N * 512 exactly when the later date is on or after
+    the N-th anniversary of the earlier one, which makes whole-year holding periods
+    a plain integer comparison.
+*/
+constexpr std::int32_t CALENDAR_KEY_YEAR = 512;
+
+[[nodiscard]] std::int32_t CalendarKey(Date aDate);
+
+} // namespace taxbroker
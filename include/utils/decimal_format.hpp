@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace taxbroker {
+
+// Implied decimals of Money, Units and CorpRatio (see taxbroker/types.hpp).
+constexpr int MONEY_SCALE_DIGITS = 4;
+constexpr int UNITS_SCALE_DIGITS = 8;
+constexpr int CORP_RATIO_SCALE_DIGITS = 8;
+
+constexpr int MAX_DECIMAL_PRECISION = 18;
+
+// Sign, 19 integer digits, decimal point and MAX_DECIMAL_PRECISION fractional digits.
+constexpr std::size_t DECIMAL_BUFFER_SIZE = 40;
+
+/*
+    Writes the fixed-point aValue (aScaleDigits implied decimals) as decimal text with
+    exactly aPrecision fractional digits into aBuffer, which must hold
+    DECIMAL_BUFFER_SIZE characters. Returns the written text.
+
+    Extra precision is zero padded; less precision rounds half away from zero, the
+    rule FURS applies to amounts (2.345 -> 2.35, -2.345 -> -2.35). Values that round
+    to zero are written without a sign.
+
+    Digits are emitted in pairs from a lookup table: no locale, no heap, no division
+    per digit.
+*/
+std::string_view FormatDecimal(std::int64_t aValue, int aScaleDigits, int aPrecision,
+                               char* aBuffer) noexcept;
+
+} // namespace taxbroker
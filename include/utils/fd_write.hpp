@@ -0,0 +1,16 @@
+#pragma once
+
+#include <span>
+
+#include <sys/uio.h>
+
+namespace taxbroker {
+
+/*
+    Writes every byte of aChunks to aFd with writev, resuming after partial writes
+    and EINTR; lists longer than IOV_MAX take several calls. The entries of aChunks
+    are advanced while writing. False on error, with errno set.
+*/
+[[nodiscard]] bool WriteAll(int aFd, std::span<iovec> aChunks);
+
+} // namespace taxbroker
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace taxbroker {
+
+/*
+    128-bit content hash built from two independently seeded 64-bit lanes.
+    Used as a content address for cached results, where a collision would silently
+    return a wrong result; 128 bits keep that risk negligible.
+*/
+struct ContentHash {
+    std::uint64_t mHigh{};
+    std::uint64_t mLow{};
+
+    friend bool operator==(const ContentHash&, const ContentHash&) = default;
+};
+
+struct ContentHashHasher {
+    std::size_t operator()(const ContentHash& aHash) const noexcept {
+        return static_cast<std::size_t>(aHash.mLow);
+    }
+};
+
+class ContentHasher {
+  public:
+    void add(std::uint64_t aValue) noexcept {
+        mHigh = Mix(mHigh ^ aValue);
+        mLow = Mix(mLow + aValue * 0x9E3779B97F4A7C15ULL);
+    }
+
+    void add(std::int64_t aValue) noexcept {
+        add(static_cast<std::uint64_t>(aValue));
+    }
+
+    void add(std::string_view aValue) noexcept {
+        add(static_cast<std::uint64_t>(aValue.size()));
+        std::uint64_t word = 0;
+        std::size_t filled = 0;
+        for (const char character : aValue) {
+            const auto byte = static_cast<unsigned char>(character);
+            word |= static_cast<std::uint64_t>(byte) << (8 * filled);
+            if (++filled == 8) {
+                add(word);
+                word = 0;
+                filled = 0;
+            }
+        }
+        if (filled > 0) {
+            add(word);
+        }
+    }
+
+    [[nodiscard]] ContentHash finish() const noexcept {
+        return ContentHash{Mix(mHigh ^ 0xD6E8FEB86659FD93ULL), Mix(mLow ^ 0xA0761D6478BD642FULL)};
+    }
+
+  private:
+    // splitmix64 finalizer
+    static constexpr std::uint64_t Mix(std::uint64_t aValue) noexcept {
+        aValue ^= aValue >> 30;
+        aValue *= 0xBF58476D1CE4E5B9ULL;
+        aValue ^= aValue >> 27;
+        aValue *= 0x94D049BB133111EBULL;
+        aValue ^= aValue >> 31;
+        return aValue;
+    }
+
+    std::uint64_t mHigh{0x243F6A8885A308D3ULL};
+    std::uint64_t mLow{0x13198A2E03707344ULL};
+};
+
+} // namespace taxbroker
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace taxbroker {
+
+/*
+    Thread-safe LRU cache of immutable shared values within a byte budget.
+    Every entry is charged the footprint its inserter reports plus its own bookkeeping;
+    inserting beyond the budget evicts the least recently used entries first. A value
+    larger than the whole budget is not cached.
+*/
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class LruByteCache {
+  public:
+    explicit LruByteCache(std::size_t aMemoryBudgetBytes) : mMemoryBudget(aMemoryBudgetBytes) {}
+
+    LruByteCache(const LruByteCache&) = delete;
+    LruByteCache& operator=(const LruByteCache&) = delete;
+
+    [[nodiscard]] std::shared_ptr<const Value> find(const Key& aKey) {
+        const std::lock_guard lock(mMutex);
+
+        const auto position = mIndex.find(aKey);
+        if (position == mIndex.end()) {
+            ++mMisses;
+            return nullptr;
+        }
+
+        ++mHits;
+        mEntries.splice(mEntries.begin(), mEntries, position->second);
+        return position->second->mValue;
+    }
+
+    void insert(const Key& aKey, std::shared_ptr<const Value> aValue, std::size_t aValueBytes) {
+        const std::size_t bytes = sizeof(Entry) + aValueBytes;
+        if (bytes > mMemoryBudget) {
+            return;
+        }
+
+        const std::lock_guard lock(mMutex);
+        const auto position = mIndex.find(aKey);
+        if (position != mIndex.end()) {
+            mMemoryUsage -= position->second->mBytes;
+            mEntries.erase(position->second);
+            mIndex.erase(position);
+        }
+
+        mEntries.push_front(Entry{aKey, std::move(aValue), bytes});
+        mIndex.emplace(aKey, mEntries.begin());
+        mMemoryUsage += bytes;
+
+        while (mMemoryUsage > mMemoryBudget) {
+            const auto& oldest = mEntries.back();
+            mMemoryUsage -= oldest.mBytes;
+            mIndex.erase(oldest.mKey);
+            mEntries.pop_back();
+        }
+    }
+
+    [[nodiscard]] std::size_t memoryUsage() const {
+        const std::lock_guard lock(mMutex);
+        return mMemoryUsage;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        const std::lock_guard lock(mMutex);
+        return mEntries.size();
+    }
+
+    [[nodiscard]] std::size_t hitCount() const {
+        const std::lock_guard lock(mMutex);
+        return mHits;
+    }
+
+    [[nodiscard]] std::size_t missCount() const {
+        const std::lock_guard lock(mMutex);
+        return mMisses;
+    }
+
+  private:
+    struct Entry {
+        Key mKey;
+        std::shared_ptr<const Value> mValue;
+        std::size_t mBytes{};
+    };
+
+    const std::size_t mMemoryBudget;
+    mutable std::mutex mMutex;
+    std::list<Entry> mEntries; // Most recently used first.
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hasher> mIndex;
+    std::size_t mMemoryUsage{};
+    std::size_t mHits{};
+    std::size_t mMisses{};
+};
+
+} // namespace taxbroker
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string_view>
 #include "taxbroker/types.hpp"
 
@@ -10,4 +11,14 @@ taxbroker::Units parseUnits8(std::string_view value);
 taxbroker::CorpRatio parseCorpRatio8(std::string_view value);
 
 // To avoid unit64_t overflow when multiplying price and units
-taxbroker::Money multiplyMoneyUnits(taxbroker::Money price, taxbroker::Units units);
\ No newline at end of file
+taxbroker::Money multiplyMoneyUnits(taxbroker::Money price, taxbroker::Units units);
+
+/*
+    value * multiplier / divisor rounded half away from zero, through a 128-bit
+    intermediate product on every compiler. divisor must be positive.
+    Throws std::overflow_error when the quotient does not fit in 64 bits.
+*/
+std::int64_t mulDivRounded(std::int64_t value, std::int64_t multiplier, std::int64_t divisor);
+
+// left * right; throws std::overflow_error when the product does not fit in 64 bits.
+std::int64_t checkedMultiply(std::int64_t left, std::int64_t right);
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace taxbroker {
+
+/*
+    Fixed-size work-stealing thread pool.
+
+    Every worker owns a task deque. Tasks submitted from a worker go to its own deque
+    (popped LIFO for cache locality). External submissions go to one shared queue that
+    is drained FIFO, so they start in submission order, e.g. largest instrument first.
+    An idle worker takes injected work before stealing from the front of the other
+    deques, so one long task never leaves queued work stranded behind it.
+*/
+class ThreadPool {
+  public:
+    explicit ThreadPool(std::size_t aThreadCount = DefaultThreadCount());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] static std::size_t DefaultThreadCount() noexcept;
+
+    [[nodiscard]] std::size_t threadCount() const noexcept {
+        return mWorkers.size();
+    }
+
+    template <typename Function>
+    [[nodiscard]] auto submit(Function&& aFunction)
+        -> std::future<std::invoke_result_t<std::decay_t<Function>>> {
+        using Result = std::invoke_result_t<std::decay_t<Function>>;
+
+        auto task =
+            std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(aFunction));
+        auto future = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    // Runs one queued task on the calling thread. Returns false if nothing was queued.
+    bool runPendingTask();
+
+    // Waits for aFuture while executing queued tasks, so pool tasks may wait on other pool tasks.
+    template <typename Result>
+    Result await(std::future<Result>& aFuture) {
+        while (aFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!runPendingTask()) {
+                aFuture.wait_for(std::chrono::microseconds(100));
+            }
+        }
+        return aFuture.get();
+    }
+
+    /*
+        Awaits every valid future, then rethrows the first failure. Tasks that capture
+        the caller's locals need this: leaving at the first failure would destroy the
+        locals while the remaining tasks still use them.
+    */
+    template <typename Result, std::size_t Extent>
+    void awaitAll(std::span<std::future<Result>, Extent> aFutures) {
+        std::exception_ptr failure;
+        for (auto& future : aFutures) {
+            if (!future.valid()) {
+                continue;
+            }
+            try {
+                (void)await(future);
+            } catch (...) {
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+  private:
+    using Task = std::function<void()>;
+
+    struct WorkerQueue {
+        std::mutex mMutex;
+        std::deque<Task> mTasks;
+    };
+
+    void enqueue(Task aTask);
+    bool takeFront(WorkerQueue& aQueue, Task& aTask);
+    bool tryAcquire(std::size_t aWorkerIndex, Task& aTask);
+    void workerLoop(std::size_t aWorkerIndex);
+
+    std::vector<std::unique_ptr<WorkerQueue>> mQueues;
+    WorkerQueue mInjected; // External submissions, oldest first.
+    std::vector<std::thread> mWorkers;
+
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCondition;
+    std::atomic<std::size_t> mQueuedTasks{0};
+    bool mStopping{false}; // Guarded by mWakeMutex.
+};
+
+} // namespace taxbroker
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace taxbroker {
+
+/*
+    LEB128-style variable-length integers used by compact on-disk and in-memory logs.
+    Small values take one byte; signed values are zigzag-mapped first so small
+    negative deltas stay small as well.
+*/
+inline void AppendVarint(std::string& aBuffer, std::uint64_t aValue) {
+    while (aValue >= 0x80) {
+        aBuffer.push_back(static_cast<char>((aValue & 0x7F) | 0x80));
+        aValue >>= 7;
+    }
+    aBuffer.push_back(static_cast<char>(aValue));
+}
+
+[[nodiscard]] constexpr std::uint64_t ZigZagEncode(std::int64_t aValue) noexcept {
+    return (static_cast<std::uint64_t>(aValue) << 1) ^ static_cast<std::uint64_t>(aValue >> 63);
+}
+
+[[nodiscard]] constexpr std::int64_t ZigZagDecode(std::uint64_t aValue) noexcept {
+    return static_cast<std::int64_t>(aValue >> 1) ^ -static_cast<std::int64_t>(aValue & 1);
+}
+
+inline void AppendSignedVarint(std::string& aBuffer, std::int64_t aValue) {
+    AppendVarint(aBuffer, ZigZagEncode(aValue));
+}
+
+// Sequential reader over a varint-encoded buffer. Every read fails once the buffer is exhausted.
+class VarintReader {
+  public:
+    explicit VarintReader(std::string_view aBuffer) noexcept : mBuffer(aBuffer) {}
+
+    [[nodiscard]] bool atEnd() const noexcept {
+        return mPosition >= mBuffer.size();
+    }
+
+    [[nodiscard]] std::size_t position() const noexcept {
+        return mPosition;
+    }
+
+    void seek(std::size_t aPosition) noexcept {
+        mPosition = aPosition;
+    }
+
+    [[nodiscard]] std::optional<std::uint64_t> readVarint() noexcept {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64 && mPosition < mBuffer.size(); shift += 7) {
+            const auto byte = static_cast<std::uint8_t>(mBuffer[mPosition++]);
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<std::int64_t> readSignedVarint() noexcept {
+        const auto value = readVarint();
+        if (!value) {
+            return std::nullopt;
+        }
+        return ZigZagDecode(*value);
+    }
+
+    [[nodiscard]] std::optional<std::string_view> readBytes(std::size_t aLength) noexcept {
+        if (mPosition > mBuffer.size() || aLength > mBuffer.size() - mPosition) {
+            return std::nullopt;
+        }
+        const auto bytes = mBuffer.substr(mPosition, aLength);
+        mPosition += aLength;
+        return bytes;
+    }
+
+  private:
+    std::string_view mBuffer;
+    std::size_t mPosition{};
+};
+
+} // namespace taxbroker
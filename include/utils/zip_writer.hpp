@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace taxbroker {
+
+/*
+    Streaming ZIP archive with stored (uncompressed) entries.
+
+    Entry data is passed through as it is produced, with its CRC-32 updated on the
+    way. When an entry ends, its CRC and sizes are patched into its local header, so
+    the archive has no data descriptors: streaming readers reject those on stored
+    entries, whose end they cannot find. Like XmlWriter, the archive goes to a
+    caller-owned string or to a file descriptor; large writes reach the descriptor
+    as one writev of the pending headers and the data chunks, without a copy.
+
+    A flushed header is patched with pwrite, so only the headers and one central
+    directory record per entry are kept. A descriptor that cannot be written at an
+    offset (a pipe, or opened with O_APPEND) gets each entry only once it has ended,
+    which holds the whole entry in memory.
+
+    There is no ZIP64: entries and the archive must stay below 4 GiB and 65535
+    entries, otherwise the archive fails. Entries are dated 1980-01-01, so equal
+    content gives byte-identical archives.
+*/
+class ZipWriter {
+  public:
+    // Appends the archive to aOutput.
+    explicit ZipWriter(std::string& aOutput);
+
+    // Writes the archive to aFd, which stays owned by the caller.
+    explicit ZipWriter(int aFd);
+
+    ZipWriter(const ZipWriter&) = delete;
+    ZipWriter& operator=(const ZipWriter&) = delete;
+
+    // Starts an entry named aName, a UTF-8 path with '/' separators. Ends the open one.
+    void beginEntry(std::string_view aName);
+
+    // Appends to the open entry.
+    void write(std::string_view aData);
+
+    void write(std::span<const std::string_view> aChunks);
+
+    // Completes the local header of the open entry, if any.
+    void endEntry();
+
+    // Ends the open entry and writes the central directory. False if the archive failed.
+    [[nodiscard]] bool finish();
+
+    [[nodiscard]] std::size_t entryCount() const noexcept {
+        return mEntries.size();
+    }
+
+    // Bytes produced so far, flushed or not.
+    [[nodiscard]] std::uint64_t bytesWritten() const noexcept {
+        return mFlushedBytes + mBuffer->size() - mInitialSize;
+    }
+
+    [[nodiscard]] bool failed() const noexcept {
+        return mFailed;
+    }
+
+  private:
+    struct Entry {
+        std::string mName;
+        std::uint32_t mCrc{};
+        std::uint64_t mSize{};
+        std::uint64_t mOffset{}; // Of the local header.
+    };
+
+    void put16(std::uint32_t aValue);
+    void put32(std::uint64_t aValue);
+    void fail(std::string_view aReason);
+    void flush(std::span<const std::string_view> aChunks = {});
+    void patchHeader(const Entry& aEntry);
+
+    std::string mOwnBuffer;
+    std::string* mBuffer;
+    std::size_t mInitialSize{};
+    int mFd{-1};
+    std::int64_t mFdStart{-1}; // File offset of the archive; -1 if not seekable.
+    std::uint64_t mFlushedBytes{};
+
+    std::vector<Entry> mEntries;
+    bool mEntryOpen{false};
+    bool mFinished{false};
+    bool mFailed{false};
+};
+
+} // namespace taxbroker
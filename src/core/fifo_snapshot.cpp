@@ -0,0 +1,160 @@
+#include "core/fifo_snapshot.hpp"
+
+#include "utils/date_utils.hpp"
+#include "utils/logger.hpp"
+#include "utils/varint.hpp"
+
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+using taxbroker::Currency;
+using taxbroker::Date;
+using taxbroker::DayDuration;
+using taxbroker::Money;
+using taxbroker::OpenLot;
+using taxbroker::OpenLotSnapshot;
+using taxbroker::Units;
+using taxbroker::VarintReader;
+
+constexpr std::string_view kSnapshotMagic = "TBRF";
+constexpr std::uint64_t kSnapshotVersion = 1;
+
+std::optional<OpenLotSnapshot> ReadSnapshot(VarintReader& aReader) {
+    OpenLotSnapshot snapshot;
+
+    const auto isinLength = aReader.readVarint();
+    const auto isin = isinLength ? aReader.readBytes(*isinLength) : std::nullopt;
+    const auto year = aReader.readSignedVarint();
+    const auto nextIndex = aReader.readVarint();
+    const auto lotCount = aReader.readVarint();
+    if (!isin || !year || !nextIndex || !lotCount) {
+        return std::nullopt;
+    }
+
+    snapshot.mIsin = std::string{*isin};
+    snapshot.mYear = static_cast<int>(*year);
+    snapshot.mNextTransactionIndex = static_cast<std::uint32_t>(*nextIndex);
+
+    std::int64_t previousDay = 0;
+    Money previousPrice = 0;
+    for (std::uint64_t lotIndex = 0; lotIndex < *lotCount; ++lotIndex) {
+        const auto dayDelta = aReader.readSignedVarint();
+        const auto priceDelta = aReader.readSignedVarint();
+        const auto units = aReader.readVarint();
+        const auto consumed = aReader.readVarint();
+        const auto currency = aReader.readVarint();
+        const auto transactionIndex = aReader.readVarint();
+        if (!dayDelta || !priceDelta || !units || !consumed || !currency || !transactionIndex ||
+            *consumed > *units || *currency > static_cast<std::uint64_t>(Currency::Unknown)) {
+            return std::nullopt;
+        }
+
+        previousDay += *dayDelta;
+        previousPrice += *priceDelta;
+
+        snapshot.mOpenLots.push_back(OpenLot{
+            Date{DayDuration{previousDay}}, previousPrice, static_cast<Units>(*units),
+            static_cast<Units>(*consumed), static_cast<Currency>(*currency),
+            static_cast<std::uint32_t>(*transactionIndex)});
+    }
+
+    return snapshot;
+}
+
+} // namespace
+
+namespace taxbroker {
+
+std::string SerializeSnapshots(std::span<const OpenLotSnapshot> aSnapshots) {
+    std::string buffer{kSnapshotMagic};
+    AppendVarint(buffer, kSnapshotVersion);
+    AppendVarint(buffer, aSnapshots.size());
+
+    for (const auto& snapshot : aSnapshots) {
+        AppendVarint(buffer, snapshot.mIsin.size());
+        buffer.append(snapshot.mIsin);
+        AppendSignedVarint(buffer, snapshot.mYear);
+        AppendVarint(buffer, snapshot.mNextTransactionIndex);
+        AppendVarint(buffer, snapshot.mOpenLots.size());
+
+        std::int64_t previousDay = 0;
+        Money previousPrice = 0;
+        for (const auto& lot : snapshot.mOpenLots) {
+            const std::int64_t day = DaySerial(lot.mDate);
+            AppendSignedVarint(buffer, day - previousDay);
+            AppendSignedVarint(buffer, lot.mUnitPrice - previousPrice);
+            AppendVarint(buffer, static_cast<std::uint64_t>(lot.mUnits));
+            AppendVarint(buffer, static_cast<std::uint64_t>(lot.mConsumed));
+            AppendVarint(buffer, static_cast<std::uint64_t>(lot.mCurrency));
+            AppendVarint(buffer, lot.mTransactionIndex);
+            previousDay = day;
+            previousPrice = lot.mUnitPrice;
+        }
+    }
+
+    return buffer;
+}
+
+std::optional<std::vector<OpenLotSnapshot>> DeserializeSnapshots(std::string_view aBuffer) {
+    if (!aBuffer.starts_with(kSnapshotMagic)) {
+        return std::nullopt;
+    }
+
+    VarintReader reader{aBuffer.substr(kSnapshotMagic.size())};
+    const auto version = reader.readVarint();
+    const auto snapshotCount = reader.readVarint();
+    if (!version || *version != kSnapshotVersion || !snapshotCount) {
+        return std::nullopt;
+    }
+
+    std::vector<OpenLotSnapshot> snapshots;
+    for (std::uint64_t index = 0; index < *snapshotCount; ++index) {
+        auto snapshot = ReadSnapshot(reader);
+        if (!snapshot) {
+            return std::nullopt;
+        }
+        snapshots.push_back(std::move(*snapshot));
+    }
+
+    if (!reader.atEnd()) {
+        return std::nullopt;
+    }
+
+    return snapshots;
+}
+
+bool WriteSnapshotFile(const std::filesystem::path& aPath,
+                       std::span<const OpenLotSnapshot> aSnapshots) {
+    const auto buffer = SerializeSnapshots(aSnapshots);
+
+    std::ofstream file(aPath, std::ios::binary | std::ios::trunc);
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!file) {
+        LOG_ERROR("Failed to write FIFO snapshot file {}", aPath.string());
+        return false;
+    }
+
+    return true;
+}
+
+std::optional<std::vector<OpenLotSnapshot>> ReadSnapshotFile(const std::filesystem::path& aPath) {
+    std::ifstream file(aPath, std::ios::binary);
+    if (!file) {
+        LOG_ERROR("Failed to open FIFO snapshot file {}", aPath.string());
+        return std::nullopt;
+    }
+
+    const std::string buffer{std::istreambuf_iterator<char>{file},
+                             std::istreambuf_iterator<char>{}};
+    auto snapshots = DeserializeSnapshots(buffer);
+    if (!snapshots) {
+        LOG_ERROR("FIFO snapshot file {} is corrupted or has an unsupported version",
+                  aPath.string());
+    }
+
+    return snapshots;
+}
+
+} // namespace taxbroker
@@ -0,0 +1,134 @@
+#include "core/match_audit_log.hpp"
+
+#include "utils/date_utils.hpp"
+#include "utils/varint.hpp"
+
+#include <algorithm>
+
+namespace {
+
+using taxbroker::AuditEntry;
+using taxbroker::Date;
+using taxbroker::DayDuration;
+using taxbroker::Units;
+using taxbroker::VarintReader;
+
+} // namespace
+
+namespace taxbroker {
+
+void MatchAuditLog::append(InstrumentLog& aLog, const LotMatch& aMatch) {
+    if (aLog.mCount % CHECKPOINT_INTERVAL == 0) {
+        aLog.mCheckpoints.push_back(Checkpoint{aLog.mBytes.size(), aLog.mLast});
+    }
+
+    const std::int32_t sellDay = DaySerial(aMatch.mSellDate);
+    AppendVarint(aLog.mBytes, aMatch.mSellIndex - aLog.mLast.mSellIndex);
+    AppendSignedVarint(aLog.mBytes, static_cast<std::int64_t>(aMatch.mBuyIndex) -
+                                        static_cast<std::int64_t>(aLog.mLast.mBuyIndex));
+    AppendSignedVarint(aLog.mBytes, sellDay - aLog.mLast.mSellDay);
+    AppendSignedVarint(aLog.mBytes, sellDay - DaySerial(aMatch.mBuyDate));
+    AppendSignedVarint(aLog.mBytes, aMatch.mUnits);
+
+    aLog.mLast = DecoderState{aMatch.mSellIndex, aMatch.mBuyIndex, sellDay};
+    ++aLog.mCount;
+}
+
+void MatchAuditLog::record(std::string_view aScope, std::string_view aIsin,
+                           std::span<const LotMatch> aMatches) {
+    const std::lock_guard lock(mMutex);
+    auto& log = mScopes[std::string{aScope}][std::string{aIsin}];
+    log = InstrumentLog{};
+    for (const auto& match : aMatches) {
+        append(log, match);
+    }
+}
+
+void MatchAuditLog::extend(std::string_view aScope, std::string_view aIsin,
+                           std::span<const LotMatch> aMatches) {
+    const std::lock_guard lock(mMutex);
+    auto& log = mScopes[std::string{aScope}][std::string{aIsin}];
+    for (const auto& match : aMatches) {
+        append(log, match);
+    }
+}
+
+std::vector<AuditEntry> MatchAuditLog::query(std::string_view aScope, std::string_view aIsin,
+                                             Date aFrom, Date aTo) const {
+    std::vector<AuditEntry> entries;
+    // Full 64-bit day counts, so Date::min() and Date::max() work as open bounds.
+    const std::int64_t fromDay = aFrom.time_since_epoch().count();
+    const std::int64_t toDay = aTo.time_since_epoch().count();
+
+    const std::lock_guard lock(mMutex);
+    const auto scope = mScopes.find(std::string{aScope});
+    if (scope == mScopes.end()) {
+        return entries;
+    }
+    const auto position = scope->second.find(std::string{aIsin});
+    if (position == scope->second.end() || position->second.mCount == 0) {
+        return entries;
+    }
+    const auto& log = position->second;
+
+    // Last checkpoint whose previous slice is before the range; later slices may match.
+    const auto checkpoint = std::partition_point(
+        log.mCheckpoints.begin() + 1, log.mCheckpoints.end(),
+        [fromDay](const Checkpoint& aCheckpoint) { return aCheckpoint.mState.mSellDay < fromDay; });
+    const auto& start = *(checkpoint - 1);
+
+    VarintReader reader{log.mBytes};
+    reader.seek(start.mOffset);
+    DecoderState state = start.mState;
+    while (!reader.atEnd()) {
+        const auto sellDelta = reader.readVarint();
+        const auto buyDelta = reader.readSignedVarint();
+        const auto dayDelta = reader.readSignedVarint();
+        const auto heldDays = reader.readSignedVarint();
+        const auto units = reader.readSignedVarint();
+        if (!sellDelta || !buyDelta || !dayDelta || !heldDays || !units) {
+            break;
+        }
+
+        state.mSellIndex += static_cast<std::uint32_t>(*sellDelta);
+        state.mBuyIndex = static_cast<std::uint32_t>(state.mBuyIndex + *buyDelta);
+        state.mSellDay += static_cast<std::int32_t>(*dayDelta);
+        if (state.mSellDay > toDay) {
+            break;
+        }
+        if (state.mSellDay < fromDay) {
+            continue;
+        }
+
+        entries.push_back(AuditEntry{state.mSellIndex, state.mBuyIndex,
+                                     Date{DayDuration{state.mSellDay}},
+                                     Date{DayDuration{state.mSellDay - *heldDays}},
+                                     static_cast<Units>(*units)});
+    }
+
+    return entries;
+}
+
+std::size_t MatchAuditLog::entryCount() const {
+    const std::lock_guard lock(mMutex);
+    std::size_t count = 0;
+    for (const auto& [scope, logs] : mScopes) {
+        for (const auto& [isin, log] : logs) {
+            count += log.mCount;
+        }
+    }
+    return count;
+}
+
+std::size_t MatchAuditLog::encodedBytes() const {
+    const std::lock_guard lock(mMutex);
+    std::size_t bytes = 0;
+    for (const auto& [scope, logs] : mScopes) {
+        for (const auto& [isin, log] : logs) {
+            bytes += log.mBytes.size() + log.mCheckpoints.size() * sizeof(Checkpoint);
+        }
+    }
+    return bytes;
+}
+
+} // namespace taxbroker
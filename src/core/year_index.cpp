@@ -0,0 +1,46 @@
+#include "core/year_index.hpp"
+
+#include "utils/date_utils.hpp"
+
+#include <type_traits>
+
+namespace taxbroker {
+
+YearIndex::YearIndex(std::span<const TradeTransaction> aTransactions) {
+    build(aTransactions);
+}
+
+YearIndex::YearIndex(std::span<const DividendTransaction> aTransactions) {
+    build(aTransactions);
+}
+
+template <typename Transaction>
+void YearIndex::build(std::span<const Transaction> aTransactions) {
+    if (aTransactions.empty()) {
+        return;
+    }
+
+    mFirstYear = YearOf(aTransactions.front().mDate);
+    const int lastYear = YearOf(aTransactions.back().mDate);
+    const auto yearCount = static_cast<std::size_t>(lastYear - mFirstYear + 1);
+    mOffsets.assign(yearCount + 1, aTransactions.size());
+    mHasSells.assign(yearCount, 0);
+
+    // Walk the dates once, comparing against the next year boundary instead of
+    // converting every date to a calendar year.
+    std::size_t slot = 0;
+    mOffsets[0] = 0;
+    Date nextYearBegin = MakeDate(mFirstYear + 1, 1, 1);
+    for (std::size_t position = 0; position < aTransactions.size(); ++position) {
+        const auto& transaction = aTransactions[position];
+        while (transaction.mDate >= nextYearBegin) {
+            mOffsets[++slot] = position;
+            nextYearBegin = MakeDate(mFirstYear + static_cast<int>(slot) + 1, 1, 1);
+        }
+        if constexpr (std::is_same_v<Transaction, TradeTransaction>) {
+            mHasSells[slot] |= static_cast<std::uint8_t>(transaction.mTradeSide == TradeSide::Sell);
+        }
+    }
+}
+
+} // namespace taxbroker
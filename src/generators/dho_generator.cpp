@@ -0,0 +1,130 @@
+#include "generators/dho_generator.hpp"
+
+#include "utils/date_utils.hpp"
+#include "utils/decimal_format.hpp"
+#include "utils/logger.hpp"
+
+#include <string_view>
+
+namespace {
+
+using taxbroker::DhoItem;
+using taxbroker::DhoPayer;
+using taxbroker::MONEY_SCALE_DIGITS;
+using taxbroker::XmlWriter;
+
+// typeDecNonNeg of the Doh-DHO schema.
+constexpr int kAmountPrecision = 2;
+
+struct PayerData {
+    std::string_view mName;
+    std::string_view mAddress;
+    std::string_view mTaxNumber;
+    std::string_view mCountry;
+    std::string_view mCountryCode;
+    std::string_view mInterestType;
+};
+
+constexpr PayerData kTradeRepublic{
+    .mName = "Trade Republic Bank GmbH",
+    .mAddress = "Brunnenstr. 19-21, 10119 Berlin",
+    .mTaxNumber = "DE307510626",
+    .mCountry = "Nemčija",
+    .mCountryCode = "DE",
+    .mInterestType = "1",
+};
+
+void WriteInterest(XmlWriter& aWriter, const DhoItem& aItem) {
+    // Interest of unknown payers cannot be filed without payer data and is left out.
+    if (aItem.mPayer != DhoPayer::TradeRepublic) {
+        return;
+    }
+
+    const auto& payer = kTradeRepublic;
+    aWriter.startElement("Doh_DHO_InterestEarned");
+    aWriter.element("IDeu", payer.mTaxNumber);
+    aWriter.element("Title", payer.mName);
+    aWriter.element("Address", payer.mAddress);
+    aWriter.element("PayerCountryCode", payer.mCountryCode);
+    aWriter.element("PayerCountryName", payer.mCountry);
+    aWriter.element("InterestType", payer.mInterestType);
+    aWriter.decimalElement("InterestEarned", aItem.mAmount, MONEY_SCALE_DIGITS, kAmountPrecision);
+    aWriter.decimalElement("ForeignTaxPaid", aItem.mWithholdTax, MONEY_SCALE_DIGITS,
+                           kAmountPrecision);
+    aWriter.element("SourceCountryCode", payer.mCountryCode);
+    aWriter.element("SourceCountryName", payer.mCountry);
+    aWriter.endElement();
+}
+
+} // namespace
+
+namespace taxbroker {
+
+DohDhoData BuildDhoData(const FinalReport& aReport, const FormData& aForm) {
+    DohDhoData data{aForm, {}};
+    for (const auto& interest : aReport.mInterestTransactions) {
+        if (YearOf(interest.mDate) != aReport.mTaxYear) {
+            continue;
+        }
+        // The form is in EUR; a missing rate is already reported as a processing warning.
+        if (interest.mCurrency != Currency::EUR) {
+            const auto date = FormatIsoDate(interest.mDate);
+            LOG_WARN("Leaving unconverted interest of {} out of Doh-DHO",
+                     std::string_view{date.data(), date.size()});
+            continue;
+        }
+        data.mItems.push_back(DhoItem{DhoPayer::TradeRepublic, interest.mGrossAmount,
+                                      interest.mTaxPaid});
+    }
+    return data;
+}
+
+void WriteDho(XmlWriter& aWriter, const DohDhoData& aData, const TaxPayer& aTaxPayer) {
+    WriteEnvelopeStart(aWriter, XmlSchema::DohDho, aData.mDocId, aTaxPayer);
+
+    aWriter.startElement("edp:bodyContent");
+    aWriter.endElement();
+
+    aWriter.startElement("Doh_DHO");
+    aWriter.startElement("Doh_DHO_TaxPayerData");
+    if (aData.mEmail) {
+        aWriter.element("Email", *aData.mEmail);
+    }
+    if (aData.mTelephoneNumber) {
+        aWriter.element("PhoneNumber", *aData.mTelephoneNumber);
+    }
+    aWriter.booleanElement("SelfReport", aData.mDocId == FormType::SelfReport);
+    aWriter.booleanElement("IsResident", aData.mIsResident);
+    aWriter.endElement();
+
+    Money totalAmount = 0;
+    Money totalWithholdTax = 0;
+    for (const auto& item : aData.mItems) {
+        WriteInterest(aWriter, item);
+        if (item.mPayer == DhoPayer::TradeRepublic) {
+            totalAmount += item.mAmount;
+            totalWithholdTax += item.mWithholdTax;
+        }
+    }
+
+    aWriter.startElement("Doh_DHO_Totals");
+    aWriter.decimalElement("TotalInterestEarned", totalAmount, MONEY_SCALE_DIGITS,
+                           kAmountPrecision);
+    aWriter.decimalElement("TotalForeignTaxPaid", totalWithholdTax, MONEY_SCALE_DIGITS,
+                           kAmountPrecision);
+    aWriter.integerElement("Year", aData.mYear);
+    aWriter.endElement();
+    aWriter.endElement();
+
+    WriteEnvelopeEnd(aWriter);
+}
+
+std::string GenerateDho(const DohDhoData& aData, const TaxPayer& aTaxPayer) {
+    std::string document;
+    XmlWriter writer{document};
+    WriteDho(writer, aData, aTaxPayer);
+    (void)writer.finish();
+    return document;
+}
+
+} // namespace taxbroker
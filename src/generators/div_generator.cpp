@@ -0,0 +1,101 @@
+#include "generators/div_generator.hpp"
+
+#include "utils/decimal_format.hpp"
+#include "utils/logger.hpp"
+
+namespace {
+
+using taxbroker::DivItem;
+using taxbroker::MONEY_SCALE_DIGITS;
+using taxbroker::XmlWriter;
+
+// Amount_Type of the Doh-Div schema.
+constexpr int kAmountPrecision = 2;
+
+void WriteDividend(XmlWriter& aWriter, const DivItem& aItem) {
+    aWriter.startElement("Dividend");
+    aWriter.dateElement("Date", aItem.mDate);
+    aWriter.element("PayerIdentificationNumber", aItem.mPayer.mIsin);
+    if (aItem.mPayer.mName) {
+        aWriter.element("PayerName", *aItem.mPayer.mName);
+    }
+    if (aItem.mPayer.mAddress) {
+        aWriter.element("PayerAddress", *aItem.mPayer.mAddress);
+    }
+    if (aItem.mPayer.mCountryCode) {
+        aWriter.element("PayerCountry", *aItem.mPayer.mCountryCode);
+    }
+    aWriter.element("Type", aItem.mType);
+    aWriter.decimalElement("Value", aItem.mGrossIncome, MONEY_SCALE_DIGITS, kAmountPrecision);
+    if (aItem.mWithholdingTax) {
+        aWriter.decimalElement("ForeignTax", *aItem.mWithholdingTax, MONEY_SCALE_DIGITS,
+                               kAmountPrecision);
+    }
+    if (aItem.mSourceCountryCode) {
+        aWriter.element("SourceCountry", *aItem.mSourceCountryCode);
+    }
+    if (aItem.mForeignTaxPaid) {
+        aWriter.booleanElement("ReliefStatement", *aItem.mForeignTaxPaid);
+    }
+    aWriter.endElement();
+}
+
+} // namespace
+
+namespace taxbroker {
+
+DohDivData BuildDivData(const FinalReport& aReport, const FormData& aForm) {
+    DohDivData data{aForm, {}};
+    data.mItems.reserve(aReport.mDividends.mGroups.size());
+    for (const auto& group : aReport.mDividends.mGroups) {
+        // The form is in EUR; a missing rate is already reported as a processing warning.
+        if (group.mCurrency != Currency::EUR) {
+            LOG_WARN("Leaving unconverted dividends of {} out of Doh-Div", group.mIsin);
+            continue;
+        }
+
+        DivItem item;
+        item.mDate = group.mDate;
+        item.mPayer.mIsin = group.mIsin;
+        item.mPayer.mName = group.mName;
+        item.mGrossIncome = group.mGrossAmount;
+        item.mWithholdingTax = group.mTaxPaid;
+        if (!group.mSourceCountry.empty()) {
+            item.mPayer.mCountryCode = group.mSourceCountry;
+            item.mSourceCountryCode = group.mSourceCountry;
+        }
+        data.mItems.push_back(std::move(item));
+    }
+    return data;
+}
+
+void WriteDiv(XmlWriter& aWriter, const DohDivData& aData, const TaxPayer& aTaxPayer) {
+    WriteEnvelopeStart(aWriter, XmlSchema::DohDiv, aData.mDocId, aTaxPayer);
+
+    aWriter.startElement("Doh_Div");
+    aWriter.integerElement("Period", aData.mYear);
+    if (aData.mEmail) {
+        aWriter.element("EmailAddress", *aData.mEmail);
+    }
+    if (aData.mTelephoneNumber) {
+        aWriter.element("PhoneNumber", *aData.mTelephoneNumber);
+    }
+    aWriter.booleanElement("IsResident", aData.mIsResident);
+    aWriter.endElement();
+
+    for (const auto& item : aData.mItems) {
+        WriteDividend(aWriter, item);
+    }
+
+    WriteEnvelopeEnd(aWriter);
+}
+
+std::string GenerateDiv(const DohDivData& aData, const TaxPayer& aTaxPayer) {
+    std::string document;
+    XmlWriter writer{document};
+    WriteDiv(writer, aData, aTaxPayer);
+    (void)writer.finish();
+    return document;
+}
+
+} // namespace taxbroker
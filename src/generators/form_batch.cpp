@@ -0,0 +1,183 @@
+#include "generators/form_batch.hpp"
+
+#include "generators/dho_generator.hpp"
+#include "generators/div_generator.hpp"
+#include "generators/form_generator.hpp"
+#include "generators/xml_validator.hpp"
+#include "utils/fd_write.hpp"
+#include "utils/logger.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using taxbroker::BatchDocument;
+using taxbroker::BatchFiling;
+using taxbroker::FormBatch;
+using taxbroker::XmlSchema;
+using taxbroker::XmlValidator;
+using taxbroker::XmlWriter;
+
+// Arena estimate: envelope with a typical taxpayer, and per item of each form.
+constexpr std::size_t kDocumentBytes = 1024;
+constexpr std::size_t kDivItemBytes = 320;
+constexpr std::size_t kDhoItemBytes = 128;
+
+bool IsFileStem(std::string_view aText) {
+    return !aText.empty() && std::all_of(aText.begin(), aText.end(), [](char aCharacter) {
+        return std::isalnum(static_cast<unsigned char>(aCharacter)) != 0;
+    });
+}
+
+std::size_t EstimateArena(std::span<const BatchFiling> aFilings) {
+    std::size_t bytes = 0;
+    for (const auto& filing : aFilings) {
+        if (filing.mDiv) {
+            bytes += kDocumentBytes + filing.mDiv->mItems.size() * kDivItemBytes;
+        }
+        if (filing.mDho) {
+            bytes += kDocumentBytes + filing.mDho->mItems.size() * kDhoItemBytes;
+        }
+    }
+    return bytes;
+}
+
+// <tax number>_<year>_<entry>, e.g. 12345678_2024_Doh_Div.xml.
+std::string FileName(std::string_view aTaxNumber, int aYear, std::string_view aEntry) {
+    std::string name{aTaxNumber};
+    name += '_';
+    name += std::to_string(aYear);
+    name += '_';
+    name += aEntry;
+    return name;
+}
+
+/*
+    Renders one document with aWrite at the end of the arena and records it. The
+    writer and validator carry over from the previous document. A document whose
+    file name an earlier one already has is skipped, so no file overwrites another.
+*/
+template <typename Write>
+void RenderDocument(FormBatch& aBatch, std::unordered_set<std::string>& aFileNames,
+                    XmlWriter& aWriter, XmlValidator& aValidator, std::size_t aFiling,
+                    XmlSchema aForm, std::string aFileName, Write aWrite) {
+    if (aFileNames.contains(aFileName)) {
+        LOG_ERROR("Skipping {} of filing {}: an earlier filing has the same file", aFileName,
+                  aFiling);
+        aBatch.mErrors.push_back("filing " + std::to_string(aFiling) + ": " + aFileName +
+                                 " duplicates an earlier filing");
+        return;
+    }
+
+    BatchDocument document;
+    document.mFiling = aFiling;
+    document.mForm = aForm;
+    document.mOffset = aBatch.mArena.size();
+    document.mFileNameOffset = aBatch.mFileNames.size();
+    aBatch.mFileNames.append(aFileName);
+    document.mFileNameLength = aFileName.size();
+    aFileNames.insert(std::move(aFileName));
+
+    aValidator.reset();
+    aWriter.setValidator(&aValidator);
+    aWrite(aWriter);
+    (void)aWriter.finish();
+    aWriter.nextDocument();
+    document.mLength = aBatch.mArena.size() - document.mOffset;
+
+    if (!aValidator.valid()) {
+        const std::string_view fileName = aBatch.fileName(document);
+        LOG_WARN("{} has {} schema violation(s), first: {}", fileName, aValidator.errorCount(),
+                 aValidator.errors().front());
+        for (const auto& error : aValidator.errors()) {
+            aBatch.mErrors.push_back(std::string{fileName} + ": " + error);
+        }
+    }
+    aBatch.mDocuments.push_back(document);
+}
+
+} // namespace
+
+namespace taxbroker {
+
+FormBatch RenderFormBatch(std::span<const BatchFiling> aFilings) {
+    FormBatch batch;
+    batch.mArena.reserve(EstimateArena(aFilings));
+    batch.mDocuments.reserve(aFilings.size() * 2);
+
+    XmlWriter writer{batch.mArena};
+    XmlValidator divValidator{XmlSchema::DohDiv};
+    XmlValidator dhoValidator{XmlSchema::DohDho};
+    std::unordered_set<std::string> fileNames;
+
+    for (std::size_t index = 0; index < aFilings.size(); ++index) {
+        const BatchFiling& filing = aFilings[index];
+        const std::string& taxNumber = filing.mTaxPayer.mTaxNumber;
+        if (!IsFileStem(taxNumber)) {
+            LOG_ERROR("Skipping filing {}: tax number '{}' cannot name a file", index, taxNumber);
+            batch.mErrors.push_back("filing " + std::to_string(index) + ": tax number '" +
+                                    taxNumber + "' cannot name a file");
+            continue;
+        }
+
+        if (filing.mDiv) {
+            RenderDocument(batch, fileNames, writer, divValidator, index, XmlSchema::DohDiv,
+                           FileName(taxNumber, filing.mDiv->mYear, BUNDLE_DIV_ENTRY),
+                           [&filing](XmlWriter& aWriter) {
+                               WriteDiv(aWriter, *filing.mDiv, filing.mTaxPayer);
+                           });
+        }
+        if (filing.mDho) {
+            RenderDocument(batch, fileNames, writer, dhoValidator, index, XmlSchema::DohDho,
+                           FileName(taxNumber, filing.mDho->mYear, BUNDLE_DHO_ENTRY),
+                           [&filing](XmlWriter& aWriter) {
+                               WriteDho(aWriter, *filing.mDho, filing.mTaxPayer);
+                           });
+        }
+    }
+    writer.setValidator(nullptr);
+    return batch;
+}
+
+std::size_t WriteFormBatch(const FormBatch& aBatch, const std::string& aDirectory) {
+    const int directory = ::open(aDirectory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directory < 0) {
+        LOG_ERROR("Cannot open batch directory {}: {}", aDirectory, std::strerror(errno));
+        return 0;
+    }
+
+    std::size_t written = 0;
+    std::string fileName;
+    for (const auto& document : aBatch.mDocuments) {
+        fileName.assign(aBatch.fileName(document));
+        const int fd = ::openat(directory, fileName.c_str(),
+                                O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            LOG_ERROR("Cannot create {}/{}: {}", aDirectory, fileName, std::strerror(errno));
+            continue;
+        }
+
+        const std::string_view bytes = aBatch.document(document);
+        iovec chunk{const_cast<char*>(bytes.data()), bytes.size()};
+        const bool ok = WriteAll(fd, std::span<iovec>{&chunk, 1});
+        if (!ok) {
+            LOG_ERROR("Writing {}/{} failed: {}", aDirectory, fileName, std::strerror(errno));
+        }
+        if (::close(fd) != 0 && ok) {
+            LOG_ERROR("Closing {}/{} failed: {}", aDirectory, fileName, std::strerror(errno));
+        } else if (ok) {
+            ++written;
+        }
+    }
+    ::close(directory);
+    return written;
+}
+
+} // namespace taxbroker
@@ -0,0 +1,208 @@
+#include "generators/form_generator.hpp"
+
+#include "generators/dho_generator.hpp"
+#include "generators/div_generator.hpp"
+#include "generators/kdvp_generator.hpp"
+#include "generators/xml_validator.hpp"
+#include "utils/date_utils.hpp"
+#include "utils/decimal_format.hpp"
+#include "utils/logger.hpp"
+
+#include <array>
+#include <exception>
+#include <future>
+#include <span>
+
+namespace {
+
+using taxbroker::Date;
+using taxbroker::DECIMAL_BUFFER_SIZE;
+using taxbroker::FinalReport;
+using taxbroker::FormatDecimal;
+using taxbroker::FormatIsoDate;
+using taxbroker::MONEY_SCALE_DIGITS;
+using taxbroker::UNITS_SCALE_DIGITS;
+using taxbroker::XmlSchema;
+using taxbroker::XmlValidator;
+using taxbroker::XmlWriter;
+using taxbroker::ZipWriter;
+
+// Audit lines are handed to the archive in chunks of about this size.
+constexpr std::size_t kAuditBufferSize = 64 * 1024;
+
+/*
+    Runs aWrite on aWriter validated against aSchema. Violations are logged and
+    appended to aErrors.
+*/
+template <typename Write>
+void WriteValidated(XmlWriter& aWriter, XmlSchema aSchema, std::vector<std::string>& aErrors,
+                    Write aWrite) {
+    XmlValidator validator{aSchema};
+    aWriter.setValidator(&validator);
+    aWrite(aWriter);
+    (void)aWriter.finish();
+    aWriter.setValidator(nullptr);
+
+    if (!validator.valid()) {
+        LOG_WARN("Generated XML has {} schema violation(s), first: {}", validator.errorCount(),
+                 validator.errors().front());
+        aErrors.insert(aErrors.end(), validator.errors().begin(), validator.errors().end());
+    }
+}
+
+// As above on a string writer; the document is returned either way.
+template <typename Write>
+std::string WriteValidated(XmlSchema aSchema, std::vector<std::string>& aErrors, Write aWrite) {
+    std::string document;
+    XmlWriter writer{document};
+    WriteValidated(writer, aSchema, aErrors, aWrite);
+    return document;
+}
+
+// One CSV line per FIFO lot slice of every instrument, in report order.
+void WriteMatchAudit(ZipWriter& aArchive, const FinalReport& aReport) {
+    std::string buffer;
+    buffer.reserve(kAuditBufferSize);
+    buffer.append("isin,sell_index,buy_index,buy_date,sell_date,units,buy_unit_price,"
+                  "sell_unit_price\n");
+
+    std::array<char, DECIMAL_BUFFER_SIZE> digits;
+    const auto appendDecimal = [&](std::int64_t aValue, int aScaleDigits) {
+        buffer.push_back(',');
+        buffer.append(FormatDecimal(aValue, aScaleDigits, aScaleDigits, digits.data()));
+    };
+    const auto appendDate = [&buffer](Date aDate) {
+        const auto text = FormatIsoDate(aDate);
+        buffer.push_back(',');
+        buffer.append(text.data(), text.size());
+    };
+
+    for (const auto& instrument : aReport.mInstruments) {
+        const auto& matches = instrument.mMatches;
+        for (const auto& match : matches.mMatches) {
+            buffer.append(matches.mIsin);
+            appendDecimal(match.mSellIndex, 0);
+            appendDecimal(match.mBuyIndex, 0);
+            appendDate(match.mBuyDate);
+            appendDate(match.mSellDate);
+            appendDecimal(match.mUnits, UNITS_SCALE_DIGITS);
+            appendDecimal(match.mBuyUnitPrice, MONEY_SCALE_DIGITS);
+            appendDecimal(match.mSellUnitPrice, MONEY_SCALE_DIGITS);
+            buffer.push_back('\n');
+            if (buffer.size() >= kAuditBufferSize) {
+                aArchive.write(buffer);
+                buffer.clear();
+            }
+        }
+    }
+    aArchive.write(buffer);
+}
+
+} // namespace
+
+namespace taxbroker {
+
+GeneratedForms GenerateForms(const FinalReport& aReport, const FormData& aForm,
+                             const TaxPayer& aTaxPayer, ThreadPool& aPool,
+                             FormSelection aSelection, FragmentCache* aKdvpCache) {
+    GeneratedForms forms;
+    std::vector<std::string> divErrors;
+    std::vector<std::string> dhoErrors;
+
+    // Doh-Div and Doh-DHO; both write into forms and the error vectors above.
+    std::array<std::future<void>, 2> smallForms;
+    if (aSelection.mDiv) {
+        smallForms[0] = aPool.submit([&aReport, &aForm, &aTaxPayer, &forms, &divErrors]() {
+            const auto data = BuildDivData(aReport, aForm);
+            forms.mDiv = WriteValidated(XmlSchema::DohDiv, divErrors, [&](XmlWriter& aWriter) {
+                WriteDiv(aWriter, data, aTaxPayer);
+            });
+        });
+    }
+    if (aSelection.mDho) {
+        smallForms[1] = aPool.submit([&aReport, &aForm, &aTaxPayer, &forms, &dhoErrors]() {
+            const auto data = BuildDhoData(aReport, aForm);
+            forms.mDho = WriteValidated(XmlSchema::DohDho, dhoErrors, [&](XmlWriter& aWriter) {
+                WriteDho(aWriter, data, aTaxPayer);
+            });
+        });
+    }
+
+    std::exception_ptr kdvpFailure;
+    if (aSelection.mKdvp) {
+        try {
+            const auto data = BuildKdvpData(aReport, aForm);
+            forms.mKdvp = WriteValidated(XmlSchema::DohKdvp, forms.mValidationErrors,
+                                         [&](XmlWriter& aWriter) {
+                                             WriteKdvp(aWriter, data, aTaxPayer, aPool,
+                                                       aKdvpCache);
+                                         });
+        } catch (...) {
+            kdvpFailure = std::current_exception();
+        }
+    }
+
+    // The tasks reference this frame, so they finish before any failure leaves it.
+    aPool.awaitAll(std::span{smallForms});
+    if (kdvpFailure) {
+        std::rethrow_exception(kdvpFailure);
+    }
+
+    forms.mValidationErrors.insert(forms.mValidationErrors.end(), divErrors.begin(),
+                                   divErrors.end());
+    forms.mValidationErrors.insert(forms.mValidationErrors.end(), dhoErrors.begin(),
+                                   dhoErrors.end());
+    return forms;
+}
+
+std::vector<std::string> WriteFormBundle(ZipWriter& aArchive, const FinalReport& aReport,
+                                         const FormData& aForm, const TaxPayer& aTaxPayer,
+                                         ThreadPool& aPool, FormSelection aSelection,
+                                         FragmentCache* aKdvpCache) {
+    // Doh-Div and Doh-DHO are small; they render on the pool while Doh-KDVP streams.
+    const FormSelection smallForms{.mKdvp = false, .mDiv = aSelection.mDiv,
+                                   .mDho = aSelection.mDho};
+    std::future<GeneratedForms> rendered = aPool.submit([&aReport, &aForm, &aTaxPayer, &aPool,
+                                                         smallForms]() {
+        return GenerateForms(aReport, aForm, aTaxPayer, aPool, smallForms);
+    });
+
+    std::vector<std::string> errors;
+    try {
+        if (aSelection.mKdvp) {
+            const auto data = BuildKdvpData(aReport, aForm);
+            aArchive.beginEntry(BUNDLE_KDVP_ENTRY);
+            XmlWriter writer{aArchive};
+            WriteValidated(writer, XmlSchema::DohKdvp, errors, [&](XmlWriter& aWriter) {
+                WriteKdvp(aWriter, data, aTaxPayer, aPool, aKdvpCache);
+            });
+        }
+    } catch (...) {
+        // The small forms read the caller's report; let them finish before leaving.
+        const auto failure = std::current_exception();
+        try {
+            (void)aPool.await(rendered);
+        } catch (...) {
+            // Doh-KDVP failed first; that is the failure reported.
+        }
+        std::rethrow_exception(failure);
+    }
+
+    GeneratedForms forms = aPool.await(rendered);
+    if (forms.mDiv) {
+        aArchive.beginEntry(BUNDLE_DIV_ENTRY);
+        aArchive.write(*forms.mDiv);
+    }
+    if (forms.mDho) {
+        aArchive.beginEntry(BUNDLE_DHO_ENTRY);
+        aArchive.write(*forms.mDho);
+    }
+    errors.insert(errors.end(), forms.mValidationErrors.begin(), forms.mValidationErrors.end());
+
+    aArchive.beginEntry(BUNDLE_AUDIT_ENTRY);
+    WriteMatchAudit(aArchive, aReport);
+    aArchive.endEntry();
+    return errors;
+}
+
+} // namespace taxbroker
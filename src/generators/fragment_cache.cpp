@@ -0,0 +1,10 @@
+#include "generators/fragment_cache.hpp"
+
+namespace taxbroker {
+
+void FragmentCache::insert(const ContentHash& aKey, std::shared_ptr<const std::string> aFragment) {
+    const std::size_t bytes = aFragment->capacity();
+    LruByteCache::insert(aKey, std::move(aFragment), bytes);
+}
+
+} // namespace taxbroker
@@ -0,0 +1,503 @@
+#include "generators/kdvp_generator.hpp"
+
+#include "generators/xml_validator.hpp"
+#include "utils/date_utils.hpp"
+#include "utils/decimal_format.hpp"
+#include "utils/logger.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+using taxbroker::ContentHasher;
+using taxbroker::Date;
+using taxbroker::DohKdvpData;
+using taxbroker::FindSchemaElement;
+using taxbroker::FormData;
+using taxbroker::FragmentCache;
+using taxbroker::GainType;
+using taxbroker::InstrumentReport;
+using taxbroker::InventoryListType;
+using taxbroker::KDVP_CHUNKS_PER_THREAD;
+using taxbroker::KdvpItem;
+using taxbroker::KdvpRow;
+using taxbroker::MakeKdvpItemKey;
+using taxbroker::Money;
+using taxbroker::MONEY_SCALE_DIGITS;
+using taxbroker::Securities;
+using taxbroker::TaxPayer;
+using taxbroker::ThreadPool;
+using taxbroker::Units;
+using taxbroker::UNITS_SCALE_DIGITS;
+using taxbroker::XmlParticle;
+using taxbroker::XmlSchema;
+using taxbroker::XmlValidator;
+using taxbroker::XmlWriter;
+
+constexpr std::string_view kItemStartTag = "<KDVPItem>";
+
+// Decimals of the Doh-KDVP number types: quantities and per-unit values 8, taxes 4.
+constexpr int kQuantityPrecision = 8;
+constexpr int kUnitValuePrecision = 8;
+constexpr int kTaxPrecision = 4;
+
+void AddValue(ContentHasher& aHasher, std::int64_t aValue) {
+    aHasher.add(aValue);
+}
+
+void AddValue(ContentHasher& aHasher, bool aValue) {
+    aHasher.add(std::uint64_t{aValue});
+}
+
+void AddValue(ContentHasher& aHasher, GainType aValue) {
+    aHasher.add(static_cast<std::uint64_t>(aValue));
+}
+
+void AddValue(ContentHasher& aHasher, Date aValue) {
+    aHasher.add(static_cast<std::int64_t>(taxbroker::DaySerial(aValue)));
+}
+
+void AddValue(ContentHasher& aHasher, const std::string& aValue) {
+    aHasher.add(std::string_view{aValue});
+}
+
+// Presence flag first, so a missing field never hashes like a present zero.
+template <typename Value>
+void AddOptional(ContentHasher& aHasher, const std::optional<Value>& aValue) {
+    aHasher.add(std::uint64_t{aValue.has_value()});
+    if (aValue) {
+        AddValue(aHasher, *aValue);
+    }
+}
+
+/*
+    Rows of the tax-year sales of one instrument: one purchase row per consumed buy
+    (units summed over its slices) and one sale row per sell, merged by date with
+    purchases first on equal dates. F8 is the running stock of the reported units.
+*/
+std::vector<KdvpRow> BuildRows(const InstrumentReport& aReport) {
+    std::unordered_map<std::uint32_t, Money> saleUnitPrices;
+    for (const auto& sale : aReport.mTax.mSales) {
+        saleUnitPrices.emplace(sale.mSellIndex, Money{});
+    }
+
+    // FIFO consumes the oldest lot first, so first-seen buys are in date order.
+    std::vector<KdvpRow> purchases;
+    std::unordered_map<std::uint32_t, std::size_t> purchaseOfBuy;
+    for (const auto& match : aReport.mMatches.mMatches) {
+        const auto salePrice = saleUnitPrices.find(match.mSellIndex);
+        if (salePrice == saleUnitPrices.end()) {
+            continue;
+        }
+        salePrice->second = match.mSellUnitPrice;
+
+        const auto [slot, inserted] = purchaseOfBuy.try_emplace(match.mBuyIndex, purchases.size());
+        if (!inserted) {
+            purchases[slot->second].mQuantity += match.mUnits;
+            continue;
+        }
+        purchases.push_back(taxbroker::MakePurchaseRow(match.mBuyDate, GainType::B, match.mUnits,
+                                                       match.mBuyUnitPrice));
+    }
+
+    std::vector<KdvpRow> rows;
+    rows.reserve(purchases.size() + aReport.mTax.mSales.size());
+    std::size_t nextPurchase = 0;
+    Units stock = 0;
+    const auto appendRow = [&rows, &stock](KdvpRow aRow, Units aDelta) {
+        stock += aDelta;
+        aRow.mId = static_cast<std::int32_t>(rows.size());
+        aRow.mF8 = stock;
+        aRow.mFields |= KdvpRow::F8;
+        rows.push_back(aRow);
+    };
+    const auto appendPurchasesUntil = [&](Date aDate) {
+        for (; nextPurchase < purchases.size(); ++nextPurchase) {
+            const auto& purchase = purchases[nextPurchase];
+            if (purchase.mDate > aDate) {
+                break;
+            }
+            appendRow(purchase, purchase.mQuantity);
+        }
+    };
+
+    for (const auto& sale : aReport.mTax.mSales) {
+        appendPurchasesUntil(sale.mSellDate);
+        appendRow(taxbroker::MakeSaleRow(sale.mSellDate, sale.mUnits,
+                                         saleUnitPrices[sale.mSellIndex], sale.mLossDisallowed),
+                  -sale.mUnits);
+    }
+    appendPurchasesUntil(Date::max());
+    return rows;
+}
+
+void WriteRow(XmlWriter& aWriter, const KdvpRow& aRow) {
+    aWriter.startElement("Row");
+    aWriter.integerElement("ID", aRow.mId);
+
+    if (!aRow.isSale()) {
+        aWriter.startElement("Purchase");
+        if (aRow.has(KdvpRow::DATE)) {
+            aWriter.dateElement("F1", aRow.mDate);
+        }
+        if (aRow.has(KdvpRow::F2)) {
+            aWriter.element("F2", taxbroker::ToString(aRow.mF2));
+        }
+        if (aRow.has(KdvpRow::QUANTITY)) {
+            aWriter.decimalElement("F3", aRow.mQuantity, UNITS_SCALE_DIGITS, kQuantityPrecision);
+        }
+        if (aRow.has(KdvpRow::UNIT_VALUE)) {
+            aWriter.decimalElement("F4", aRow.mUnitValue, MONEY_SCALE_DIGITS,
+                                   kUnitValuePrecision);
+        }
+        if (aRow.has(KdvpRow::F5)) {
+            aWriter.decimalElement("F5", aRow.mF5, MONEY_SCALE_DIGITS, kTaxPrecision);
+        }
+        if (aRow.has(KdvpRow::F11)) {
+            aWriter.decimalElement("F11", aRow.mF11, MONEY_SCALE_DIGITS, kUnitValuePrecision);
+        }
+        aWriter.endElement();
+    } else {
+        aWriter.startElement("Sale");
+        if (aRow.has(KdvpRow::DATE)) {
+            aWriter.dateElement("F6", aRow.mDate);
+        }
+        if (aRow.has(KdvpRow::QUANTITY)) {
+            aWriter.decimalElement("F7", aRow.mQuantity, UNITS_SCALE_DIGITS, kQuantityPrecision);
+        }
+        if (aRow.has(KdvpRow::UNIT_VALUE)) {
+            aWriter.decimalElement("F9", aRow.mUnitValue, MONEY_SCALE_DIGITS,
+                                   kUnitValuePrecision);
+        }
+        if (aRow.has(KdvpRow::F10)) {
+            aWriter.booleanElement("F10", aRow.mF10);
+        }
+        aWriter.endElement();
+    }
+
+    if (aRow.has(KdvpRow::F8)) {
+        aWriter.decimalElement("F8", aRow.mF8, UNITS_SCALE_DIGITS, kQuantityPrecision);
+    }
+    aWriter.endElement();
+}
+
+void WriteSecurities(XmlWriter& aWriter, const Securities& aSecurities) {
+    aWriter.startElement("Securities");
+    if (aSecurities.mIsin) {
+        aWriter.element("ISIN", *aSecurities.mIsin);
+    }
+    if (aSecurities.mCode) {
+        aWriter.element("Code", *aSecurities.mCode);
+    }
+    aWriter.element("Name", aSecurities.mName);
+    aWriter.booleanElement("IsFond", aSecurities.mIsFond);
+    if (aSecurities.mResolution) {
+        aWriter.element("Resolution", *aSecurities.mResolution);
+    }
+    if (aSecurities.mResolutionDate) {
+        aWriter.dateElement("ResolutionDate", *aSecurities.mResolutionDate);
+    }
+    for (const auto& row : aSecurities.mRows) {
+        WriteRow(aWriter, row);
+    }
+    aWriter.endElement();
+}
+
+// Without aWithItemId the item renders the same at every position of the form.
+void WriteItem(XmlWriter& aWriter, const KdvpItem& aItem, bool aWithItemId = true) {
+    aWriter.startElement("KDVPItem");
+    if (aItem.mItemId && aWithItemId) {
+        aWriter.integerElement("ItemID", *aItem.mItemId);
+    }
+    aWriter.element("InventoryListType", taxbroker::ToString(aItem.mType));
+
+    if (aItem.mHasForeignTax.value_or(false)) {
+        aWriter.booleanElement("HasForeignTax", true);
+        if (aItem.mForeignTaxAmount) {
+            aWriter.decimalElement("ForeignTax", *aItem.mForeignTaxAmount, MONEY_SCALE_DIGITS,
+                                   kTaxPrecision);
+        }
+        if (aItem.mForeignCountryId) {
+            aWriter.element("FTCountryID", *aItem.mForeignCountryId);
+        }
+    }
+
+    if (aItem.mSecurities) {
+        WriteSecurities(aWriter, *aItem.mSecurities);
+    }
+    aWriter.endElement();
+}
+
+void WriteHead(XmlWriter& aWriter, const DohKdvpData& aData, const TaxPayer& aTaxPayer) {
+    WriteEnvelopeStart(aWriter, taxbroker::XmlSchema::DohKdvp, aData.mDocId, aTaxPayer);
+
+    aWriter.startElement("edp:bodyContent");
+    aWriter.endElement();
+
+    aWriter.startElement("Doh_KDVP");
+    aWriter.startElement("KDVP");
+    aWriter.element("DocumentWorkflowID", taxbroker::WorkflowId(aData.mDocId));
+    aWriter.element("DocumentWorkflowName", taxbroker::ToString(aData.mDocId));
+    aWriter.integerElement("Year", aData.mYear);
+    aWriter.dateElement("PeriodStart", taxbroker::MakeDate(aData.mYear, 1, 1));
+    aWriter.dateElement("PeriodEnd", taxbroker::MakeDate(aData.mYear, 12, 31));
+    aWriter.booleanElement("IsResident", aData.mIsResident);
+    if (aData.mTelephoneNumber) {
+        aWriter.element("TelephoneNumber", *aData.mTelephoneNumber);
+    }
+
+    const auto securityCount =
+        std::count_if(aData.mItems.begin(), aData.mItems.end(), [](const KdvpItem& aItem) {
+            return aItem.mType == InventoryListType::PLVP;
+        });
+    aWriter.integerElement("SecurityCount", securityCount);
+    aWriter.integerElement("SecurityShortCount", 0);
+    aWriter.integerElement("SecurityWithContractCount", 0);
+    aWriter.integerElement("SecurityWithContractShortCount", 0);
+    aWriter.integerElement("ShareCount", 0);
+    if (aData.mEmail) {
+        aWriter.element("Email", *aData.mEmail);
+    }
+    aWriter.endElement();
+}
+
+// Closes Doh_KDVP and the envelope.
+void WriteTail(XmlWriter& aWriter) {
+    aWriter.endElement();
+    WriteEnvelopeEnd(aWriter);
+}
+
+// One fragment without ItemID per item of aItems, rendered in chunks on aPool.
+std::vector<std::shared_ptr<const std::string>>
+RenderItems(std::span<const KdvpItem> aItems, const FormData& aForm, ThreadPool& aPool,
+            FragmentCache* aCache, XmlValidator* aValidator) {
+    std::vector<std::shared_ptr<const std::string>> fragments(aItems.size());
+    if (aItems.empty()) {
+        return fragments;
+    }
+
+    // Items are validated on their own; failed validators are merged in item order.
+    const XmlParticle* itemRoot =
+        aValidator != nullptr ? FindSchemaElement(XmlSchema::DohKdvp, "KDVPItem") : nullptr;
+    std::vector<std::optional<XmlValidator>> failures(itemRoot != nullptr ? aItems.size() : 0);
+
+    const auto renderItem = [itemRoot, &failures](const KdvpItem& aItem, std::size_t aIndex) {
+        std::string fragment;
+        XmlWriter writer{fragment};
+        std::optional<XmlValidator> validator;
+        if (itemRoot != nullptr) {
+            writer.setValidator(&validator.emplace(*itemRoot));
+        }
+        WriteItem(writer, aItem, false);
+        (void)writer.finish();
+        if (validator && !validator->valid()) {
+            failures[aIndex].emplace(std::move(*validator));
+        }
+        return fragment;
+    };
+
+    // Validated runs only reuse fragments that passed validation.
+    const auto render = [&](std::size_t aIndex) {
+        const KdvpItem& item = aItems[aIndex];
+        if (aCache == nullptr) {
+            return std::make_shared<const std::string>(renderItem(item, aIndex));
+        }
+        const auto key = MakeKdvpItemKey(item, aForm, itemRoot != nullptr);
+        if (auto cached = aCache->find(key)) {
+            return cached;
+        }
+        auto fragment = std::make_shared<const std::string>(renderItem(item, aIndex));
+        if (itemRoot == nullptr || !failures[aIndex]) {
+            aCache->insert(key, fragment);
+        }
+        return fragment;
+    };
+
+    const std::size_t chunkCount =
+        std::min(aItems.size(), aPool.threadCount() * KDVP_CHUNKS_PER_THREAD);
+    const std::size_t chunkSize = (aItems.size() + chunkCount - 1) / chunkCount;
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(chunkCount);
+    for (std::size_t begin = 0; begin < aItems.size(); begin += chunkSize) {
+        const std::size_t end = std::min(begin + chunkSize, aItems.size());
+        pending.push_back(aPool.submit([&fragments, &render, begin, end]() {
+            for (std::size_t index = begin; index < end; ++index) {
+                fragments[index] = render(index);
+            }
+        }));
+    }
+
+    // Every chunk writes into fragments and calls render; none may outlive them.
+    aPool.awaitAll(std::span{pending});
+
+    for (const auto& failure : failures) {
+        if (failure) {
+            aValidator->merge(*failure);
+        }
+    }
+    return fragments;
+}
+
+// Splices aFragments of aItems into aWriter, each with its item's ItemID after the start tag.
+void WriteFragments(XmlWriter& aWriter, std::span<const KdvpItem> aItems,
+                    const std::vector<std::shared_ptr<const std::string>>& aFragments) {
+    std::vector<std::string> itemIds;
+    itemIds.reserve(aFragments.size()); // Never reallocates, so the views stay valid.
+    std::vector<std::string_view> views;
+    views.reserve(aFragments.size() * 2);
+    for (std::size_t index = 0; index < aFragments.size(); ++index) {
+        const std::string_view fragment = *aFragments[index];
+        const auto& itemId = aItems[index].mItemId;
+        if (!itemId) {
+            views.push_back(fragment);
+            continue;
+        }
+        assert(fragment.starts_with(kItemStartTag));
+        itemIds.push_back(std::string{kItemStartTag} + "<ItemID>" + std::to_string(*itemId) +
+                          "</ItemID>");
+        views.emplace_back(itemIds.back());
+        views.push_back(fragment.substr(kItemStartTag.size()));
+    }
+    aWriter.fragments(views, "KDVPItem", aFragments.size());
+}
+
+} // namespace
+
+namespace taxbroker {
+
+DohKdvpData BuildKdvpData(const FinalReport& aReport, const FormData& aForm) {
+    DohKdvpData data{aForm, {}};
+    for (const auto& instrument : aReport.mInstruments) {
+        if (instrument.mTax.mSales.empty()) {
+            continue;
+        }
+        // The form is in EUR; a missing rate is already reported as a processing warning.
+        const auto& matches = instrument.mMatches.mMatches;
+        if (std::any_of(matches.begin(), matches.end(), [](const LotMatch& aMatch) {
+                return aMatch.mBuyCurrency != Currency::EUR ||
+                       aMatch.mSellCurrency != Currency::EUR;
+            })) {
+            LOG_WARN("Leaving unconverted sales of {} out of Doh-KDVP", instrument.mMatches.mIsin);
+            continue;
+        }
+
+        Securities securities;
+        securities.mIsin = instrument.mMatches.mIsin;
+        securities.mName = instrument.mMatches.mName;
+        securities.mRows = BuildRows(instrument);
+
+        KdvpItem item;
+        item.mItemId = static_cast<int>(data.mItems.size() + 1);
+        item.mSecurities = std::move(securities);
+        data.mItems.push_back(std::move(item));
+    }
+    return data;
+}
+
+void WriteKdvp(XmlWriter& aWriter, const DohKdvpData& aData, const TaxPayer& aTaxPayer) {
+    WriteHead(aWriter, aData, aTaxPayer);
+    for (const auto& item : aData.mItems) {
+        WriteItem(aWriter, item);
+    }
+    WriteTail(aWriter);
+}
+
+void WriteKdvp(XmlWriter& aWriter, const DohKdvpData& aData, const TaxPayer& aTaxPayer,
+               ThreadPool& aPool, FragmentCache* aCache) {
+    // The head goes first so item errors are merged below Doh_KDVP.
+    WriteHead(aWriter, aData, aTaxPayer);
+
+    // Fixed-size batches bound the fragments held at once, however many items there are.
+    const std::span<const KdvpItem> items = aData.mItems;
+    for (std::size_t begin = 0; begin < items.size(); begin += KDVP_BATCH_ITEMS) {
+        const auto batch = items.subspan(begin, std::min(KDVP_BATCH_ITEMS, items.size() - begin));
+        WriteFragments(aWriter, batch,
+                       RenderItems(batch, aData, aPool, aCache, aWriter.validator()));
+    }
+    WriteTail(aWriter);
+}
+
+ContentHash MakeKdvpItemKey(const KdvpItem& aItem, const FormData& aForm, bool aValidated) {
+    ContentHasher hasher;
+    hasher.add(std::uint64_t{KDVP_RENDER_VERSION});
+    hasher.add(std::uint64_t{aValidated});
+    hasher.add(static_cast<std::uint64_t>(aForm.mDocId));
+    hasher.add(static_cast<std::int64_t>(aForm.mYear));
+    hasher.add(std::uint64_t{aForm.mIsResident});
+
+    hasher.add(static_cast<std::uint64_t>(aItem.mType));
+    AddOptional(hasher, aItem.mHasForeignTax);
+    AddOptional(hasher, aItem.mForeignTaxAmount);
+    AddOptional(hasher, aItem.mForeignCountryId);
+
+    hasher.add(std::uint64_t{aItem.mSecurities.has_value()});
+    if (!aItem.mSecurities) {
+        return hasher.finish();
+    }
+    const auto& securities = *aItem.mSecurities;
+    AddOptional(hasher, securities.mIsin);
+    AddOptional(hasher, securities.mCode);
+    hasher.add(securities.mName);
+    hasher.add(std::uint64_t{securities.mIsFond});
+    AddOptional(hasher, securities.mResolution);
+    AddOptional(hasher, securities.mResolutionDate);
+
+    hasher.add(static_cast<std::uint64_t>(securities.mRows.size()));
+    for (std::size_t index = 0; index < securities.mRows.size(); ++index) {
+        const auto& row = securities.mRows[index];
+        // Row IDs count within the item, so only a deviation from that numbering is content.
+        hasher.add(static_cast<std::int64_t>(row.mId) - static_cast<std::int64_t>(index));
+        // Fields are hashed whether present or not; mFields tells the two apart.
+        hasher.add(std::uint64_t{row.mFields});
+        AddValue(hasher, row.mDate);
+        AddValue(hasher, row.mF2);
+        AddValue(hasher, row.mQuantity);
+        AddValue(hasher, row.mUnitValue);
+        AddValue(hasher, row.mF5);
+        AddValue(hasher, row.mF11);
+        AddValue(hasher, row.mF10);
+        AddValue(hasher, row.mF8);
+    }
+    return hasher.finish();
+}
+
+std::string RenderKdvpItem(const KdvpItem& aItem) {
+    std::string fragment;
+    XmlWriter writer{fragment};
+    WriteItem(writer, aItem);
+    (void)writer.finish();
+    return fragment;
+}
+
+std::vector<std::shared_ptr<const std::string>>
+RenderKdvpItems(const DohKdvpData& aData, ThreadPool& aPool, FragmentCache* aCache,
+                XmlValidator* aValidator) {
+    return RenderItems(aData.mItems, aData, aPool, aCache, aValidator);
+}
+
+std::string GenerateKdvp(const DohKdvpData& aData, const TaxPayer& aTaxPayer) {
+    std::string document;
+    XmlWriter writer{document};
+    WriteKdvp(writer, aData, aTaxPayer);
+    (void)writer.finish();
+    return document;
+}
+
+std::string GenerateKdvp(const DohKdvpData& aData, const TaxPayer& aTaxPayer,
+                         ThreadPool& aPool, FragmentCache* aCache) {
+    std::string document;
+    XmlWriter writer{document};
+    WriteKdvp(writer, aData, aTaxPayer, aPool, aCache);
+    (void)writer.finish();
+    return document;
+}
+
+} // namespace taxbroker
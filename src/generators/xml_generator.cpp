@@ -0,0 +1,449 @@
+#include "generators/xml_generator.hpp"
+
+#include "generators/xml_validator.hpp"
+#include "utils/date_utils.hpp"
+#include "utils/decimal_format.hpp"
+#include "utils/fd_write.hpp"
+#include "utils/logger.hpp"
+#include "utils/zip_writer.hpp"
+
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+using taxbroker::JoinSkeletonText;
+using taxbroker::NS_DOH_DHO;
+using taxbroker::NS_DOH_DIV;
+using taxbroker::NS_DOH_KDVP;
+using taxbroker::NS_EDP;
+using taxbroker::XmlSkeleton;
+using taxbroker::XmlWriter;
+
+constexpr std::string_view kTextSpecials = "&<>";
+constexpr std::string_view kAttributeSpecials = "&<>\"";
+
+std::string_view EscapeOf(char aCharacter) {
+    switch (aCharacter) {
+    case '&':
+        return "&amp;";
+    case '<':
+        return "&lt;";
+    case '>':
+        return "&gt;";
+    case '"':
+        return "&quot;";
+    default:
+        return {};
+    }
+}
+
+void OptionalElement(XmlWriter& aWriter, std::string_view aName,
+                     const std::optional<std::string>& aText) {
+    if (aText) {
+        aWriter.element(aName, *aText);
+    }
+}
+
+/*
+    Envelope skeletons. The head runs from the declaration to the required taxpayer
+    fields and differs only in the form namespace; the optional taxpayer fields are
+    written one by one, and the tail closes the header and opens <body>.
+*/
+constexpr std::string_view kEnvelopeOpen =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Envelope xmlns=\"";
+constexpr std::string_view kEdpDeclaration = "\" xmlns:edp=\"";
+constexpr std::string_view kHeaderOpen = "\"><edp:Header><edp:taxpayer><edp:taxNumber>\x01"
+                                         "</edp:taxNumber><edp:taxpayerType>\x01"
+                                         "</edp:taxpayerType>";
+constexpr std::string_view kHeaderClose = "<edp:resident>\x01"
+                                          "</edp:resident></edp:taxpayer><edp:Workflow>"
+                                          "<edp:DocumentWorkflowID>\x01"
+                                          "</edp:DocumentWorkflowID><edp:DocumentWorkflowName>\x01"
+                                          "</edp:DocumentWorkflowName></edp:Workflow></edp:Header>"
+                                          "<edp:Signatures/><body>";
+constexpr std::string_view kEnvelopeClose = "</body></Envelope>";
+
+constexpr XmlSkeleton kKdvpHead{
+    JoinSkeletonText<kEnvelopeOpen, NS_DOH_KDVP, kEdpDeclaration, NS_EDP, kHeaderOpen>()};
+constexpr XmlSkeleton kDivHead{
+    JoinSkeletonText<kEnvelopeOpen, NS_DOH_DIV, kEdpDeclaration, NS_EDP, kHeaderOpen>()};
+constexpr XmlSkeleton kDhoHead{
+    JoinSkeletonText<kEnvelopeOpen, NS_DOH_DHO, kEdpDeclaration, NS_EDP, kHeaderOpen>()};
+constexpr XmlSkeleton kHeadTail{JoinSkeletonText<kHeaderClose>()};
+constexpr XmlSkeleton kEnvelopeEnd{JoinSkeletonText<kEnvelopeClose>()};
+
+static_assert(kKdvpHead.slotCount() == 2 && kHeadTail.slotCount() == 3);
+
+} // namespace
+
+namespace taxbroker {
+
+XmlWriter::XmlWriter(std::string& aOutput)
+    : mBuffer(&aOutput), mInitialSize(aOutput.size()) {}
+
+XmlWriter::XmlWriter(int aFd, std::size_t aFlushThreshold)
+    : mBuffer(&mOwnBuffer), mFd(aFd), mFlushThreshold(aFlushThreshold) {
+    mOwnBuffer.reserve(aFlushThreshold);
+}
+
+XmlWriter::XmlWriter(ZipWriter& aArchive, std::size_t aFlushThreshold)
+    : mBuffer(&mOwnBuffer), mArchive(&aArchive), mFlushThreshold(aFlushThreshold) {
+    mOwnBuffer.reserve(aFlushThreshold);
+}
+
+XmlWriter::~XmlWriter() {
+    if (streams()) {
+        flush();
+    }
+}
+
+void XmlWriter::declaration() {
+    assert(mBuffer->size() == mInitialSize && mFlushedBytes == 0 &&
+           "XML declaration must come first");
+    mBuffer->append(R"(<?xml version="1.0" encoding="UTF-8"?>)");
+    mBuffer->push_back('\n');
+    mIsDocument = true;
+}
+
+void XmlWriter::startElement(std::string_view aName) {
+    assert(!mRootClosed && "XML document already has a root element");
+    closeStartTag();
+
+    mNameOffsets.push_back(mNames.size());
+    mNames.append(aName);
+
+    mBuffer->push_back('<');
+    mBuffer->append(aName);
+    mStartTagOpen = true;
+
+    if (mValidator != nullptr) {
+        mValidator->startElement(aName);
+    }
+}
+
+void XmlWriter::attribute(std::string_view aName, std::string_view aValue) {
+    assert(mStartTagOpen && "XML attribute outside of a start tag");
+    if (!mStartTagOpen) {
+        return;
+    }
+
+    assert(isPrefixDeclared(aName) && "XML attribute uses an undeclared namespace prefix");
+    mBuffer->push_back(' ');
+    mBuffer->append(aName);
+    mBuffer->append("=\"");
+    appendEscaped(aValue, kAttributeSpecials);
+    mBuffer->push_back('"');
+}
+
+void XmlWriter::namespaceDeclaration(std::string_view aPrefix, std::string_view aUri) {
+    assert(mStartTagOpen && "XML namespace declaration outside of a start tag");
+    if (!mStartTagOpen) {
+        return;
+    }
+
+    if (aPrefix.empty()) {
+        mBuffer->append(" xmlns");
+    } else {
+        mBuffer->append(" xmlns:");
+        mBuffer->append(aPrefix);
+    }
+    mBuffer->append("=\"");
+    appendEscaped(aUri, kAttributeSpecials);
+    mBuffer->push_back('"');
+
+    mNamespaces.push_back(NamespaceScope{std::string{aPrefix}, depth()});
+}
+
+void XmlWriter::text(std::string_view aText) {
+    assert(depth() > 0 && "XML text outside of the root element");
+    closeStartTag();
+    appendEscaped(aText, kTextSpecials);
+    if (mValidator != nullptr) {
+        mValidator->text(aText);
+    }
+    flushIfFull();
+}
+
+void XmlWriter::endElement() {
+    assert(depth() > 0 && "Unbalanced XML end tag");
+    if (depth() == 0) {
+        return;
+    }
+
+    if (mValidator != nullptr) {
+        mValidator->endElement();
+    }
+
+    const std::string_view name = std::string_view{mNames}.substr(mNameOffsets.back());
+    if (mStartTagOpen) {
+        assert(isPrefixDeclared(name) && "XML element uses an undeclared namespace prefix");
+        mBuffer->append("/>");
+        mStartTagOpen = false;
+    } else {
+        mBuffer->append("</");
+        mBuffer->append(name);
+        mBuffer->push_back('>');
+    }
+
+    popElement();
+    flushIfFull();
+}
+
+void XmlWriter::element(std::string_view aName, std::string_view aText) {
+    startElement(aName);
+    text(aText);
+    endElement();
+}
+
+void XmlWriter::integerElement(std::string_view aName, std::int64_t aValue) {
+    std::array<char, 24> digits{};
+    const auto result = std::to_chars(digits.data(), digits.data() + digits.size(), aValue);
+    element(aName, std::string_view{digits.data(), result.ptr});
+}
+
+void XmlWriter::booleanElement(std::string_view aName, bool aValue) {
+    element(aName, aValue ? "true" : "false");
+}
+
+void XmlWriter::dateElement(std::string_view aName, Date aDate) {
+    const auto text = FormatIsoDate(aDate);
+    element(aName, std::string_view{text.data(), text.size()});
+}
+
+void XmlWriter::decimalElement(std::string_view aName, std::int64_t aValue, int aScaleDigits,
+                               int aPrecision) {
+    std::array<char, DECIMAL_BUFFER_SIZE> digits;
+    element(aName, FormatDecimal(aValue, aScaleDigits, aPrecision, digits.data()));
+}
+
+void XmlWriter::fragments(std::span<const std::string_view> aFragments,
+                          std::string_view aElement, std::size_t aElementCount) {
+    assert(depth() > 0 && "XML fragments outside of the root element");
+    closeStartTag();
+    if (mValidator != nullptr) {
+        mValidator->fragments(aElement, aElementCount);
+    }
+
+    std::size_t fragmentBytes = 0;
+    for (const auto& fragment : aFragments) {
+        fragmentBytes += fragment.size();
+    }
+
+    if (!streams()) {
+        mBuffer->reserve(mBuffer->size() + fragmentBytes);
+        for (const auto& fragment : aFragments) {
+            mBuffer->append(fragment);
+        }
+        return;
+    }
+
+    if (mArchive != nullptr) {
+        std::vector<std::string_view> chunks;
+        chunks.reserve(aFragments.size() + 1);
+        chunks.emplace_back(*mBuffer);
+        chunks.insert(chunks.end(), aFragments.begin(), aFragments.end());
+        mArchive->write(chunks);
+        mFlushedBytes += mBuffer->size() + fragmentBytes;
+        mBuffer->clear();
+        return;
+    }
+
+    // Pending output goes first, in the same writev as the fragments.
+    std::vector<iovec> chunks;
+    chunks.reserve(aFragments.size() + 1);
+    chunks.push_back(iovec{mBuffer->data(), mBuffer->size()});
+    for (const auto& fragment : aFragments) {
+        chunks.push_back(iovec{const_cast<char*>(fragment.data()), fragment.size()});
+    }
+    if (!mFailed && !WriteAll(mFd, chunks)) {
+        LOG_ERROR("Writing XML to descriptor {} failed: {}", mFd, std::strerror(errno));
+        mFailed = true;
+    }
+    mFlushedBytes += mBuffer->size() + fragmentBytes;
+    mBuffer->clear();
+}
+
+void XmlWriter::writeSkeleton(std::string_view aText, std::span<const XmlSkeletonEvent> aEvents,
+                              std::span<const std::string_view> aSlots) {
+    closeStartTag();
+    for (const auto& event : aEvents) {
+        const std::string_view part = aText.substr(event.mOffset, event.mLength);
+        switch (event.mType) {
+        case XmlSkeletonEvent::Type::Declaration:
+            assert(mBuffer->size() == mInitialSize && mFlushedBytes == 0 &&
+                   "XML declaration must come first");
+            mIsDocument = true;
+            break;
+        case XmlSkeletonEvent::Type::Markup:
+            mBuffer->append(part);
+            break;
+        case XmlSkeletonEvent::Type::Slot:
+            assert(event.mOffset < aSlots.size() && "XML skeleton slot without a value");
+            appendEscaped(aSlots[event.mOffset], kTextSpecials);
+            if (mValidator != nullptr) {
+                mValidator->text(aSlots[event.mOffset]);
+            }
+            break;
+        case XmlSkeletonEvent::Type::Namespace:
+            mNamespaces.push_back(NamespaceScope{std::string{part}, depth() + 1});
+            break;
+        case XmlSkeletonEvent::Type::Start:
+            assert(!mRootClosed && "XML document already has a root element");
+            assert(isPrefixDeclared(part) && "XML element uses an undeclared namespace prefix");
+            mNameOffsets.push_back(mNames.size());
+            mNames.append(part);
+            if (mValidator != nullptr) {
+                mValidator->startElement(part);
+            }
+            break;
+        case XmlSkeletonEvent::Type::End:
+            assert(depth() > 0 && "Unbalanced XML end tag");
+            if (mValidator != nullptr) {
+                mValidator->endElement();
+            }
+            popElement();
+            break;
+        }
+    }
+    flushIfFull();
+}
+
+bool XmlWriter::finish() {
+    assert(depth() == 0 && !mStartTagOpen && "XML document has unclosed elements");
+    if (mValidator != nullptr) {
+        mValidator->finish();
+    }
+    if (streams()) {
+        flush();
+    }
+    return !mFailed && (mArchive == nullptr || !mArchive->failed());
+}
+
+void XmlWriter::nextDocument() {
+    assert(depth() == 0 && !mStartTagOpen && "XML document has unclosed elements");
+    if (streams()) {
+        flush();
+    }
+    mInitialSize = mBuffer->size();
+    mFlushedBytes = 0;
+    mNamespaces.clear();
+    mIsDocument = false;
+    mRootClosed = false;
+}
+
+void XmlWriter::closeStartTag() {
+    if (mStartTagOpen) {
+        // Declarations on the element itself count, so prefixes are checked only here.
+        assert(isPrefixDeclared(std::string_view{mNames}.substr(mNameOffsets.back())) &&
+               "XML element uses an undeclared namespace prefix");
+        mBuffer->push_back('>');
+        mStartTagOpen = false;
+    }
+}
+
+void XmlWriter::popElement() {
+    while (!mNamespaces.empty() && mNamespaces.back().mDepth == depth()) {
+        mNamespaces.pop_back();
+    }
+    mNames.resize(mNameOffsets.back());
+    mNameOffsets.pop_back();
+
+    if (depth() == 0) {
+        mRootClosed = true;
+        if (mIsDocument) {
+            mBuffer->push_back('\n');
+        }
+    }
+}
+
+void XmlWriter::appendEscaped(std::string_view aText, std::string_view aSpecials) {
+    std::size_t position = 0;
+    while (position < aText.size()) {
+        const std::size_t special = aText.find_first_of(aSpecials, position);
+        if (special == std::string_view::npos) {
+            mBuffer->append(aText.substr(position));
+            return;
+        }
+        mBuffer->append(aText.substr(position, special - position));
+        mBuffer->append(EscapeOf(aText[special]));
+        position = special + 1;
+    }
+}
+
+void XmlWriter::flushIfFull() {
+    if (streams() && mBuffer->size() >= mFlushThreshold) {
+        flush();
+    }
+}
+
+void XmlWriter::flush() {
+    if (mArchive != nullptr) {
+        mArchive->write(*mBuffer);
+    } else if (!mFailed && !mBuffer->empty()) {
+        iovec chunk{mBuffer->data(), mBuffer->size()};
+        if (!WriteAll(mFd, std::span<iovec>{&chunk, 1})) {
+            LOG_ERROR("Writing XML to descriptor {} failed: {}", mFd, std::strerror(errno));
+            mFailed = true;
+        }
+    }
+    mFlushedBytes += mBuffer->size();
+    mBuffer->clear();
+}
+
+bool XmlWriter::isPrefixDeclared(std::string_view aName) const {
+    const std::size_t colon = aName.find(':');
+    if (colon == std::string_view::npos) {
+        return true;
+    }
+
+    const std::string_view prefix = aName.substr(0, colon);
+    if (prefix == "xml" || prefix == "xmlns") {
+        return true;
+    }
+    for (const auto& scope : mNamespaces) {
+        if (scope.mPrefix == prefix) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WriteEnvelopeStart(XmlWriter& aWriter, XmlSchema aForm, FormType aWorkflow,
+                        const TaxPayer& aTaxPayer) {
+    const std::array<std::string_view, 2> head{aTaxPayer.mTaxNumber, aTaxPayer.mType};
+    switch (aForm) {
+    case XmlSchema::DohKdvp:
+        aWriter.skeleton(kKdvpHead, head);
+        break;
+    case XmlSchema::DohDiv:
+        aWriter.skeleton(kDivHead, head);
+        break;
+    case XmlSchema::DohDho:
+        aWriter.skeleton(kDhoHead, head);
+        break;
+    }
+
+    OptionalElement(aWriter, "edp:name", aTaxPayer.mName);
+    OptionalElement(aWriter, "edp:address1", aTaxPayer.mAddress1);
+    OptionalElement(aWriter, "edp:address2", aTaxPayer.mAddress2);
+    OptionalElement(aWriter, "edp:city", aTaxPayer.mCity);
+    OptionalElement(aWriter, "edp:postNumber", aTaxPayer.mPostNumber);
+    OptionalElement(aWriter, "edp:postName", aTaxPayer.mPostName);
+    if (aTaxPayer.mBirthDate) {
+        aWriter.dateElement("edp:birthDate", *aTaxPayer.mBirthDate);
+    }
+
+    const std::array<std::string_view, 3> tail{aTaxPayer.mResident ? "true" : "false",
+                                               WorkflowId(aWorkflow), ToString(aWorkflow)};
+    aWriter.skeleton(kHeadTail, tail);
+}
+
+void WriteEnvelopeEnd(XmlWriter& aWriter) {
+    aWriter.skeleton(kEnvelopeEnd, {});
+}
+
+} // namespace taxbroker
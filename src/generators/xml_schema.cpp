@@ -0,0 +1,362 @@
+#include "generators/xml_schema.hpp"
+
+#include <array>
+
+/*
+    Element tables of Doh_KDVP_9, Doh_Div_3, Doh_DHO_4 and EDP-Common-1.
+
+    Sequences keep every optional sibling of the elements the generators write, so
+    order is checked against the real schema. Branches the generators never emit
+    (attachments, tax reliefs, shares, corporate data, subsequent submissions) are
+    left out and rejected as unexpected elements.
+*/
+namespace {
+
+using taxbroker::XML_UNBOUNDED;
+using taxbroker::XmlContent;
+using taxbroker::XmlParticle;
+using taxbroker::XmlSchema;
+using taxbroker::XmlType;
+
+constexpr XmlType kString{.mContent = XmlContent::String};
+constexpr XmlType kBoolean{.mContent = XmlContent::Boolean};
+constexpr XmlType kDate{.mContent = XmlContent::Date};
+constexpr XmlType kCounter{.mContent = XmlContent::Integer, .mSigned = false};
+constexpr XmlType kYear{.mContent = XmlContent::Year};
+constexpr XmlType kEmpty{.mContent = XmlContent::Elements};
+
+constexpr XmlType MaxLength(std::uint16_t aLength) {
+    return XmlType{.mContent = XmlContent::String, .mMaxLength = aLength};
+}
+
+constexpr XmlType Digits(std::uint16_t aCount) {
+    return XmlType{.mContent = XmlContent::Digits, .mMaxLength = aCount};
+}
+
+// \d{1,aInteger}(\.\d{1,aFraction})? and its signed variant.
+constexpr XmlType Decimal(std::uint8_t aInteger, std::uint8_t aFraction, bool aSigned) {
+    return XmlType{.mContent = XmlContent::Decimal,
+                   .mIntegerDigits = aInteger,
+                   .mFractionDigits = aFraction,
+                   .mSigned = aSigned};
+}
+
+// EDP-Common-1
+
+constexpr std::array kTaxpayerTypes = {std::string_view{"FO"}, std::string_view{"PO"},
+                                       std::string_view{"SP"}};
+
+constexpr XmlType kDocumentId = MaxLength(1);
+constexpr XmlType kTaxNumber = Digits(8);
+constexpr XmlType kPostNumber = MaxLength(12);
+constexpr XmlType kTaxpayerType{.mContent = XmlContent::Enumeration, .mValues = kTaxpayerTypes};
+
+constexpr std::array kTaxPayerChildren = {
+    XmlParticle{"edp:taxNumber", &kTaxNumber, 0},
+    XmlParticle{"edp:vatNumber", &kString, 0, 1, true},
+    XmlParticle{"edp:taxpayerType", &kTaxpayerType, 0},
+    XmlParticle{"edp:name", &kString, 0},
+    XmlParticle{"edp:address1", &kString, 0},
+    XmlParticle{"edp:address2", &kString, 0},
+    XmlParticle{"edp:city", &kString, 0},
+    XmlParticle{"edp:postNumber", &kPostNumber, 0},
+    XmlParticle{"edp:postName", &kString, 0},
+    XmlParticle{"edp:municipalityName", &kString, 0},
+    XmlParticle{"edp:birthDate", &kDate, 0},
+    XmlParticle{"edp:maticnaStevilka", &kString, 0},
+    XmlParticle{"edp:invalidskoPodjetje", &kBoolean, 0},
+    XmlParticle{"edp:resident", &kBoolean, 0},
+    XmlParticle{"edp:activityCode", &kString, 0},
+    XmlParticle{"edp:activityName", &kString, 0},
+    XmlParticle{"edp:countryID", &kString, 0},
+    XmlParticle{"edp:countryName", &kString, 0},
+};
+constexpr XmlType kTaxPayer{.mChildren = kTaxPayerChildren};
+
+constexpr std::array kWorkflowChildren = {
+    XmlParticle{"edp:DocumentWorkflowID", &kDocumentId, 0},
+    XmlParticle{"edp:DocumentWorkflowName", &kString, 0},
+};
+constexpr XmlType kWorkflow{.mChildren = kWorkflowChildren};
+
+constexpr std::array kHeaderChildren = {
+    XmlParticle{"edp:taxpayer", &kTaxPayer},
+    XmlParticle{"edp:responseTo", &kString, 0},
+    XmlParticle{"edp:Workflow", &kWorkflow, 0},
+    XmlParticle{"edp:domain", &kString, 0},
+};
+constexpr XmlType kHeader{.mChildren = kHeaderChildren};
+
+// Doh_KDVP_9
+
+constexpr std::array kInventoryTypes = {
+    std::string_view{"PLVP"}, std::string_view{"PLVPSHORT"}, std::string_view{"PLVPGB"},
+    std::string_view{"PLVPGBSHORT"}, std::string_view{"PLD"}, std::string_view{"PLVPZOK"}};
+constexpr std::array kGainTypes = {std::string_view{"A"}, std::string_view{"B"},
+                                   std::string_view{"C"}, std::string_view{"D"},
+                                   std::string_view{"E"}, std::string_view{"F"},
+                                   std::string_view{"G"}, std::string_view{"H"},
+                                   std::string_view{"I"}};
+
+constexpr XmlType kInventoryType{.mContent = XmlContent::Enumeration, .mValues = kInventoryTypes};
+constexpr XmlType kGainType{.mContent = XmlContent::Enumeration, .mValues = kGainTypes};
+constexpr XmlType kDecimalPos12_8 = Decimal(12, 8, false);
+constexpr XmlType kDecimalPos14_8 = Decimal(14, 8, false);
+constexpr XmlType kDecimalPos14_4 = Decimal(10, 4, false);
+constexpr XmlType kDecimalNeg12_8 = Decimal(12, 8, true);
+constexpr XmlType kCountryCode = Digits(3);
+constexpr XmlType kCountryName = MaxLength(40);
+constexpr XmlType kNaziv = MaxLength(100);
+constexpr XmlType kIsin = MaxLength(12);
+constexpr XmlType kItemCode = MaxLength(10);
+constexpr XmlType kResolution = MaxLength(100);
+constexpr XmlType kRemission = MaxLength(4);
+constexpr XmlType kInstitutionName = MaxLength(100);
+
+constexpr std::array kPurchaseChildren = {
+    XmlParticle{"F1", &kDate, 0},
+    XmlParticle{"F2", &kGainType, 0},
+    XmlParticle{"F3", &kDecimalPos12_8, 0},
+    XmlParticle{"F4", &kDecimalPos14_8, 0},
+    XmlParticle{"F5", &kDecimalPos14_4, 0},
+    XmlParticle{"F11", &kDecimalPos14_8, 0},
+};
+constexpr XmlType kPurchase{.mChildren = kPurchaseChildren};
+
+constexpr std::array kSaleChildren = {
+    XmlParticle{"F6", &kDate, 0},
+    XmlParticle{"F7", &kDecimalPos12_8, 0},
+    XmlParticle{"F9", &kDecimalPos14_8, 0},
+    XmlParticle{"F10", &kBoolean, 0},
+};
+constexpr XmlType kSale{.mChildren = kSaleChildren};
+
+constexpr std::array kRowChildren = {
+    XmlParticle{"ID", &kCounter},
+    XmlParticle{"Purchase", &kPurchase},
+    XmlParticle{"Sale", &kSale, 1, 1, true},
+    XmlParticle{"F8", &kDecimalNeg12_8, 0},
+};
+constexpr XmlType kRow{.mChildren = kRowChildren};
+
+constexpr std::array kSecuritiesChildren = {
+    XmlParticle{"ISIN", &kIsin, 0},
+    XmlParticle{"Code", &kItemCode, 0},
+    XmlParticle{"Name", &kNaziv, 0},
+    XmlParticle{"IsFond", &kBoolean},
+    XmlParticle{"Resolution", &kResolution, 0},
+    XmlParticle{"ResolutionDate", &kDate, 0},
+    XmlParticle{"Row", &kRow, 0, XML_UNBOUNDED},
+};
+constexpr XmlType kSecurities{.mChildren = kSecuritiesChildren};
+
+constexpr std::array kKdvpItemChildren = {
+    XmlParticle{"ItemID", &kCounter, 0},
+    XmlParticle{"InventoryListType", &kInventoryType},
+    XmlParticle{"Name", &kNaziv, 0},
+    XmlParticle{"HasForeignTax", &kBoolean, 0},
+    XmlParticle{"ForeignTax", &kDecimalPos14_4, 0},
+    XmlParticle{"FTCountryID", &kCountryCode, 0},
+    XmlParticle{"FTCountryName", &kCountryName, 0},
+    XmlParticle{"HasLossTransfer", &kBoolean, 0},
+    XmlParticle{"ForeignTransfer", &kBoolean, 0},
+    XmlParticle{"TaxDecreaseConformance", &kBoolean, 0},
+    XmlParticle{"Securities", &kSecurities, 0},
+};
+constexpr XmlType kKdvpItem{.mChildren = kKdvpItemChildren};
+
+constexpr std::array kKdvpChildren = {
+    XmlParticle{"DocumentWorkflowID", &kDocumentId, 0},
+    XmlParticle{"DocumentWorkflowName", &kString, 0},
+    XmlParticle{"Year", &kYear, 0},
+    XmlParticle{"PeriodStart", &kDate, 0},
+    XmlParticle{"PeriodEnd", &kDate, 0},
+    XmlParticle{"IsResident", &kBoolean, 0},
+    XmlParticle{"CountryOfResidenceID", &kCountryCode, 0},
+    XmlParticle{"CountryOfResidenceName", &kCountryName, 0},
+    XmlParticle{"TelephoneNumber", &kString, 0},
+    XmlParticle{"SecurityCount", &kCounter},
+    XmlParticle{"SecurityShortCount", &kCounter},
+    XmlParticle{"SecurityWithContractCount", &kCounter},
+    XmlParticle{"SecurityWithContractShortCount", &kCounter},
+    XmlParticle{"ShareCount", &kCounter},
+    XmlParticle{"SecurityCapitalReductionCount", &kCounter, 0},
+    XmlParticle{"RemissionState", &kRemission, 0},
+    XmlParticle{"RemissionArticle", &kRemission, 0},
+    XmlParticle{"ResConfirmationInstitution", &kInstitutionName, 0},
+    XmlParticle{"ResConfirmationDate", &kDate, 0},
+    XmlParticle{"Email", &kString, 0},
+};
+constexpr XmlType kKdvp{.mChildren = kKdvpChildren};
+
+constexpr std::array kDohKdvpChildren = {
+    XmlParticle{"KDVP", &kKdvp},
+    XmlParticle{"KDVPItem", &kKdvpItem, 0, XML_UNBOUNDED},
+};
+constexpr XmlType kDohKdvp{.mChildren = kDohKdvpChildren};
+
+constexpr std::array kKdvpBodyChildren = {
+    XmlParticle{"edp:bodyContent", &kEmpty},
+    XmlParticle{"Doh_KDVP", &kDohKdvp},
+};
+constexpr XmlType kKdvpBody{.mChildren = kKdvpBodyChildren};
+
+// Doh_Div_3
+
+// Amount_Type: xs:decimal with two fraction digits.
+constexpr XmlType kDivAmount = Decimal(0, 2, true);
+
+constexpr std::array kDohDivChildren = {
+    XmlParticle{"Period", &kString, 0},
+    XmlParticle{"EmailAddress", &kString, 0},
+    XmlParticle{"PhoneNumber", &kString, 0},
+    XmlParticle{"ResidentCountry", &kString, 0},
+    XmlParticle{"IsResident", &kBoolean, 0},
+    XmlParticle{"Locked", &kBoolean, 0},
+    XmlParticle{"SelfReport", &kBoolean, 0},
+    XmlParticle{"WfTypeU", &kBoolean, 0},
+    XmlParticle{"Notes", &kString, 0},
+};
+constexpr XmlType kDohDiv{.mChildren = kDohDivChildren};
+
+constexpr std::array kDividendChildren = {
+    XmlParticle{"Date", &kDate, 0},
+    XmlParticle{"PayerTaxNumber", &kString, 0},
+    XmlParticle{"PayerIdentificationNumber", &kString, 0},
+    XmlParticle{"PayerName", &kString, 0},
+    XmlParticle{"PayerAddress", &kString, 0},
+    XmlParticle{"PayerCountry", &kString, 0},
+    XmlParticle{"Type", &kString, 0},
+    XmlParticle{"Value", &kDivAmount, 0},
+    XmlParticle{"ForeignTax", &kDivAmount, 0},
+    XmlParticle{"SourceCountry", &kString, 0},
+    XmlParticle{"ReliefStatement", &kString, 0},
+};
+constexpr XmlType kDividend{.mChildren = kDividendChildren};
+
+constexpr std::array kDivBodyChildren = {
+    XmlParticle{"Doh_Div", &kDohDiv},
+    XmlParticle{"Dividend", &kDividend, 0, XML_UNBOUNDED},
+};
+constexpr XmlType kDivBody{.mChildren = kDivBodyChildren};
+
+// Doh_DHO_4
+
+// typeDecNonNeg: two fraction digits, twelve in total, not negative.
+constexpr XmlType kDecNonNeg{.mContent = XmlContent::Decimal,
+                             .mFractionDigits = 2,
+                             .mTotalDigits = 12,
+                             .mSigned = false};
+constexpr XmlType kTitle = MaxLength(50);
+constexpr XmlType kAddress = MaxLength(100);
+constexpr XmlType kDhoCountryName = MaxLength(100);
+constexpr XmlType kTaxId = MaxLength(20);
+constexpr XmlType kNote = MaxLength(500);
+
+constexpr std::array kDhoTaxPayerDataChildren = {
+    XmlParticle{"Email", &kString, 0},
+    XmlParticle{"PhoneNumber", &kString, 0},
+    XmlParticle{"SelfReport", &kBoolean, 0},
+    XmlParticle{"WfTypeU", &kBoolean, 0},
+    XmlParticle{"Notes", &kString, 0},
+    XmlParticle{"ResidentCountry", &kString, 0},
+    XmlParticle{"IsResident", &kBoolean, 0},
+};
+constexpr XmlType kDhoTaxPayerData{.mChildren = kDhoTaxPayerDataChildren};
+
+constexpr std::array kInterestChildren = {
+    XmlParticle{"TaxID", &kTaxId, 0},
+    XmlParticle{"IDeu", &kString, 0},
+    XmlParticle{"Title", &kTitle, 0},
+    XmlParticle{"Address", &kAddress, 0},
+    XmlParticle{"PayerCountryCode", &kString, 0},
+    XmlParticle{"PayerCountryName", &kDhoCountryName, 0},
+    XmlParticle{"InterestType", &kString, 0},
+    XmlParticle{"InterestEarned", &kDecNonNeg, 0},
+    XmlParticle{"ForeignTaxPaid", &kDecNonNeg, 0},
+    XmlParticle{"SourceCountryCode", &kString, 0},
+    XmlParticle{"SourceCountryName", &kDhoCountryName, 0},
+};
+constexpr XmlType kInterest{.mChildren = kInterestChildren};
+
+constexpr std::array kDhoTotalsChildren = {
+    XmlParticle{"TotalInterestEarned", &kDecNonNeg, 0},
+    XmlParticle{"TotalForeignTaxPaid", &kDecNonNeg, 0},
+    XmlParticle{"Notes", &kNote, 0},
+    XmlParticle{"Year", &kYear, 0},
+};
+constexpr XmlType kDhoTotals{.mChildren = kDhoTotalsChildren};
+
+constexpr std::array kDohDhoChildren = {
+    XmlParticle{"Doh_DHO_TaxPayerData", &kDhoTaxPayerData, 0},
+    XmlParticle{"Doh_DHO_InterestEarned", &kInterest, 0, 999},
+    XmlParticle{"Doh_DHO_Totals", &kDhoTotals},
+};
+constexpr XmlType kDohDho{.mChildren = kDohDhoChildren};
+
+constexpr std::array kDhoBodyChildren = {
+    XmlParticle{"edp:bodyContent", &kEmpty},
+    XmlParticle{"Doh_DHO", &kDohDho},
+};
+constexpr XmlType kDhoBody{.mChildren = kDhoBodyChildren};
+
+// Envelopes
+
+constexpr std::array kKdvpEnvelopeChildren = {
+    XmlParticle{"edp:Header", &kHeader},
+    XmlParticle{"edp:Signatures", &kEmpty},
+    XmlParticle{"body", &kKdvpBody},
+};
+constexpr std::array kDivEnvelopeChildren = {
+    XmlParticle{"edp:Header", &kHeader},
+    XmlParticle{"edp:Signatures", &kEmpty},
+    XmlParticle{"body", &kDivBody},
+};
+constexpr std::array kDhoEnvelopeChildren = {
+    XmlParticle{"edp:Header", &kHeader},
+    XmlParticle{"edp:Signatures", &kEmpty},
+    XmlParticle{"body", &kDhoBody},
+};
+
+constexpr XmlType kKdvpEnvelope{.mChildren = kKdvpEnvelopeChildren};
+constexpr XmlType kDivEnvelope{.mChildren = kDivEnvelopeChildren};
+constexpr XmlType kDhoEnvelope{.mChildren = kDhoEnvelopeChildren};
+
+constexpr XmlParticle kKdvpRoot{"Envelope", &kKdvpEnvelope};
+constexpr XmlParticle kDivRoot{"Envelope", &kDivEnvelope};
+constexpr XmlParticle kDhoRoot{"Envelope", &kDhoEnvelope};
+
+const XmlParticle* FindBelow(const XmlParticle& aParticle, std::string_view aName) {
+    for (const auto& child : aParticle.mType->mChildren) {
+        if (child.mName == aName) {
+            return &child;
+        }
+        if (const auto* found = FindBelow(child, aName)) {
+            return found;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+namespace taxbroker {
+
+const XmlParticle& SchemaRoot(XmlSchema aSchema) {
+    switch (aSchema) {
+    case XmlSchema::DohKdvp:
+        return kKdvpRoot;
+    case XmlSchema::DohDiv:
+        return kDivRoot;
+    case XmlSchema::DohDho:
+        return kDhoRoot;
+    }
+    return kKdvpRoot;
+}
+
+const XmlParticle* FindSchemaElement(XmlSchema aSchema, std::string_view aName) {
+    const auto& root = SchemaRoot(aSchema);
+    return root.mName == aName ? &root : FindBelow(root, aName);
+}
+
+} // namespace taxbroker
@@ -0,0 +1,376 @@
+#include "generators/xml_validator.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace {
+
+using taxbroker::XmlContent;
+using taxbroker::XmlType;
+
+bool AllDigits(std::string_view aText) {
+    for (const char character : aText) {
+        if (static_cast<unsigned char>(character - '0') > 9) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IsWhitespace(std::string_view aText) {
+    return aText.find_first_not_of(" \t\r\n") == std::string_view::npos;
+}
+
+// Unicode code points of UTF-8 aText; XSD lengths count characters, not bytes.
+std::size_t CharacterCount(std::string_view aText) {
+    return static_cast<std::size_t>(std::count_if(aText.begin(), aText.end(), [](char aByte) {
+        return (static_cast<unsigned char>(aByte) & 0xC0) != 0x80;
+    }));
+}
+
+int TwoDigits(std::string_view aText, std::size_t aOffset) {
+    return (aText[aOffset] - '0') * 10 + (aText[aOffset + 1] - '0');
+}
+
+bool IsDate(std::string_view aText) {
+    if (aText.size() != 10 || aText[4] != '-' || aText[7] != '-' ||
+        !AllDigits(aText.substr(0, 4)) || !AllDigits(aText.substr(5, 2)) ||
+        !AllDigits(aText.substr(8, 2))) {
+        return false;
+    }
+    const int month = TwoDigits(aText, 5);
+    const int day = TwoDigits(aText, 8);
+    return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+bool IsInteger(std::string_view aText, bool aSigned) {
+    if (aText.empty() || (aText.front() == '-' && !aSigned)) {
+        return false;
+    }
+    std::int32_t value = 0;
+    const auto* end = aText.data() + aText.size();
+    const auto result = std::from_chars(aText.data(), end, value);
+    return result.ec == std::errc{} && result.ptr == end;
+}
+
+// Reason aText does not fit the decimal facets of aType, empty if it does.
+std::string_view DecimalError(std::string_view aText, const XmlType& aType) {
+    std::string_view digits = aText;
+    const bool negative = !digits.empty() && digits.front() == '-';
+    if (negative) {
+        digits.remove_prefix(1);
+    }
+
+    const std::size_t point = digits.find('.');
+    std::string_view integer = digits.substr(0, point);
+    std::string_view fraction =
+        point == std::string_view::npos ? std::string_view{} : digits.substr(point + 1);
+    if (integer.empty() || !AllDigits(integer) || !AllDigits(fraction) ||
+        (point != std::string_view::npos && fraction.empty())) {
+        return "is not a decimal";
+    }
+    if (negative && !aType.mSigned) {
+        return "must not be negative";
+    }
+    if (aType.mIntegerDigits != 0 && integer.size() > aType.mIntegerDigits) {
+        return "has too many integer digits";
+    }
+    if (fraction.size() > aType.mFractionDigits) {
+        return "has too many fraction digits";
+    }
+
+    if (aType.mTotalDigits != 0) {
+        integer.remove_prefix(std::min(integer.find_first_not_of('0'), integer.size()));
+        const std::size_t lastSignificant = fraction.find_last_not_of('0');
+        fraction = fraction.substr(0, lastSignificant == std::string_view::npos
+                                          ? 0
+                                          : lastSignificant + 1);
+        if (integer.size() + fraction.size() > aType.mTotalDigits) {
+            return "has too many digits";
+        }
+    }
+    return {};
+}
+
+// Reason aText is not a valid value of the simple type aType, empty if it is.
+std::string_view ValueError(std::string_view aText, const XmlType& aType) {
+    switch (aType.mContent) {
+    case XmlContent::Elements:
+        return {};
+    case XmlContent::String:
+        if (aType.mMaxLength != 0 && CharacterCount(aText) > aType.mMaxLength) {
+            return "exceeds the maximum length";
+        }
+        return {};
+    case XmlContent::Boolean:
+        if (aText != "true" && aText != "false" && aText != "1" && aText != "0") {
+            return "is not a boolean";
+        }
+        return {};
+    case XmlContent::Date:
+        return IsDate(aText) ? std::string_view{} : "is not a date";
+    case XmlContent::Integer:
+        return IsInteger(aText, aType.mSigned) ? std::string_view{} : "is not a valid integer";
+    case XmlContent::Year:
+        if (aText.size() != 4 || aText.front() == '0' || !AllDigits(aText)) {
+            return "is not a year";
+        }
+        return {};
+    case XmlContent::Digits:
+        if (aText.size() != aType.mMaxLength || !AllDigits(aText)) {
+            return "has the wrong number of digits";
+        }
+        return {};
+    case XmlContent::Decimal:
+        return DecimalError(aText, aType);
+    case XmlContent::Enumeration:
+        if (std::find(aType.mValues.begin(), aType.mValues.end(), aText) == aType.mValues.end()) {
+            return "is not an allowed value";
+        }
+        return {};
+    }
+    return {};
+}
+
+} // namespace
+
+namespace taxbroker {
+
+XmlValidator::XmlValidator(XmlSchema aSchema) : XmlValidator(SchemaRoot(aSchema)) {}
+
+XmlValidator::XmlValidator(const XmlParticle& aRoot) : mRoot(aRoot) {
+    mFrames.reserve(16);
+}
+
+void XmlValidator::startElement(std::string_view aName) {
+    mText.clear();
+    if (mFrames.empty()) {
+        const bool expected = !mRootSeen && aName == mRoot.mName;
+        if (!expected) {
+            addError("unexpected root element", aName);
+        }
+        mRootSeen = true;
+        mFrames.push_back(expected ? Frame{mRoot.mName, mRoot.mType} : Frame{});
+        return;
+    }
+
+    Frame& parent = mFrames.back();
+    const XmlParticle* particle = nullptr;
+    if (parent.mType != nullptr) {
+        if (parent.mType->mContent != XmlContent::Elements) {
+            addError("element in simple content", aName);
+        } else {
+            particle = matchChild(parent, aName);
+        }
+    }
+    mFrames.push_back(particle != nullptr ? Frame{particle->mName, particle->mType} : Frame{});
+}
+
+void XmlValidator::text(std::string_view aText) {
+    if (mFrames.empty() || mFrames.back().mType == nullptr) {
+        return;
+    }
+    if (mFrames.back().mType->mContent != XmlContent::Elements) {
+        mText.append(aText);
+    } else if (!IsWhitespace(aText)) {
+        addError("text in element-only content", aText);
+    }
+}
+
+void XmlValidator::endElement() {
+    if (mFrames.empty()) {
+        return;
+    }
+
+    const Frame& frame = mFrames.back();
+    if (frame.mType != nullptr) {
+        if (frame.mType->mContent == XmlContent::Elements) {
+            checkComplete(frame);
+        } else {
+            checkValue(frame);
+        }
+    }
+    mFrames.pop_back();
+    mText.clear();
+    mRootClosed = mFrames.empty();
+}
+
+void XmlValidator::fragments(std::string_view aName, std::size_t aCount) {
+    if (aCount == 0 || mFrames.empty() || mFrames.back().mType == nullptr) {
+        return;
+    }
+    if (aName.empty()) {
+        addError("fragments without an element name cannot be validated");
+        return;
+    }
+
+    Frame& parent = mFrames.back();
+    if (parent.mType->mContent != XmlContent::Elements) {
+        addError("element in simple content", aName);
+        return;
+    }
+    const XmlParticle* particle = matchChild(parent, aName);
+    if (particle == nullptr) {
+        return;
+    }
+
+    const std::size_t limit = particle->mMaxOccurs;
+    if (parent.mCount + (aCount - 1) > limit) {
+        addError("too many occurrences of", aName);
+    }
+    parent.mCount = static_cast<std::uint32_t>(std::min(parent.mCount + (aCount - 1), limit));
+}
+
+void XmlValidator::merge(const XmlValidator& aFragment) {
+    if (aFragment.valid()) {
+        return;
+    }
+
+    std::string prefix;
+    for (const auto& frame : mFrames) {
+        prefix.append(frame.mName);
+        prefix.push_back('/');
+    }
+    for (const auto& error : aFragment.mErrors) {
+        if (mErrors.size() < MAX_XML_VALIDATION_ERRORS) {
+            mErrors.push_back(prefix + error);
+        }
+    }
+    mErrorCount += aFragment.mErrorCount;
+}
+
+void XmlValidator::finish() {
+    if (!mRootSeen) {
+        addError("missing root element", mRoot.mName);
+    } else if (!mRootClosed) {
+        addError("document ends inside an open element");
+    }
+}
+
+void XmlValidator::reset() {
+    mFrames.clear();
+    mText.clear();
+    mRootSeen = false;
+    mRootClosed = false;
+    mErrorCount = 0;
+    mErrors.clear();
+}
+
+const XmlParticle* XmlValidator::matchChild(Frame& aParent, std::string_view aName) {
+    const auto children = aParent.mType->mChildren;
+    const auto count = static_cast<std::uint32_t>(children.size());
+
+    // Still filling the current particle.
+    if (aParent.mMatched != kNoMatch && children[aParent.mMatched].mName == aName) {
+        const XmlParticle& particle = children[aParent.mMatched];
+        if (aParent.mCount >= particle.mMaxOccurs) {
+            addError("too many occurrences of", aName);
+        } else {
+            ++aParent.mCount;
+        }
+        return &particle;
+    }
+
+    // A later group; the current one is done once anything in it has matched.
+    std::uint32_t group = aParent.mMatched != kNoMatch ? groupEnd(aParent, aParent.mGroup)
+                                                       : aParent.mGroup;
+    std::uint32_t found = kNoMatch;
+    std::uint32_t foundGroup = group;
+    while (group < count && found == kNoMatch) {
+        const std::uint32_t end = groupEnd(aParent, group);
+        for (std::uint32_t index = group; index < end; ++index) {
+            if (children[index].mName == aName) {
+                found = index;
+                foundGroup = group;
+                break;
+            }
+        }
+        group = end;
+    }
+
+    if (found == kNoMatch) {
+        const bool earlier = std::any_of(children.begin(), children.end(),
+                                         [aName](const XmlParticle& aParticle) {
+                                             return aParticle.mName == aName;
+                                         });
+        addError(earlier ? "element out of order" : "unexpected element", aName);
+        return nullptr;
+    }
+
+    for (group = aParent.mGroup; group < foundGroup; group = groupEnd(aParent, group)) {
+        if (!groupSatisfied(aParent, group)) {
+            addError("missing required element", children[group].mName);
+        }
+    }
+    aParent.mGroup = foundGroup;
+    aParent.mMatched = found;
+    aParent.mCount = 1;
+    return &children[found];
+}
+
+bool XmlValidator::groupSatisfied(const Frame& aFrame, std::uint32_t aGroup) const {
+    const auto children = aFrame.mType->mChildren;
+    if (aGroup == aFrame.mGroup && aFrame.mMatched != kNoMatch) {
+        return aFrame.mCount >= children[aFrame.mMatched].mMinOccurs;
+    }
+    // Nothing matched yet: fine if any alternative may occur zero times.
+    const std::uint32_t end = groupEnd(aFrame, aGroup);
+    for (std::uint32_t index = aGroup; index < end; ++index) {
+        if (children[index].mMinOccurs == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint32_t XmlValidator::groupEnd(const Frame& aFrame, std::uint32_t aGroup) const {
+    const auto children = aFrame.mType->mChildren;
+    std::uint32_t end = aGroup + 1;
+    while (end < children.size() && children[end].mAlternative) {
+        ++end;
+    }
+    return end;
+}
+
+void XmlValidator::checkComplete(const Frame& aFrame) {
+    const auto count = static_cast<std::uint32_t>(aFrame.mType->mChildren.size());
+    for (std::uint32_t group = aFrame.mGroup; group < count; group = groupEnd(aFrame, group)) {
+        if (!groupSatisfied(aFrame, group)) {
+            addError("missing required element", aFrame.mType->mChildren[group].mName);
+        }
+    }
+}
+
+void XmlValidator::checkValue(const Frame& aFrame) {
+    const std::string_view error = ValueError(mText, *aFrame.mType);
+    if (!error.empty()) {
+        addError(error, mText);
+    }
+}
+
+void XmlValidator::addError(std::string_view aMessage, std::string_view aDetail) {
+    ++mErrorCount;
+    if (mErrors.size() >= MAX_XML_VALIDATION_ERRORS) {
+        return;
+    }
+
+    std::string error;
+    for (const auto& frame : mFrames) {
+        if (!error.empty()) {
+            error.push_back('/');
+        }
+        error.append(frame.mName);
+    }
+    if (!error.empty()) {
+        error.append(": ");
+    }
+    error.append(aMessage);
+    if (!aDetail.empty()) {
+        error.append(" '");
+        error.append(aDetail);
+        error.push_back('\'');
+    }
+    mErrors.push_back(std::move(error));
+}
+
+} // namespace taxbroker
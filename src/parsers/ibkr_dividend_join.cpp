@@ -0,0 +1,239 @@
+#include "parsers/ibkr_dividend_join.hpp"
+
+#include "utils/date_utils.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+
+namespace {
+
+using taxbroker::Currency;
+using taxbroker::DividendTransaction;
+using taxbroker::Money;
+using taxbroker::ParseWarning;
+using taxbroker::WarningCode;
+using taxbroker::ibkr::DividendRow;
+using taxbroker::ibkr::WithholdingRow;
+
+struct PaymentKey {
+    std::string_view mIsin;
+    std::int32_t mDay{};
+
+    friend bool operator==(const PaymentKey&, const PaymentKey&) = default;
+};
+
+struct PaymentKeyHasher {
+    std::size_t operator()(const PaymentKey& aKey) const noexcept {
+        return std::hash<std::string_view>{}(aKey.mIsin) ^
+               (static_cast<std::size_t>(aKey.mDay) * 0x9E3779B97F4A7C15ULL);
+    }
+};
+
+struct Payment {
+    std::size_t mInstrument{};
+    std::int32_t mDay{};
+    Money mGross{};
+    Money mWithheld{}; // As reported: negative while tax is withheld.
+    Currency mCurrency{Currency::EUR};
+    bool mHasDividend{false};
+};
+
+class PaymentTable {
+  public:
+    PaymentTable(std::size_t aRowCount, std::string_view aSourceFile,
+                 std::vector<ParseWarning>& aWarnings)
+        : mSourceFile(aSourceFile), mWarnings(aWarnings) {
+        mIndex.reserve(aRowCount);
+        mPayments.reserve(aRowCount);
+    }
+
+    void addDividend(const DividendRow& aRow) {
+        const auto instrument = instrumentOf(aRow.mIsin, aRow.mName);
+        const PaymentKey key{aRow.mIsin, taxbroker::DaySerial(aRow.mDate)};
+
+        auto position = mIndex.find(key);
+        if (position == mIndex.end() && aRow.mAmount < 0) {
+            if (const auto earlier = latestBefore(instrument, key.mDay)) {
+                mPayments[*earlier].mGross += aRow.mAmount;
+                return;
+            }
+            warn(aRow.mRowIndex,
+                 "Dividend reversal for " + aRow.mIsin + " has no matching payment");
+        }
+        if (position == mIndex.end()) {
+            position = mIndex.emplace(key, mPayments.size()).first;
+            mPayments.push_back(Payment{instrument, key.mDay, 0, 0, aRow.mCurrency, false});
+            mByInstrument[instrument].push_back(position->second);
+            if (mIndexed) {
+                addToDayIndex(instrument, key.mDay, position->second);
+            }
+        }
+
+        auto& payment = mPayments[position->second];
+        payment.mGross += aRow.mAmount;
+        payment.mCurrency = aRow.mCurrency;
+        payment.mHasDividend = true;
+    }
+
+    void addWithholding(const WithholdingRow& aRow) {
+        const auto instrument = mInstrumentIndex.find(aRow.mIsin);
+        const PaymentKey key{aRow.mIsin, taxbroker::DaySerial(aRow.mDate)};
+
+        std::optional<std::size_t> target;
+        if (const auto position = mIndex.find(key); position != mIndex.end()) {
+            target = position->second;
+        } else if (instrument != mInstrumentIndex.end()) {
+            target = latestBefore(instrument->second, key.mDay);
+        }
+
+        if (!target) {
+            warn(aRow.mRowIndex, "Withholding tax for " + aRow.mIsin + " has no matching dividend");
+            const auto owner = instrumentOf(aRow.mIsin, {});
+            target = mPayments.size();
+            mIndex.emplace(key, *target);
+            mPayments.push_back(Payment{owner, key.mDay, 0, 0, aRow.mCurrency, false});
+            mByInstrument[owner].push_back(*target);
+        }
+
+        auto& payment = mPayments[*target];
+        if (payment.mHasDividend && payment.mCurrency != aRow.mCurrency) {
+            warn(aRow.mRowIndex, "Withholding tax for " + aRow.mIsin +
+                                     " is in a different currency than its dividend");
+        }
+        payment.mWithheld += aRow.mAmount;
+    }
+
+    // Sorts every instrument's dividend payments by day; call once all payments are added.
+    void indexPayments() {
+        mDividendDays.resize(mInstruments.size());
+        for (std::size_t index = 0; index < mInstruments.size(); ++index) {
+            auto& days = mDividendDays[index];
+            for (const auto paymentIndex : mByInstrument[index]) {
+                if (mPayments[paymentIndex].mHasDividend) {
+                    days.push_back(DayEntry{mPayments[paymentIndex].mDay, paymentIndex});
+                }
+            }
+            std::sort(days.begin(), days.end(), [](const DayEntry& aLeft, const DayEntry& aRight) {
+                return aLeft.mDay < aRight.mDay;
+            });
+        }
+        mIndexed = true;
+    }
+
+    std::vector<taxbroker::DividendInstrument> finish() {
+        for (std::size_t index = 0; index < mInstruments.size(); ++index) {
+            auto& transactions = mInstruments[index].mTransactions;
+            for (const auto paymentIndex : mByInstrument[index]) {
+                const auto& payment = mPayments[paymentIndex];
+                if (payment.mGross == 0 && payment.mWithheld == 0) {
+                    continue; // Fully reversed.
+                }
+                transactions.push_back(DividendTransaction{
+                    taxbroker::Date{taxbroker::DayDuration{payment.mDay}}, payment.mGross,
+                    -payment.mWithheld, payment.mCurrency});
+            }
+            std::sort(transactions.begin(), transactions.end(),
+                      [](const DividendTransaction& aLeft, const DividendTransaction& aRight) {
+                          return aLeft.mDate < aRight.mDate;
+                      });
+        }
+
+        std::erase_if(mInstruments, [](const taxbroker::DividendInstrument& aInstrument) {
+            return aInstrument.mTransactions.empty();
+        });
+        return std::move(mInstruments);
+    }
+
+  private:
+    std::size_t instrumentOf(const std::string& aIsin, std::string_view aName) {
+        const auto [position, inserted] = mInstrumentIndex.try_emplace(aIsin, mInstruments.size());
+        if (inserted) {
+            mInstruments.push_back(taxbroker::DividendInstrument{aIsin, std::string{aName}, {}});
+            mByInstrument.emplace_back();
+        } else if (mInstruments[position->second].mName.empty()) {
+            mInstruments[position->second].mName = std::string{aName};
+        }
+        return position->second;
+    }
+
+    struct DayEntry {
+        std::int32_t mDay{};
+        std::size_t mPayment{};
+    };
+
+    static bool DayBefore(const DayEntry& aEntry, std::int32_t aDay) {
+        return aEntry.mDay < aDay;
+    }
+
+    // A reversal without a payment becomes one; keeps the day index sorted.
+    void addToDayIndex(std::size_t aInstrument, std::int32_t aDay, std::size_t aPayment) {
+        if (aInstrument >= mDividendDays.size()) {
+            mDividendDays.resize(aInstrument + 1);
+        }
+        auto& days = mDividendDays[aInstrument];
+        days.insert(std::lower_bound(days.begin(), days.end(), aDay, DayBefore),
+                    DayEntry{aDay, aPayment});
+    }
+
+    // Latest dividend payment of aInstrument strictly before aDay. Only used for corrections.
+    std::optional<std::size_t> latestBefore(std::size_t aInstrument, std::int32_t aDay) const {
+        if (aInstrument >= mDividendDays.size()) {
+            return std::nullopt;
+        }
+        const auto& days = mDividendDays[aInstrument];
+        const auto firstNotBefore = std::lower_bound(days.begin(), days.end(), aDay, DayBefore);
+        if (firstNotBefore == days.begin()) {
+            return std::nullopt;
+        }
+        return std::prev(firstNotBefore)->mPayment;
+    }
+
+    void warn(std::size_t aRowIndex, std::string aMessage) {
+        mWarnings.push_back(ParseWarning{WarningCode::InvalidValue, std::string{mSourceFile},
+                                         aRowIndex, std::move(aMessage)});
+    }
+
+    std::string_view mSourceFile;
+    std::vector<ParseWarning>& mWarnings;
+    std::unordered_map<PaymentKey, std::size_t, PaymentKeyHasher> mIndex;
+    std::unordered_map<std::string_view, std::size_t> mInstrumentIndex;
+    std::vector<Payment> mPayments;
+    std::vector<taxbroker::DividendInstrument> mInstruments;
+    std::vector<std::vector<std::size_t>> mByInstrument; // Payment indices per instrument.
+    std::vector<std::vector<DayEntry>> mDividendDays;   // Dividend payments by day, per instrument.
+    bool mIndexed{false};
+};
+
+} // namespace
+
+namespace taxbroker::ibkr {
+
+std::vector<DividendInstrument>
+JoinDividendWithholding(std::span<const DividendRow> aDividends,
+                        std::span<const WithholdingRow> aWithholdings,
+                        std::string_view aSourceFile, std::vector<ParseWarning>& aWarnings) {
+    PaymentTable table{aDividends.size() + aWithholdings.size(), aSourceFile, aWarnings};
+
+    // Payments first, then reversals, then tax, so corrections always find their payment
+    // regardless of row order.
+    for (const auto& row : aDividends) {
+        if (row.mAmount >= 0) {
+            table.addDividend(row);
+        }
+    }
+    table.indexPayments();
+    for (const auto& row : aDividends) {
+        if (row.mAmount < 0) {
+            table.addDividend(row);
+        }
+    }
+    for (const auto& row : aWithholdings) {
+        table.addWithholding(row);
+    }
+
+    return table.finish();
+}
+
+} // namespace taxbroker::ibkr
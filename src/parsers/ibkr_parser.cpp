@@ -1,3 +1,300 @@
 #include "parsers/ibkr_parser.hpp"
 
-namespace taxbroker::ibkr {} // namespace taxbroker::ibkr
\ No newline at end of file
+#include "parsers/ibkr_dividend_join.hpp"
+#include "utils/date_utils.hpp"
+#include "utils/decimal_format.hpp"
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+using taxbroker::Currency;
+using taxbroker::Date;
+using taxbroker::MakeDate;
+using taxbroker::Money;
+using taxbroker::MONEY_SCALE;
+using taxbroker::MONEY_SCALE_DIGITS;
+using taxbroker::ParseResult;
+using taxbroker::ParseWarning;
+using taxbroker::WarningCode;
+using taxbroker::ibkr::DividendRow;
+using taxbroker::ibkr::WithholdingRow;
+
+constexpr std::string_view kDividendSection = "Dividends";
+constexpr std::string_view kWithholdingSection = "Withholding Tax";
+
+// Largest integer part ParseAmount accepts; any fraction and rounding still fit in Money.
+constexpr Money kMaxWholeAmount = std::numeric_limits<Money>::max() / MONEY_SCALE - 1;
+
+// Sections with taxable data this parser does not read yet; reported once each.
+constexpr std::array<std::string_view, 2> kUnsupportedSections{"Trades", "Interest"};
+
+// Fields of one CSV line; quoted fields may contain commas and doubled quotes.
+std::vector<std::string> SplitCsvLine(std::string_view aLine) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (std::size_t position = 0; position < aLine.size(); ++position) {
+        const char character = aLine[position];
+        if (quoted) {
+            if (character != '"') {
+                fields.back() += character;
+            } else if (position + 1 < aLine.size() && aLine[position + 1] == '"') {
+                fields.back() += '"';
+                ++position;
+            } else {
+                quoted = false;
+            }
+        } else if (character == '"') {
+            quoted = true;
+        } else if (character == ',') {
+            fields.emplace_back();
+        } else if (character != '\r') {
+            fields.back() += character;
+        }
+    }
+    return fields;
+}
+
+/*
+    Decimal amount such as "-11.25" or "1,234.5"; digits beyond Money precision are
+    rounded. Amounts that do not fit in Money are rejected like malformed ones.
+*/
+std::optional<Money> ParseAmount(std::string_view aText) {
+    const bool negative = !aText.empty() && aText.front() == '-';
+    if (negative) {
+        aText.remove_prefix(1);
+    }
+
+    Money whole = 0;
+    Money fraction = 0;
+    int fractionDigits = 0;
+    bool roundUp = false;
+    bool inFraction = false;
+    bool anyDigit = false;
+    for (const char character : aText) {
+        if (character == ',' && !inFraction) {
+            continue;
+        }
+        if (character == '.' && !inFraction) {
+            inFraction = true;
+            continue;
+        }
+        if (character < '0' || character > '9') {
+            return std::nullopt;
+        }
+        anyDigit = true;
+        const int digit = character - '0';
+        if (!inFraction) {
+            if (whole > (kMaxWholeAmount - digit) / 10) {
+                return std::nullopt;
+            }
+            whole = whole * 10 + digit;
+        } else if (fractionDigits < MONEY_SCALE_DIGITS) {
+            fraction = fraction * 10 + digit;
+            ++fractionDigits;
+        } else if (fractionDigits++ == MONEY_SCALE_DIGITS) {
+            roundUp = digit >= 5;
+        }
+    }
+    if (!anyDigit) {
+        return std::nullopt;
+    }
+
+    for (; fractionDigits < MONEY_SCALE_DIGITS; ++fractionDigits) {
+        fraction *= 10;
+    }
+    const Money amount = whole * MONEY_SCALE + fraction + (roundUp ? 1 : 0);
+    return negative ? -amount : amount;
+}
+
+// YYYY-MM-DD of an existing day.
+std::optional<Date> ParseIsoDate(std::string_view aText) {
+    if (aText.size() != taxbroker::ISO_DATE_LENGTH || aText[4] != '-' || aText[7] != '-') {
+        return std::nullopt;
+    }
+
+    int year = 0;
+    unsigned month = 0;
+    unsigned day = 0;
+    const auto parse = [](std::string_view aField, auto& aValue) {
+        const auto [end, error] = std::from_chars(aField.data(), aField.data() + aField.size(),
+                                                  aValue);
+        return error == std::errc{} && end == aField.data() + aField.size();
+    };
+    if (!parse(aText.substr(0, 4), year) || !parse(aText.substr(5, 2), month) ||
+        !parse(aText.substr(8, 2), day) ||
+        !std::chrono::year_month_day{std::chrono::year{year}, std::chrono::month{month},
+                                     std::chrono::day{day}}
+             .ok()) {
+        return std::nullopt;
+    }
+    return MakeDate(year, month, day);
+}
+
+Currency ParseCurrency(std::string_view aText) {
+    if (aText == "EUR") {
+        return Currency::EUR;
+    }
+    if (aText == "USD") {
+        return Currency::USD;
+    }
+    if (aText == "GBP") {
+        return Currency::GBP;
+    }
+    if (aText == "CHF") {
+        return Currency::CHF;
+    }
+    return Currency::Unknown;
+}
+
+struct Security {
+    std::string_view mSymbol;
+    std::string_view mIsin;
+};
+
+// "MSFT(US5949181045) Cash Dividend USD 0.75 per Share" -> MSFT, US5949181045.
+std::optional<Security> ParseSecurity(std::string_view aDescription) {
+    const auto open = aDescription.find('(');
+    const auto close = aDescription.find(')', open);
+    if (open == std::string_view::npos || close == std::string_view::npos ||
+        close - open - 1 != 12) {
+        return std::nullopt;
+    }
+    return Security{aDescription.substr(0, open), aDescription.substr(open + 1, 12)};
+}
+
+class StatementReader {
+  public:
+    StatementReader(std::string aSourceFile, std::vector<ParseWarning>& aWarnings)
+        : mSourceFile(std::move(aSourceFile)), mWarnings(aWarnings) {}
+
+    void readLine(std::string_view aLine, std::size_t aRowIndex) {
+        const auto fields = SplitCsvLine(aLine);
+        if (fields.size() < 2) {
+            return;
+        }
+
+        const std::string_view section = fields[0];
+        if (fields[1] == "Header") {
+            auto& columns = mColumns[fields[0]];
+            columns.clear();
+            for (std::size_t index = 2; index < fields.size(); ++index) {
+                columns.emplace(fields[index], index);
+            }
+            return;
+        }
+        if (fields[1] != "Data") {
+            return;
+        }
+
+        if (section == kDividendSection || section == kWithholdingSection) {
+            readCashRow(section, fields, aRowIndex);
+            return;
+        }
+        for (const auto unsupported : kUnsupportedSections) {
+            if (section == unsupported && mReported.emplace(fields[0]).second) {
+                warn(WarningCode::UnsupportedRowType, aRowIndex,
+                     "Section '" + fields[0] + "' is not imported");
+            }
+        }
+    }
+
+    [[nodiscard]] std::vector<taxbroker::DividendInstrument> dividends() {
+        return JoinDividendWithholding(mDividends, mWithholdings, mSourceFile, mWarnings);
+    }
+
+  private:
+    void readCashRow(std::string_view aSection, const std::vector<std::string>& aFields,
+                     std::size_t aRowIndex) {
+        const auto columns = mColumns.find(std::string{aSection});
+        if (columns == mColumns.end()) {
+            warn(WarningCode::MissingField, aRowIndex, "Data row before its section header");
+            return;
+        }
+        const auto cell = [&](std::string_view aName) -> std::optional<std::string_view> {
+            const auto column = columns->second.find(std::string{aName});
+            if (column == columns->second.end() || column->second >= aFields.size()) {
+                return std::nullopt;
+            }
+            return aFields[column->second];
+        };
+
+        const auto currency = cell("Currency");
+        const auto date = cell("Date");
+        const auto description = cell("Description");
+        const auto amount = cell("Amount");
+        if (!currency || !date || !description || !amount) {
+            warn(WarningCode::MissingField, aRowIndex, "Row lacks a required column");
+            return;
+        }
+        if (currency->starts_with("Total")) {
+            return; // Section totals, per currency and converted.
+        }
+
+        const auto parsedDate = ParseIsoDate(*date);
+        const auto parsedAmount = ParseAmount(*amount);
+        const auto security = ParseSecurity(*description);
+        if (!parsedDate || !parsedAmount || !security) {
+            warn(WarningCode::InvalidValue, aRowIndex,
+                 "Cannot read row '" + std::string{*description} + "'");
+            return;
+        }
+
+        if (aSection == kDividendSection) {
+            mDividends.push_back(DividendRow{std::string{security->mIsin},
+                                             std::string{security->mSymbol}, *parsedDate,
+                                             *parsedAmount, ParseCurrency(*currency), aRowIndex});
+        } else {
+            mWithholdings.push_back(WithholdingRow{std::string{security->mIsin}, *parsedDate,
+                                                   *parsedAmount, ParseCurrency(*currency),
+                                                   aRowIndex});
+        }
+    }
+
+    void warn(WarningCode aCode, std::size_t aRowIndex, std::string aMessage) {
+        mWarnings.push_back(ParseWarning{aCode, mSourceFile, aRowIndex, std::move(aMessage)});
+    }
+
+    std::string mSourceFile;
+    std::vector<ParseWarning>& mWarnings;
+    std::unordered_map<std::string, std::unordered_map<std::string, std::size_t>> mColumns;
+    std::unordered_set<std::string> mReported;
+    std::vector<DividendRow> mDividends;
+    std::vector<WithholdingRow> mWithholdings;
+};
+
+} // namespace
+
+namespace taxbroker::ibkr {
+
+ParseResult IbkrParser::parse(const std::filesystem::path& csvPath) {
+    ParseResult result;
+    std::ifstream input{csvPath};
+    if (!input) {
+        result.mWarnings.push_back(
+            ParseWarning{WarningCode::ParseError, csvPath.string(), 0, "Cannot open file"});
+        return result;
+    }
+
+    StatementReader reader{csvPath.string(), result.mWarnings};
+    std::string line;
+    std::size_t rowIndex = 0;
+    while (std::getline(input, line)) {
+        reader.readLine(line, ++rowIndex);
+    }
+
+    result.mStatement.mDividendInstruments = reader.dividends();
+    return result;
+}
+
+} // namespace taxbroker::ibkr
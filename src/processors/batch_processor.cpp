@@ -0,0 +1,291 @@
+#include "processors/batch_processor.hpp"
+
+#include "utils/logger.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <string_view>
+
+namespace {
+
+using taxbroker::BatchJob;
+using taxbroker::BatchJobResult;
+using taxbroker::BatchJobStatus;
+using taxbroker::FinalReport;
+
+using Clock = std::chrono::steady_clock;
+
+std::string_view Trim(std::string_view aText) {
+    const auto first = aText.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    const auto last = aText.find_last_not_of(" \t\r");
+    return aText.substr(first, last - first + 1);
+}
+
+std::vector<std::string_view> Split(std::string_view aText, char aSeparator) {
+    std::vector<std::string_view> fields;
+    std::size_t begin = 0;
+    while (true) {
+        const auto end = aText.find(aSeparator, begin);
+        fields.push_back(Trim(aText.substr(begin, end - begin)));
+        if (end == std::string_view::npos) {
+            return fields;
+        }
+        begin = end + 1;
+    }
+}
+
+std::optional<BatchJob> ParseManifestLine(std::string_view aLine,
+                                          const std::filesystem::path& aBaseDirectory) {
+    const auto fields = Split(aLine, ';');
+    if (fields.size() != 3 || fields[0].empty() || fields[2].empty()) {
+        return std::nullopt;
+    }
+
+    BatchJob job;
+    job.mTaxpayerId = std::string{fields[0]};
+
+    const auto year = fields[1];
+    const auto [end, error] = std::from_chars(year.data(), year.data() + year.size(), job.mTaxYear);
+    if (error != std::errc{} || end != year.data() + year.size()) {
+        return std::nullopt;
+    }
+
+    for (const auto file : Split(fields[2], ',')) {
+        if (file.empty()) {
+            return std::nullopt;
+        }
+        const std::filesystem::path path{file};
+        job.mInputFiles.push_back(path.is_absolute() ? path : aBaseDirectory / path);
+    }
+
+    return job;
+}
+
+std::size_t InputBytes(const BatchJob& aJob) {
+    std::size_t bytes = 0;
+    for (const auto& file : aJob.mInputFiles) {
+        std::error_code error;
+        const auto size = std::filesystem::file_size(file, error);
+        if (!error) {
+            bytes += static_cast<std::size_t>(size);
+        }
+    }
+    return bytes;
+}
+
+std::size_t ReportBytes(const FinalReport& aReport) {
+    std::size_t bytes = sizeof(FinalReport);
+    for (const auto& instrument : aReport.mInstruments) {
+        bytes += EstimateFootprint(instrument);
+    }
+    for (const auto& instrument : aReport.mDividendInstruments) {
+        bytes += sizeof(instrument) +
+                 instrument.mTransactions.capacity() * sizeof(instrument.mTransactions.front());
+    }
+    const auto& interest = aReport.mInterestTransactions;
+    bytes += interest.capacity() * sizeof(interest.front());
+    return bytes;
+}
+
+// Jobs admitted and input bytes reserved so far; run() waits on mCondition for room.
+struct Admission {
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::size_t mRunningJobs{};
+    std::size_t mReservedBytes{};
+};
+
+// Gives an admitted job's slot back however its task ends, so admission never stalls.
+class AdmissionSlot {
+  public:
+    AdmissionSlot(Admission& aAdmission, std::size_t aReservation)
+        : mAdmission(aAdmission), mReservation(aReservation) {}
+
+    AdmissionSlot(const AdmissionSlot&) = delete;
+    AdmissionSlot& operator=(const AdmissionSlot&) = delete;
+
+    ~AdmissionSlot() {
+        const std::lock_guard lock(mAdmission.mMutex);
+        --mAdmission.mRunningJobs;
+        mAdmission.mReservedBytes -= mReservation;
+        mAdmission.mCondition.notify_all();
+    }
+
+  private:
+    Admission& mAdmission;
+    std::size_t mReservation;
+};
+
+BatchJobResult FailedJob(const BatchJob& aJob, std::string aError) {
+    LOG_ERROR("Batch job {} ({}) failed: {}", aJob.mTaxpayerId, aJob.mTaxYear, aError);
+
+    BatchJobResult result;
+    result.mTaxpayerId = aJob.mTaxpayerId;
+    result.mTaxYear = aJob.mTaxYear;
+    result.mStatus = BatchJobStatus::Failed;
+    result.mError = std::move(aError);
+    return result;
+}
+
+} // namespace
+
+namespace taxbroker {
+
+std::optional<std::vector<BatchJob>>
+ParseBatchManifest(std::istream& aManifest, const std::filesystem::path& aBaseDirectory) {
+    std::vector<BatchJob> jobs;
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(aManifest, line)) {
+        ++lineNumber;
+        const auto content = Trim(line);
+        if (content.empty() || content.front() == '#') {
+            continue;
+        }
+
+        auto job = ParseManifestLine(content, aBaseDirectory);
+        if (!job) {
+            LOG_ERROR("Malformed batch manifest line {}: '{}'", lineNumber, line);
+            return std::nullopt;
+        }
+        jobs.push_back(std::move(*job));
+    }
+    return jobs;
+}
+
+std::optional<std::vector<BatchJob>> ReadBatchManifest(const std::filesystem::path& aManifestPath) {
+    std::ifstream manifest{aManifestPath};
+    if (!manifest) {
+        LOG_ERROR("Cannot open batch manifest {}", aManifestPath.string());
+        return std::nullopt;
+    }
+    return ParseBatchManifest(manifest, aManifestPath.parent_path());
+}
+
+std::string BatchAuditScope(const BatchJob& aJob) {
+    return aJob.mTaxpayerId + '/' + std::to_string(aJob.mTaxYear);
+}
+
+BatchResult BatchProcessor::run(std::span<const BatchJob> aJobs, const BatchOptions& aOptions) {
+    const auto batchStart = Clock::now();
+    const std::size_t concurrencyLimit =
+        aOptions.mMaxConcurrentJobs > 0 ? aOptions.mMaxConcurrentJobs : mPool.threadCount();
+
+    std::vector<std::size_t> inputBytes(aJobs.size());
+    std::transform(aJobs.begin(), aJobs.end(), inputBytes.begin(), InputBytes);
+
+    std::vector<std::size_t> admissionOrder(aJobs.size());
+    std::iota(admissionOrder.begin(), admissionOrder.end(), std::size_t{0});
+    std::stable_sort(admissionOrder.begin(), admissionOrder.end(),
+                     [&inputBytes](std::size_t aLeft, std::size_t aRight) {
+                         return inputBytes[aLeft] > inputBytes[aRight];
+                     });
+
+    BatchResult batch;
+    batch.mJobs.resize(aJobs.size());
+    auto& summary = batch.mSummary;
+
+    Admission admission;
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(aJobs.size());
+
+    // NOTE:
+    // Admission blocks the calling thread, so run() must not be called from a pool task.
+    for (const auto index : admissionOrder) {
+        const std::size_t reservation = inputBytes[index] * MEMORY_PER_INPUT_BYTE;
+        {
+            std::unique_lock lock(admission.mMutex);
+            admission.mCondition.wait(lock, [&]() {
+                const bool fitsBudget =
+                    aOptions.mMemoryBudgetBytes == 0 || admission.mRunningJobs == 0 ||
+                    admission.mReservedBytes + reservation <= aOptions.mMemoryBudgetBytes;
+                return admission.mRunningJobs < concurrencyLimit && fitsBudget;
+            });
+            ++admission.mRunningJobs;
+            admission.mReservedBytes += reservation;
+            summary.mPeakConcurrentJobs =
+                std::max(summary.mPeakConcurrentJobs, admission.mRunningJobs);
+            summary.mPeakReservedBytes =
+                std::max(summary.mPeakReservedBytes, admission.mReservedBytes);
+        }
+
+        pending.push_back(mPool.submit([&, index, reservation]() {
+            const AdmissionSlot slot{admission, reservation};
+            auto result = runJob(aJobs[index], aOptions);
+            result.mInputBytes = inputBytes[index];
+            result.mReservedBytes = reservation;
+            batch.mJobs[index] = std::move(result);
+        }));
+    }
+
+    for (auto& future : pending) {
+        future.get();
+    }
+
+    summary.mJobCount = batch.mJobs.size();
+    for (const auto& job : batch.mJobs) {
+        if (job.mStatus == BatchJobStatus::Failed) {
+            ++summary.mFailedCount;
+            continue;
+        }
+        ++summary.mCompletedCount;
+        summary.mInstrumentCount += job.mReport->mInstruments.size();
+        summary.mWarningCount += job.mReport->mParseWarnings.size() + job.mReport->mWarnings.size();
+    }
+    summary.mWallTime =
+        std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - batchStart);
+
+    LOG_INFO("Batch finished: {} jobs, {} completed, {} failed in {} ms", summary.mJobCount,
+             summary.mCompletedCount, summary.mFailedCount, summary.mWallTime.count());
+    return batch;
+}
+
+BatchJobResult BatchProcessor::runJob(const BatchJob& aJob, const BatchOptions& aOptions) {
+    const auto jobStart = Clock::now();
+
+    // Anything a resolver or parser throws fails this job only, never the batch.
+    try {
+        std::vector<ReportSource> sources;
+        sources.reserve(aJob.mInputFiles.size());
+        for (const auto& file : aJob.mInputFiles) {
+            auto parser = mResolver(file);
+            if (parser == nullptr) {
+                return FailedJob(aJob, "No parser for input file " + file.string());
+            }
+            sources.push_back(ReportSource{file, std::move(parser)});
+        }
+
+        ReportOptions options;
+        options.mTaxYear = aJob.mTaxYear;
+        options.mFxRates = aOptions.mFxRates;
+        options.mMode = PipelineMode::Sequential;
+        options.mCache = aOptions.mCache;
+        options.mAuditLog = aOptions.mAuditLog;
+        options.mAuditScope = BatchAuditScope(aJob);
+
+        BatchJobResult result;
+        result.mTaxpayerId = aJob.mTaxpayerId;
+        result.mTaxYear = aJob.mTaxYear;
+        result.mReport = ReportProcessor{mPool}.process(sources, options);
+        result.mReportBytes = ReportBytes(*result.mReport);
+        result.mDuration =
+            std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - jobStart);
+        return result;
+    } catch (const std::exception& error) {
+        return FailedJob(aJob, error.what());
+    } catch (...) {
+        return FailedJob(aJob, "Unknown error");
+    }
+}
+
+} // namespace taxbroker
@@ -0,0 +1,123 @@
+#include "processors/corporate_actions.hpp"
+
+#include "utils/logger.hpp"
+#include "utils/numeric_util.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+using taxbroker::CORP_RATIO_SCALE;
+using taxbroker::CorporateAction;
+using taxbroker::CorporateActionType;
+using taxbroker::UnitsFactor;
+
+// Reduces aNumerator / aDenominator to lowest terms.
+UnitsFactor Reduce(std::int64_t aNumerator, std::int64_t aDenominator) {
+    const std::int64_t divisor = std::gcd(aNumerator, aDenominator);
+    return divisor > 1 ? UnitsFactor{aNumerator / divisor, aDenominator / divisor}
+                       : UnitsFactor{aNumerator, aDenominator};
+}
+
+/*
+    Product of two reduced factors, cross-cancelled first so it is reduced too.
+    Throws std::overflow_error once the coprime terms no longer fit in 64 bits;
+    the instrument then fails instead of being restated with a rounded factor.
+*/
+UnitsFactor Multiply(const UnitsFactor& aLeft, const UnitsFactor& aRight) {
+    const UnitsFactor leftOverRight = Reduce(aLeft.mNumerator, aRight.mDenominator);
+    const UnitsFactor rightOverLeft = Reduce(aRight.mNumerator, aLeft.mDenominator);
+    return UnitsFactor{checkedMultiply(leftOverRight.mNumerator, rightOverLeft.mNumerator),
+                       checkedMultiply(rightOverLeft.mDenominator, leftOverRight.mDenominator)};
+}
+
+UnitsFactor FactorOf(const CorporateAction& aAction) {
+    if (aAction.mRatio <= 0) {
+        LOG_WARN("Ignoring corporate action with non-positive ratio {}", aAction.mRatio);
+        return UnitsFactor{};
+    }
+
+    switch (aAction.mType) {
+    case CorporateActionType::Split:
+    case CorporateActionType::Merger:
+        return Reduce(aAction.mRatio, CORP_RATIO_SCALE);
+    case CorporateActionType::ReverseSplit:
+        return Reduce(CORP_RATIO_SCALE, aAction.mRatio);
+    }
+
+    return UnitsFactor{};
+}
+
+} // namespace
+
+namespace taxbroker {
+
+CorporateActionTable::CorporateActionTable(std::span<const CorporateAction> aActions) {
+    std::vector<CorporateAction> sortedActions(aActions.begin(), aActions.end());
+    std::stable_sort(sortedActions.begin(), sortedActions.end(),
+                     [](const CorporateAction& aLeft, const CorporateAction& aRight) {
+                         return aLeft.mDate < aRight.mDate;
+                     });
+
+    mDates.reserve(sortedActions.size());
+    for (const auto& action : sortedActions) {
+        mDates.push_back(action.mDate);
+    }
+
+    mCumulative.resize(sortedActions.size() + 1);
+    for (std::size_t index = sortedActions.size(); index > 0; --index) {
+        mCumulative[index - 1] = Multiply(FactorOf(sortedActions[index - 1]), mCumulative[index]);
+    }
+}
+
+UnitsFactor CorporateActionTable::factorAfter(Date aDate) const {
+    if (mDates.empty()) {
+        return UnitsFactor{};
+    }
+
+    const auto firstLater = std::upper_bound(mDates.begin(), mDates.end(), aDate);
+    return mCumulative[static_cast<std::size_t>(firstLater - mDates.begin())];
+}
+
+Units CorporateActionTable::restateUnits(Date aDate, Units aUnits) const {
+    const auto factor = factorAfter(aDate);
+    if (factor.mNumerator == factor.mDenominator) {
+        return aUnits;
+    }
+
+    return mulDivRounded(aUnits, factor.mNumerator, factor.mDenominator);
+}
+
+Money CorporateActionTable::restateUnitPrice(Date aDate, Money aUnitPrice) const {
+    const auto factor = factorAfter(aDate);
+    if (factor.mNumerator == factor.mDenominator) {
+        return aUnitPrice;
+    }
+
+    return mulDivRounded(aUnitPrice, factor.mDenominator, factor.mNumerator);
+}
+
+TradeTransaction CorporateActionTable::restate(const TradeTransaction& aTransaction) const {
+    TradeTransaction restated = aTransaction;
+    restated.mUnits = restateUnits(aTransaction.mDate, aTransaction.mUnits);
+    restated.mUnitPrice = restateUnitPrice(aTransaction.mDate, aTransaction.mUnitPrice);
+    return restated;
+}
+
+std::vector<TradeTransaction> RestateTransactions(const TradeInstrument& aInstrument) {
+    if (aInstrument.mCorporateActions.empty()) {
+        return aInstrument.mTransactions;
+    }
+
+    const CorporateActionTable table{aInstrument.mCorporateActions};
+
+    std::vector<TradeTransaction> restated;
+    restated.reserve(aInstrument.mTransactions.size());
+    for (const auto& transaction : aInstrument.mTransactions) {
+        restated.push_back(table.restate(transaction));
+    }
+    return restated;
+}
+
+} // namespace taxbroker
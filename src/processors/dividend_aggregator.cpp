@@ -0,0 +1,250 @@
+#include "processors/dividend_aggregator.hpp"
+
+#include "core/year_index.hpp"
+#include "utils/date_utils.hpp"
+#include "utils/logger.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+using taxbroker::Currency;
+using taxbroker::Date;
+using taxbroker::DayDuration;
+using taxbroker::DaySerial;
+using taxbroker::DividendAggregation;
+using taxbroker::DividendGroup;
+using taxbroker::DividendInstrument;
+using taxbroker::Money;
+using taxbroker::SumMoney;
+using taxbroker::YearIndex;
+
+using TransactionSpan = std::span<const taxbroker::DividendTransaction>;
+
+constexpr std::uint64_t kEmptySlot = ~std::uint64_t{0};
+
+// Key layout: payer id (24 bits) | biased day serial (24 bits) | currency (16 bits).
+constexpr unsigned kDayBits = 24;
+constexpr unsigned kCurrencyBits = 16;
+constexpr std::uint32_t kMaxPayerId = (1U << 24) - 2; // All ones is reserved for kEmptySlot.
+constexpr std::int32_t kDayBias = 1 << (kDayBits - 1);
+
+/*
+    ISO 3166 country of the ISIN prefix, empty when the prefix is not a country:
+    XS (international), EU (European Union) and the other user-assigned codes
+    AA, QM-QZ, XA-XZ and ZZ that numbering agencies use for non-national issues.
+*/
+std::string_view SourceCountryOf(std::string_view aIsin) {
+    if (aIsin.size() < 2 || aIsin[0] < 'A' || aIsin[0] > 'Z' || aIsin[1] < 'A' ||
+        aIsin[1] > 'Z') {
+        return {};
+    }
+
+    const std::string_view prefix = aIsin.substr(0, 2);
+    const bool userAssigned = prefix == "AA" || prefix == "ZZ" || prefix[0] == 'X' ||
+                              (prefix[0] == 'Q' && prefix[1] >= 'M');
+    if (userAssigned || prefix == "EU") {
+        return {};
+    }
+    return prefix;
+}
+
+std::uint64_t PackKey(std::uint32_t aPayerId, std::int32_t aDay, Currency aCurrency) {
+    const auto day = static_cast<std::uint32_t>(aDay + kDayBias) & ((1U << kDayBits) - 1);
+    return static_cast<std::uint64_t>(aPayerId) << (kDayBits + kCurrencyBits) |
+           static_cast<std::uint64_t>(day) << kCurrencyBits | static_cast<std::uint16_t>(aCurrency);
+}
+
+std::uint64_t HashKey(std::uint64_t aKey) {
+    aKey ^= aKey >> 33;
+    aKey *= 0xFF51AFD7ED558CCDULL;
+    aKey ^= aKey >> 33;
+    return aKey;
+}
+
+/*
+    Open-addressing table from packed key to group row; linear probing over two flat
+    arrays. Sized once for the worst case of one group per transaction, so it never grows.
+*/
+class GroupTable {
+  public:
+    explicit GroupTable(std::size_t aMaxGroups)
+        : mKeys(std::bit_ceil(std::max<std::size_t>(aMaxGroups * 2, 16)), kEmptySlot),
+          mRows(mKeys.size()), mMask(mKeys.size() - 1) {}
+
+    // Row of aKey; a new key gets aNextRow, reported through aInserted.
+    std::uint32_t findOrInsert(std::uint64_t aKey, std::uint32_t aNextRow, bool& aInserted) {
+        for (auto slot = static_cast<std::size_t>(HashKey(aKey)) & mMask;;
+             slot = (slot + 1) & mMask) {
+            if (mKeys[slot] == aKey) {
+                aInserted = false;
+                return mRows[slot];
+            }
+            if (mKeys[slot] == kEmptySlot) {
+                mKeys[slot] = aKey;
+                mRows[slot] = aNextRow;
+                aInserted = true;
+                return aNextRow;
+            }
+        }
+    }
+
+  private:
+    std::vector<std::uint64_t> mKeys;
+    std::vector<std::uint32_t> mRows;
+    std::size_t mMask;
+};
+
+// One row per group; amounts live in their own arrays for the final reductions.
+struct GroupColumns {
+    std::vector<std::uint32_t> mInstruments;
+    std::vector<std::int32_t> mDays;
+    std::vector<Currency> mCurrencies;
+    std::vector<Money> mGross;
+    std::vector<Money> mTaxPaid;
+    std::vector<std::uint32_t> mCounts;
+};
+
+DividendAggregation Aggregate(std::span<const DividendInstrument> aInstruments,
+                              std::span<const TransactionSpan> aTransactions) {
+    std::size_t transactionCount = 0;
+    for (const auto transactions : aTransactions) {
+        transactionCount += transactions.size();
+    }
+
+    GroupTable table{transactionCount};
+    GroupColumns columns;
+    columns.mInstruments.reserve(transactionCount);
+    columns.mDays.reserve(transactionCount);
+    columns.mCurrencies.reserve(transactionCount);
+    columns.mGross.reserve(transactionCount);
+    columns.mTaxPaid.reserve(transactionCount);
+    columns.mCounts.reserve(transactionCount);
+
+    // The same payer may appear in several instruments (e.g. unmerged inputs).
+    std::unordered_map<std::string_view, std::uint32_t> payerIds;
+
+    for (std::uint32_t index = 0; index < aInstruments.size(); ++index) {
+        const auto& instrument = aInstruments[index];
+        const auto [payer, added] =
+            payerIds.try_emplace(instrument.mIsin, static_cast<std::uint32_t>(payerIds.size()));
+        if (payer->second > kMaxPayerId) {
+            LOG_ERROR("Too many dividend payers to aggregate; skipping {}", instrument.mIsin);
+            continue;
+        }
+
+        for (const auto& transaction : aTransactions[index]) {
+            const auto day = DaySerial(transaction.mDate);
+            const auto nextRow = static_cast<std::uint32_t>(columns.mGross.size());
+
+            bool inserted = false;
+            const auto row =
+                table.findOrInsert(PackKey(payer->second, day, transaction.mCurrency), nextRow,
+                                   inserted);
+            if (inserted) {
+                columns.mInstruments.push_back(index);
+                columns.mDays.push_back(day);
+                columns.mCurrencies.push_back(transaction.mCurrency);
+                columns.mGross.push_back(0);
+                columns.mTaxPaid.push_back(0);
+                columns.mCounts.push_back(0);
+            }
+            columns.mGross[row] += transaction.mGrossAmount;
+            columns.mTaxPaid[row] += transaction.mTaxPaid;
+            ++columns.mCounts[row];
+        }
+    }
+
+    // Groups left in another currency (no FX rate) are kept apart and out of the EUR totals.
+    DividendAggregation aggregation;
+    const bool allEur = std::all_of(columns.mCurrencies.begin(), columns.mCurrencies.end(),
+                                    [](Currency aCurrency) { return aCurrency == Currency::EUR; });
+    if (allEur) {
+        aggregation.mGrossTotal = SumMoney(columns.mGross);
+        aggregation.mTaxPaidTotal = SumMoney(columns.mTaxPaid);
+    } else {
+        for (std::size_t row = 0; row < columns.mCurrencies.size(); ++row) {
+            if (columns.mCurrencies[row] != Currency::EUR) {
+                LOG_WARN("Dividends of {} on day {} are not in EUR; left out of the totals",
+                         aInstruments[columns.mInstruments[row]].mIsin, columns.mDays[row]);
+                continue;
+            }
+            aggregation.mGrossTotal += columns.mGross[row];
+            aggregation.mTaxPaidTotal += columns.mTaxPaid[row];
+        }
+    }
+
+    std::vector<std::uint32_t> order(columns.mGross.size());
+    std::iota(order.begin(), order.end(), 0U);
+    std::sort(order.begin(), order.end(), [&](std::uint32_t aLeft, std::uint32_t aRight) {
+        const auto& leftIsin = aInstruments[columns.mInstruments[aLeft]].mIsin;
+        const auto& rightIsin = aInstruments[columns.mInstruments[aRight]].mIsin;
+        if (leftIsin != rightIsin) {
+            return leftIsin < rightIsin;
+        }
+        if (columns.mDays[aLeft] != columns.mDays[aRight]) {
+            return columns.mDays[aLeft] < columns.mDays[aRight];
+        }
+        return columns.mCurrencies[aLeft] < columns.mCurrencies[aRight];
+    });
+
+    aggregation.mGroups.reserve(order.size());
+    for (const auto row : order) {
+        const auto& instrument = aInstruments[columns.mInstruments[row]];
+        aggregation.mGroups.push_back(
+            DividendGroup{instrument.mIsin, instrument.mName, Date{DayDuration{columns.mDays[row]}},
+                          std::string{SourceCountryOf(instrument.mIsin)}, columns.mCurrencies[row],
+                          columns.mGross[row], columns.mTaxPaid[row], columns.mCounts[row]});
+    }
+
+    return aggregation;
+}
+
+} // namespace
+
+namespace taxbroker {
+
+Money SumMoney(std::span<const Money> aValues) noexcept {
+    Money total = 0;
+    for (const Money value : aValues) {
+        total += value;
+    }
+    return total;
+}
+
+DividendAggregation AggregateDividends(std::span<const DividendInstrument> aInstruments) {
+    std::vector<TransactionSpan> transactions;
+    transactions.reserve(aInstruments.size());
+    for (const auto& instrument : aInstruments) {
+        transactions.emplace_back(instrument.mTransactions);
+    }
+    return Aggregate(aInstruments, transactions);
+}
+
+DividendAggregation AggregateDividends(std::span<const DividendInstrument> aInstruments,
+                                       int aTaxYear) {
+    std::vector<YearIndex> years;
+    years.reserve(aInstruments.size());
+    for (const auto& instrument : aInstruments) {
+        years.emplace_back(TransactionSpan{instrument.mTransactions});
+    }
+    return AggregateDividends(aInstruments, years, aTaxYear);
+}
+
+DividendAggregation AggregateDividends(std::span<const DividendInstrument> aInstruments,
+                                       std::span<const YearIndex> aYears, int aTaxYear) {
+    std::vector<TransactionSpan> transactions;
+    transactions.reserve(aInstruments.size());
+    for (std::size_t index = 0; index < aInstruments.size(); ++index) {
+        const TransactionSpan all{aInstruments[index].mTransactions};
+        const auto year = aYears[index].range(aTaxYear);
+        transactions.push_back(all.subspan(year.mBegin, year.mEnd - year.mBegin));
+    }
+    return Aggregate(aInstruments, transactions);
+}
+
+} // namespace taxbroker
@@ -0,0 +1,295 @@
+#include "processors/fifo_matcher.hpp"
+
+#include "utils/date_utils.hpp"
+#include "utils/logger.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+using taxbroker::FifoRing;
+using taxbroker::LotPart;
+using taxbroker::LotRing;
+using taxbroker::OpenLot;
+using taxbroker::TradeTransaction;
+using taxbroker::Units;
+
+/*
+    Original buys behind compacted lots, in FIFO order. Consuming N units from the
+    front lot consumes the same N units from the front parts, which yields exactly
+    the slices an uncompacted run would have produced. Equal-sized buys with
+    consecutive indices in one lot share a part, so savings plans stay small.
+*/
+class LotProvenance {
+  public:
+    // aSameLot: the buy was merged into the lot of the previous buy.
+    void append(std::uint32_t aTransactionIndex, Units aUnits, bool aSameLot) {
+        if (aSameLot && !mParts.empty()) {
+            auto& last = mParts.back();
+            if (last.mUnits == aUnits &&
+                last.mTransactionIndex + last.mCount == aTransactionIndex) {
+                ++last.mCount;
+                return;
+            }
+        }
+        mParts.pushBack(LotPart{aTransactionIndex, aUnits, 1});
+    }
+
+    // Seeds a lot restored from a snapshot; only the front lot can be partially consumed.
+    void appendResumed(const OpenLot& aLot) {
+        if (mParts.empty()) {
+            mHeadConsumed = aLot.mConsumed;
+        }
+        append(aLot.mTransactionIndex, aLot.mUnits, false);
+    }
+
+    // Calls aEmit(transactionIndex, units) for every original buy covering aUnits.
+    template <typename Emit>
+    void consume(Units aUnits, Emit&& aEmit) {
+        while (aUnits > 0) {
+            auto& part = mParts.front();
+            const Units taken = std::min(aUnits, part.mUnits - mHeadConsumed);
+            aEmit(part.mTransactionIndex, taken);
+            aUnits -= taken;
+            mHeadConsumed += taken;
+            if (mHeadConsumed == part.mUnits) {
+                mHeadConsumed = 0;
+                if (--part.mCount == 0) {
+                    mParts.popFront();
+                } else {
+                    ++part.mTransactionIndex;
+                }
+            }
+        }
+    }
+
+    // Open lots as they would be without compaction.
+    std::vector<OpenLot> expand(const LotRing& aLots) const {
+        std::vector<OpenLot> lots;
+        lots.reserve(mParts.size());
+
+        std::size_t part = 0;
+        std::uint32_t offset = 0; // Buy within mParts[part].
+        Units consumed = mHeadConsumed;
+        for (std::size_t index = 0; index < aLots.size(); ++index) {
+            const auto& lot = aLots[index];
+            for (Units remaining = lot.mUnits - lot.mConsumed; remaining > 0;) {
+                const auto& buys = mParts[part];
+                lots.push_back(OpenLot{lot.mDate, lot.mUnitPrice, buys.mUnits, consumed,
+                                       lot.mCurrency, buys.mTransactionIndex + offset});
+                remaining -= buys.mUnits - consumed;
+                consumed = 0;
+                if (++offset == buys.mCount) {
+                    offset = 0;
+                    ++part;
+                }
+            }
+        }
+        return lots;
+    }
+
+  private:
+    FifoRing<LotPart> mParts;
+    Units mHeadConsumed{}; // Units of the front buy of mParts already matched.
+};
+
+// Chronological processing order; identity when the input is already date-sorted.
+std::vector<std::uint32_t> ChronologicalOrder(const std::vector<TradeTransaction>& aTransactions) {
+    std::vector<std::uint32_t> order(aTransactions.size());
+    std::iota(order.begin(), order.end(), 0U);
+
+    const auto byDate = [](const TradeTransaction& aLeft, const TradeTransaction& aRight) {
+        return aLeft.mDate < aRight.mDate;
+    };
+    if (!std::is_sorted(aTransactions.begin(), aTransactions.end(), byDate)) {
+        std::stable_sort(order.begin(), order.end(),
+                         [&aTransactions](std::uint32_t aLeft, std::uint32_t aRight) {
+                             return aTransactions[aLeft].mDate < aTransactions[aRight].mDate;
+                         });
+    }
+
+    return order;
+}
+
+} // namespace
+
+namespace taxbroker {
+
+InstrumentMatches FifoMatcher::match(const TradeInstrument& aInstrument) const {
+    return matchFrom(aInstrument, nullptr);
+}
+
+InstrumentMatches FifoMatcher::match(const TradeInstrument& aInstrument,
+                                     const OpenLotSnapshot& aResumeFrom) const {
+    return matchFrom(aInstrument, &aResumeFrom);
+}
+
+InstrumentMatches FifoMatcher::matchFrom(const TradeInstrument& aInstrument,
+                                         const OpenLotSnapshot* aResumeFrom) const {
+    InstrumentMatches result;
+    result.mIsin = aInstrument.mIsin;
+    result.mName = aInstrument.mName;
+
+    const auto& transactions = aInstrument.mTransactions;
+    const bool compact = mOptions.mCompactLots;
+    LotRing lots;
+    LotProvenance provenance;
+    const auto openLots = [&]() { return compact ? provenance.expand(lots) : lots.toVector(); };
+    std::uint32_t indexBase = 0;
+    Date resumeBoundary = Date::min();
+
+    if (aResumeFrom != nullptr) {
+        indexBase = aResumeFrom->mNextTransactionIndex;
+        resumeBoundary = MakeDate(aResumeFrom->mYear, 12, 31);
+        lots.reserve(aResumeFrom->mOpenLots.size());
+        for (const auto& lot : aResumeFrom->mOpenLots) {
+            lots.pushBack(lot);
+            if (compact) {
+                provenance.appendResumed(lot);
+            }
+        }
+    }
+
+    // Year-end bookkeeping; only the first transaction of each new year pays for a YearOf.
+    int currentYear = std::numeric_limits<int>::min();
+    Date currentYearEnd = Date::min();
+    std::uint32_t processedCount = 0;
+    bool previousWasBuy = false; // Only directly consecutive buys may share a lot.
+    const auto emitSnapshot = [&]() {
+        if (mOptions.mEmitYearEndSnapshots && currentYear != std::numeric_limits<int>::min()) {
+            result.mYearEndSnapshots.push_back(OpenLotSnapshot{
+                aInstrument.mIsin, currentYear, indexBase + processedCount, openLots()});
+        }
+    };
+
+    for (const auto localIndex : ChronologicalOrder(transactions)) {
+        const auto& transaction = transactions[localIndex];
+        const std::uint32_t transactionIndex = indexBase + localIndex;
+
+        if (transaction.mDate <= resumeBoundary) {
+            LOG_WARN("Skipping transaction {} of {} already covered by the {} snapshot",
+                     transactionIndex, aInstrument.mIsin, aResumeFrom->mYear);
+            ++processedCount;
+            continue;
+        }
+
+        if (transaction.mDate > currentYearEnd) {
+            emitSnapshot();
+            currentYear = YearOf(transaction.mDate);
+            currentYearEnd = MakeDate(currentYear, 12, 31);
+        }
+        ++processedCount;
+
+        if (transaction.mUnits <= 0) {
+            continue;
+        }
+
+        if (transaction.mTradeSide == TradeSide::Buy) {
+            const bool sameLot = compact && previousWasBuy &&
+                                 lots.back().mDate == transaction.mDate &&
+                                 lots.back().mUnitPrice == transaction.mUnitPrice &&
+                                 lots.back().mCurrency == transaction.mCurrency;
+            if (compact) {
+                provenance.append(transactionIndex, transaction.mUnits, sameLot);
+            }
+            if (sameLot) {
+                lots.back().mUnits += transaction.mUnits;
+            } else {
+                lots.pushBack(OpenLot{transaction.mDate, transaction.mUnitPrice,
+                                      transaction.mUnits, 0, transaction.mCurrency,
+                                      transactionIndex});
+            }
+            previousWasBuy = true;
+            continue;
+        }
+        previousWasBuy = false;
+
+        Units remaining = transaction.mUnits;
+        while (remaining > 0 && !lots.empty()) {
+            auto& lot = lots.front();
+            const Units taken = std::min(remaining, lot.mUnits - lot.mConsumed);
+
+            const auto emit = [&](std::uint32_t aBuyIndex, Units aUnits) {
+                result.mMatches.push_back(LotMatch{transactionIndex, aBuyIndex, lot.mDate,
+                                                   transaction.mDate, lot.mUnitPrice,
+                                                   transaction.mUnitPrice, aUnits,
+                                                   lot.mCurrency, transaction.mCurrency});
+            };
+            if (compact) {
+                provenance.consume(taken, emit);
+            } else {
+                emit(lot.mTransactionIndex, taken);
+            }
+
+            lot.mConsumed += taken;
+            remaining -= taken;
+            if (lot.mConsumed == lot.mUnits) {
+                lots.popFront();
+            }
+        }
+
+        if (remaining > 0) {
+            LOG_WARN("Sell of {} on transaction {} exceeds open lots by {} units",
+                     aInstrument.mIsin, transactionIndex, remaining);
+            result.mUnmatchedSellUnits += remaining;
+        }
+    }
+    emitSnapshot();
+
+    result.mOpenLots = openLots();
+    if (mOptions.mAuditLog != nullptr && aResumeFrom != nullptr) {
+        mOptions.mAuditLog->extend(mOptions.mAuditScope, result.mIsin, result.mMatches);
+    } else if (mOptions.mAuditLog != nullptr) {
+        mOptions.mAuditLog->record(mOptions.mAuditScope, result.mIsin, result.mMatches);
+    }
+    return result;
+}
+
+std::vector<InstrumentMatches>
+FifoMatcher::matchAll(std::span<const TradeInstrument> aInstruments, ThreadPool& aPool,
+                      std::span<const OpenLotSnapshot> aResumeFrom) const {
+    std::unordered_map<std::string_view, const OpenLotSnapshot*> latestSnapshots;
+    for (const auto& snapshot : aResumeFrom) {
+        auto& latest = latestSnapshots[snapshot.mIsin];
+        if (latest == nullptr || latest->mYear < snapshot.mYear) {
+            latest = &snapshot;
+        }
+    }
+
+    std::vector<std::size_t> schedule(aInstruments.size());
+    std::iota(schedule.begin(), schedule.end(), std::size_t{0});
+    std::stable_sort(schedule.begin(), schedule.end(),
+                     [&aInstruments](std::size_t aLeft, std::size_t aRight) {
+                         return aInstruments[aLeft].mTransactions.size() >
+                                aInstruments[aRight].mTransactions.size();
+                     });
+
+    std::vector<InstrumentMatches> results(aInstruments.size());
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(schedule.size());
+    for (const auto instrumentIndex : schedule) {
+        const auto& instrument = aInstruments[instrumentIndex];
+        const auto snapshot = latestSnapshots.find(instrument.mIsin);
+        const OpenLotSnapshot* resumeFrom =
+            snapshot != latestSnapshots.end() ? snapshot->second : nullptr;
+
+        pending.push_back(
+            aPool.submit([this, &instrument, &results, instrumentIndex, resumeFrom]() {
+                results[instrumentIndex] = matchFrom(instrument, resumeFrom);
+            }));
+    }
+
+    // Every task writes into results and reads the snapshots; none may outlive them.
+    aPool.awaitAll(std::span{pending});
+
+    return results;
+}
+
+} // namespace taxbroker
@@ -0,0 +1,160 @@
+#include "processors/fx_normalizer.hpp"
+
+#include "utils/logger.hpp"
+#include "utils/numeric_util.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace {
+
+using taxbroker::Currency;
+using taxbroker::Date;
+using taxbroker::ProcessingWarning;
+using taxbroker::ProcessingWarningCode;
+
+const char* CurrencyName(Currency aCurrency) {
+    switch (aCurrency) {
+    case Currency::EUR:
+        return "EUR";
+    case Currency::USD:
+        return "USD";
+    case Currency::GBP:
+        return "GBP";
+    case Currency::CHF:
+        return "CHF";
+    case Currency::Unknown:
+        return "Unknown";
+    }
+    return "Unknown";
+}
+
+void AddMissingRateWarning(std::vector<ProcessingWarning>& aWarnings, const std::string& aIsin,
+                           Currency aCurrency, Date aDate) {
+    const auto days = aDate.time_since_epoch().count();
+    LOG_WARN("No {} rate for {} (day {}); amount kept in original currency",
+             CurrencyName(aCurrency), aIsin, days);
+    aWarnings.push_back(ProcessingWarning{
+        ProcessingWarningCode::MissingFxRate, aIsin,
+        std::string{"No EUR rate for "} + CurrencyName(aCurrency) + " on day " +
+            std::to_string(days)});
+}
+
+} // namespace
+
+namespace taxbroker {
+
+void FxRateTable::addRate(Currency aCurrency, Date aDate, FxRate aRate) {
+    auto& fixings = mFixings[static_cast<std::size_t>(aCurrency)];
+    const auto byDate = [](const Fixing& aFixing, Date aValue) { return aFixing.mDate < aValue; };
+
+    if (fixings.empty() || fixings.back().mDate < aDate) {
+        fixings.push_back(Fixing{aDate, aRate});
+        return;
+    }
+
+    const auto position = std::lower_bound(fixings.begin(), fixings.end(), aDate, byDate);
+    if (position != fixings.end() && position->mDate == aDate) {
+        position->mRate = aRate;
+        return;
+    }
+    fixings.insert(position, Fixing{aDate, aRate});
+}
+
+std::optional<FxRate> FxRateTable::rateOn(Currency aCurrency, Date aDate) const {
+    if (aCurrency == Currency::EUR) {
+        return FX_RATE_SCALE;
+    }
+
+    const auto& fixings = mFixings[static_cast<std::size_t>(aCurrency)];
+    const auto firstLater =
+        std::upper_bound(fixings.begin(), fixings.end(), aDate,
+                         [](Date aValue, const Fixing& aFixing) { return aValue < aFixing.mDate; });
+    if (firstLater == fixings.begin()) {
+        return std::nullopt;
+    }
+
+    return std::prev(firstLater)->mRate;
+}
+
+std::optional<Money> ConvertToEur(const FxRateTable& aRates, Currency aCurrency, Date aDate,
+                                  Money aAmount) {
+    if (aCurrency == Currency::EUR) {
+        return aAmount;
+    }
+
+    const auto rate = aRates.rateOn(aCurrency, aDate);
+    if (!rate || *rate <= 0) {
+        return std::nullopt;
+    }
+
+    return mulDivRounded(aAmount, FX_RATE_SCALE, *rate);
+}
+
+void NormalizeToEur(TradeInstrument& aInstrument, const FxRateTable& aRates,
+                    std::vector<ProcessingWarning>& aWarnings) {
+    for (auto& transaction : aInstrument.mTransactions) {
+        if (transaction.mCurrency == Currency::EUR) {
+            continue;
+        }
+
+        const auto price = ConvertToEur(aRates, transaction.mCurrency, transaction.mDate,
+                                        transaction.mUnitPrice);
+        if (!price) {
+            AddMissingRateWarning(aWarnings, aInstrument.mIsin, transaction.mCurrency,
+                                  transaction.mDate);
+            continue;
+        }
+
+        transaction.mUnitPrice = *price;
+        transaction.mCurrency = Currency::EUR;
+    }
+}
+
+void NormalizeToEur(DividendInstrument& aInstrument, const FxRateTable& aRates,
+                    std::vector<ProcessingWarning>& aWarnings) {
+    for (auto& transaction : aInstrument.mTransactions) {
+        if (transaction.mCurrency == Currency::EUR) {
+            continue;
+        }
+
+        const auto gross = ConvertToEur(aRates, transaction.mCurrency, transaction.mDate,
+                                        transaction.mGrossAmount);
+        const auto tax =
+            ConvertToEur(aRates, transaction.mCurrency, transaction.mDate, transaction.mTaxPaid);
+        if (!gross || !tax) {
+            AddMissingRateWarning(aWarnings, aInstrument.mIsin, transaction.mCurrency,
+                                  transaction.mDate);
+            continue;
+        }
+
+        transaction.mGrossAmount = *gross;
+        transaction.mTaxPaid = *tax;
+        transaction.mCurrency = Currency::EUR;
+    }
+}
+
+void NormalizeToEur(std::vector<InterestTransaction>& aTransactions, const FxRateTable& aRates,
+                    std::vector<ProcessingWarning>& aWarnings) {
+    for (auto& transaction : aTransactions) {
+        if (transaction.mCurrency == Currency::EUR) {
+            continue;
+        }
+
+        const auto gross = ConvertToEur(aRates, transaction.mCurrency, transaction.mDate,
+                                        transaction.mGrossAmount);
+        const auto tax =
+            ConvertToEur(aRates, transaction.mCurrency, transaction.mDate, transaction.mTaxPaid);
+        if (!gross || !tax) {
+            AddMissingRateWarning(aWarnings, std::string{}, transaction.mCurrency,
+                                  transaction.mDate);
+            continue;
+        }
+
+        transaction.mGrossAmount = *gross;
+        transaction.mTaxPaid = *tax;
+        transaction.mCurrency = Currency::EUR;
+    }
+}
+
+} // namespace taxbroker
@@ -0,0 +1,512 @@
+#include "processors/report_processor.hpp"
+
+#include "core/year_index.hpp"
+#include "processors/corporate_actions.hpp"
+#include "processors/tax_cache.hpp"
+#include "utils/bounded_queue.hpp"
+#include "utils/date_utils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <future>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+using taxbroker::BoundedQueue;
+using taxbroker::ContentHash;
+using taxbroker::Date;
+using taxbroker::FifoMatcher;
+using taxbroker::FifoMatcherOptions;
+using taxbroker::FinalReport;
+using taxbroker::InstrumentMatches;
+using taxbroker::InstrumentReport;
+using taxbroker::InstrumentTaxResult;
+using taxbroker::LotMatch;
+using taxbroker::MakeDate;
+using taxbroker::OpenLot;
+using taxbroker::ParseResult;
+using taxbroker::ProcessingWarning;
+using taxbroker::ProcessingWarningCode;
+using taxbroker::ReportOptions;
+using taxbroker::SortByDate;
+using taxbroker::TaxProcessor;
+using taxbroker::TradeInstrument;
+using taxbroker::Units;
+using taxbroker::YearIndex;
+
+// Unit of work flowing through the stages; mOrder restores the input order at the end.
+struct InstrumentJob {
+    std::size_t mOrder{};
+    TradeInstrument mInstrument;
+    YearIndex mYears; // Of the input transactions; dates survive FX and corporate actions.
+    std::vector<InstrumentReport> mReports; // One per tax year of the range.
+    std::vector<ProcessingWarning> mWarnings;
+    std::vector<ContentHash> mCacheKeys; // One per tax year when a cache is configured.
+    bool mReportReady{false}; // Restored from cache or nothing to report; later stages skip.
+};
+
+using JobQueue = BoundedQueue<InstrumentJob>;
+
+// mLastTaxYear before mTaxYear (e.g. unset) means a single year.
+int LastTaxYear(const ReportOptions& aOptions) {
+    return std::max(aOptions.mLastTaxYear, aOptions.mTaxYear);
+}
+
+std::size_t YearCount(const ReportOptions& aOptions) {
+    return static_cast<std::size_t>(LastTaxYear(aOptions) - aOptions.mTaxYear) + 1;
+}
+
+InstrumentJob MakeJob(std::size_t aOrder, TradeInstrument aInstrument) {
+    InstrumentJob job;
+    job.mOrder = aOrder;
+    job.mInstrument = std::move(aInstrument);
+    SortByDate(job.mInstrument.mTransactions);
+    job.mYears = YearIndex{job.mInstrument.mTransactions};
+    job.mReports.resize(1);
+    return job;
+}
+
+void AddUnmatchedSellWarning(InstrumentJob& aJob, Units aUnmatchedSellUnits) {
+    if (aUnmatchedSellUnits > 0) {
+        aJob.mWarnings.push_back(ProcessingWarning{
+            ProcessingWarningCode::UnmatchedSell, aJob.mInstrument.mIsin,
+            "Sold units exceed open lots by " + std::to_string(aUnmatchedSellUnits) +
+                " (1e-8 units)"});
+    }
+}
+
+/*
+    Splits full-history matches into one report per tax year: the matches of that
+    year's sales and the open lots at that year's end. Those come from the year-end
+    snapshots, or without snapshots (history ends within the range) from the final
+    open lots. Unmatched sell units describe the whole history and go to every year,
+    so each cached year reproduces them whichever range computed it.
+*/
+std::vector<InstrumentReport> SplitByYear(InstrumentMatches aMatches,
+                                          std::vector<InstrumentTaxResult> aTaxes) {
+    std::vector<InstrumentReport> reports(aTaxes.size());
+    const int firstYear = aTaxes.front().mTaxYear;
+    for (std::size_t slot = 0; slot < reports.size(); ++slot) {
+        reports[slot].mMatches.mIsin = aMatches.mIsin;
+        reports[slot].mMatches.mName = aMatches.mName;
+        reports[slot].mTax = std::move(aTaxes[slot]);
+        reports[slot].mMatches.mUnmatchedSellUnits = aMatches.mUnmatchedSellUnits;
+    }
+
+    // Matches are in sell order, so every year is one contiguous run.
+    std::size_t slot = 0;
+    Date nextYearBegin = MakeDate(firstYear + 1, 1, 1);
+    const Date rangeBegin = MakeDate(firstYear, 1, 1);
+    for (const auto& match : aMatches.mMatches) {
+        if (match.mSellDate < rangeBegin) {
+            continue;
+        }
+        while (slot < reports.size() && match.mSellDate >= nextYearBegin) {
+            ++slot;
+            nextYearBegin = MakeDate(firstYear + static_cast<int>(slot) + 1, 1, 1);
+        }
+        if (slot == reports.size()) {
+            break;
+        }
+        reports[slot].mMatches.mMatches.push_back(match);
+    }
+
+    if (aMatches.mYearEndSnapshots.empty()) {
+        reports.back().mMatches.mOpenLots = std::move(aMatches.mOpenLots);
+        return reports;
+    }
+
+    // Snapshots exist for years with activity; quiet years inherit the previous one.
+    const auto& snapshots = aMatches.mYearEndSnapshots;
+    std::size_t next = 0;
+    const std::vector<OpenLot>* openLots = nullptr;
+    for (slot = 0; slot < reports.size(); ++slot) {
+        const int year = firstYear + static_cast<int>(slot);
+        while (next < snapshots.size() && snapshots[next].mYear <= year) {
+            openLots = &snapshots[next++].mOpenLots;
+        }
+        if (openLots != nullptr) {
+            reports[slot].mMatches.mOpenLots = *openLots;
+        }
+    }
+
+    return reports;
+}
+
+// Keys are taken after FX normalization, so changed rates invalidate the entries too.
+void CacheLookup(InstrumentJob& aJob, const ReportOptions& aOptions) {
+    if (aOptions.mCache == nullptr) {
+        return;
+    }
+
+    // Served from the cache only when every year of the range is cached.
+    aJob.mCacheKeys = MakeTaxCacheKeys(aJob.mInstrument, aOptions.mTaxYear, LastTaxYear(aOptions));
+    std::vector<InstrumentReport> reports;
+    reports.reserve(aJob.mCacheKeys.size());
+    for (const auto& key : aJob.mCacheKeys) {
+        const auto cached = aOptions.mCache->find(key);
+        if (cached == nullptr) {
+            return;
+        }
+        reports.push_back(*cached);
+    }
+
+    aJob.mReports = std::move(reports);
+    aJob.mReportReady = true;
+    AddUnmatchedSellWarning(aJob, aJob.mReports.front().mMatches.mUnmatchedSellUnits);
+    aJob.mInstrument.mTransactions = {};
+}
+
+void NormalizeStage(InstrumentJob& aJob, const ReportOptions& aOptions) {
+    if (aOptions.mFxRates != nullptr) {
+        NormalizeToEur(aJob.mInstrument, *aOptions.mFxRates, aJob.mWarnings);
+    }
+    CacheLookup(aJob, aOptions);
+}
+
+void CorporateActionStage(InstrumentJob& aJob) {
+    if (aJob.mReportReady || aJob.mInstrument.mCorporateActions.empty()) {
+        return;
+    }
+
+    // The job owns a working copy; dropping the actions keeps restatement one-shot.
+    aJob.mInstrument.mTransactions = RestateTransactions(aJob.mInstrument);
+    aJob.mInstrument.mCorporateActions.clear();
+}
+
+void FifoStage(InstrumentJob& aJob, const ReportOptions& aOptions) {
+    if (aJob.mReportReady) {
+        return;
+    }
+
+    // Without a sale in the tax years there is nothing to report; skip FIFO and tax.
+    const std::size_t yearCount = YearCount(aOptions);
+    bool hasSells = false;
+    for (std::size_t slot = 0; slot < yearCount; ++slot) {
+        hasSells = hasSells || aJob.mYears.hasSells(aOptions.mTaxYear + static_cast<int>(slot));
+    }
+
+    if (!hasSells) {
+        aJob.mReports.resize(yearCount);
+        for (std::size_t slot = 0; slot < yearCount; ++slot) {
+            auto& report = aJob.mReports[slot];
+            report.mMatches.mIsin = report.mTax.mIsin = aJob.mInstrument.mIsin;
+            report.mMatches.mName = report.mTax.mName = aJob.mInstrument.mName;
+            report.mTax.mTaxYear = aOptions.mTaxYear + static_cast<int>(slot);
+        }
+        aJob.mReportReady = true;
+        aJob.mInstrument.mTransactions = {};
+        return;
+    }
+
+    // Open lots are reported as of each year end; the final ones only serve when the
+    // history ends with the range's only year.
+    const bool needSnapshots = yearCount > 1 || aJob.mYears.lastYear() > LastTaxYear(aOptions);
+    // Provenance is recorded per reported year by TaxStage, so not by the matcher.
+    const FifoMatcherOptions matcherOptions{needSnapshots, aOptions.mCompactLots, nullptr};
+    auto& matches = aJob.mReports.front().mMatches;
+    matches = FifoMatcher{matcherOptions}.match(aJob.mInstrument);
+    AddUnmatchedSellWarning(aJob, matches.mUnmatchedSellUnits);
+
+    // Matching is done; the transactions are no longer needed downstream.
+    aJob.mInstrument.mTransactions = {};
+}
+
+// Replaces the instrument's audit entries with the sales of the reported years.
+void RecordAudit(const InstrumentJob& aJob, const ReportOptions& aOptions) {
+    if (aOptions.mAuditLog == nullptr) {
+        return;
+    }
+
+    std::vector<LotMatch> matches;
+    for (const auto& report : aJob.mReports) {
+        matches.insert(matches.end(), report.mMatches.mMatches.begin(),
+                       report.mMatches.mMatches.end());
+    }
+    aOptions.mAuditLog->record(aOptions.mAuditScope, aJob.mInstrument.mIsin, matches);
+}
+
+void TaxStage(InstrumentJob& aJob, const ReportOptions& aOptions) {
+    if (aJob.mReportReady) {
+        RecordAudit(aJob, aOptions);
+        return;
+    }
+
+    auto& matches = aJob.mReports.front().mMatches;
+    const TaxProcessor processor{aOptions.mTaxYear, LastTaxYear(aOptions)};
+    auto taxes = processor.processYears(matches);
+    aJob.mReports = SplitByYear(std::move(matches), std::move(taxes));
+
+    if (aOptions.mCache != nullptr) {
+        for (std::size_t slot = 0; slot < aJob.mCacheKeys.size(); ++slot) {
+            aOptions.mCache->insert(aJob.mCacheKeys[slot], aJob.mReports[slot]);
+        }
+    }
+    RecordAudit(aJob, aOptions);
+}
+
+void RunAllStages(InstrumentJob& aJob, const ReportOptions& aOptions) {
+    NormalizeStage(aJob, aOptions);
+    CorporateActionStage(aJob);
+    FifoStage(aJob, aOptions);
+    TaxStage(aJob, aOptions);
+}
+
+/*
+    Moves jobs from aInput through aStage into aOutput until aInput is drained.
+    Failures close both queues so neighbouring stages unblock and wind down.
+*/
+template <typename Stage>
+void RunStage(JobQueue& aInput, JobQueue& aOutput, Stage aStage) {
+    try {
+        while (auto job = aInput.pop()) {
+            aStage(*job);
+            if (!aOutput.push(std::move(*job))) {
+                aInput.close();
+                break;
+            }
+        }
+    } catch (...) {
+        aInput.close();
+        aOutput.close();
+        throw;
+    }
+    aOutput.close();
+}
+
+// Merges instruments of several files by ISIN, keeping first-seen order.
+ParseResult MergeParseResults(std::vector<ParseResult> aResults) {
+    ParseResult merged;
+    std::unordered_map<std::string, std::size_t> tradeIndex;
+    std::unordered_map<std::string, std::size_t> dividendIndex;
+
+    for (auto& result : aResults) {
+        auto& statement = result.mStatement;
+
+        for (auto& instrument : statement.mTradeInstruments) {
+            const auto [position, inserted] = tradeIndex.try_emplace(
+                instrument.mIsin, merged.mStatement.mTradeInstruments.size());
+            if (inserted) {
+                merged.mStatement.mTradeInstruments.push_back(std::move(instrument));
+                continue;
+            }
+
+            auto& target = merged.mStatement.mTradeInstruments[position->second];
+            target.mTransactions.insert(target.mTransactions.end(),
+                                        instrument.mTransactions.begin(),
+                                        instrument.mTransactions.end());
+            target.mCorporateActions.insert(target.mCorporateActions.end(),
+                                            instrument.mCorporateActions.begin(),
+                                            instrument.mCorporateActions.end());
+        }
+
+        for (auto& instrument : statement.mDividendInstruments) {
+            const auto [position, inserted] = dividendIndex.try_emplace(
+                instrument.mIsin, merged.mStatement.mDividendInstruments.size());
+            if (inserted) {
+                merged.mStatement.mDividendInstruments.push_back(std::move(instrument));
+                continue;
+            }
+
+            auto& target = merged.mStatement.mDividendInstruments[position->second];
+            target.mTransactions.insert(target.mTransactions.end(),
+                                        instrument.mTransactions.begin(),
+                                        instrument.mTransactions.end());
+        }
+
+        merged.mStatement.mInterestTransactions.insert(
+            merged.mStatement.mInterestTransactions.end(),
+            statement.mInterestTransactions.begin(), statement.mInterestTransactions.end());
+        merged.mWarnings.insert(merged.mWarnings.end(), result.mWarnings.begin(),
+                                result.mWarnings.end());
+    }
+
+    return merged;
+}
+
+/*
+    Runs every stage on a thread owned by this call rather than on the shared pool:
+    the stages block on their queues for the whole run, so queued pool work, or a
+    caller that is itself a pool task, could otherwise starve them.
+*/
+void RunPipelined(std::vector<TradeInstrument>& aInstruments, const ReportOptions& aOptions,
+                  std::vector<InstrumentJob>& aCompleted) {
+    constexpr std::size_t kStageCount = taxbroker::ReportProcessor::PIPELINE_STAGE_COUNT;
+
+    JobQueue parsed{aOptions.mQueueCapacity};
+    JobQueue normalized{aOptions.mQueueCapacity};
+    JobQueue restated{aOptions.mQueueCapacity};
+    JobQueue matched{aOptions.mQueueCapacity};
+    JobQueue taxed{aOptions.mQueueCapacity};
+    const std::array<JobQueue*, kStageCount> queues{&parsed, &normalized, &restated, &matched,
+                                                     &taxed};
+
+    std::array<std::exception_ptr, kStageCount> failures;
+    // Declared after the queues, so the threads are joined before those are destroyed.
+    std::array<std::jthread, kStageCount> stages;
+    const auto launch = [&stages, &failures](std::size_t aIndex, auto aStage) {
+        auto& failure = failures[aIndex];
+        stages[aIndex] = std::jthread{[&failure, aStage]() mutable {
+            try {
+                aStage();
+            } catch (...) {
+                failure = std::current_exception();
+            }
+        }};
+    };
+
+    try {
+        launch(0, [&aInstruments, &parsed]() {
+            try {
+                for (std::size_t order = 0; order < aInstruments.size(); ++order) {
+                    if (!parsed.push(MakeJob(order, std::move(aInstruments[order])))) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                parsed.close();
+                throw;
+            }
+            parsed.close();
+        });
+        launch(1, [&]() {
+            RunStage(parsed, normalized, [&aOptions](InstrumentJob& aJob) {
+                NormalizeStage(aJob, aOptions);
+            });
+        });
+        launch(2, [&]() { RunStage(normalized, restated, CorporateActionStage); });
+        launch(3, [&]() {
+            RunStage(restated, matched,
+                     [&aOptions](InstrumentJob& aJob) { FifoStage(aJob, aOptions); });
+        });
+        launch(4, [&]() {
+            RunStage(matched, taxed,
+                     [&aOptions](InstrumentJob& aJob) { TaxStage(aJob, aOptions); });
+        });
+    } catch (...) {
+        // A thread could not be started; unblock the ones that were.
+        for (auto* queue : queues) {
+            queue->close();
+        }
+        throw;
+    }
+
+    while (auto job = taxed.pop()) {
+        const auto order = job->mOrder;
+        aCompleted[order] = std::move(*job);
+    }
+
+    // Every stage must finish before the queues go out of scope; report the first failure.
+    for (auto& stage : stages) {
+        if (stage.joinable()) {
+            stage.join();
+        }
+    }
+    for (const auto& failure : failures) {
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+}
+
+} // namespace
+
+namespace taxbroker {
+
+ParseResult ReportProcessor::parseAll(std::span<const ReportSource> aSources) {
+    std::vector<std::future<ParseResult>> pending;
+    pending.reserve(aSources.size());
+    for (const auto& source : aSources) {
+        pending.push_back(
+            mPool.submit([&source]() { return source.mParser->parse(source.mPath); }));
+    }
+
+    std::vector<ParseResult> results;
+    results.reserve(pending.size());
+    for (auto& future : pending) {
+        results.push_back(mPool.await(future));
+    }
+
+    return MergeParseResults(std::move(results));
+}
+
+FinalReport ReportProcessor::process(std::span<const ReportSource> aSources,
+                                     const ReportOptions& aOptions) {
+    return process(parseAll(aSources), aOptions);
+}
+
+FinalReport ReportProcessor::process(ParseResult aParsed, const ReportOptions& aOptions) {
+    ReportOptions singleYear = aOptions;
+    singleYear.mLastTaxYear = aOptions.mTaxYear;
+    return std::move(processYears(std::move(aParsed), singleYear).front());
+}
+
+std::vector<FinalReport> ReportProcessor::processYears(std::span<const ReportSource> aSources,
+                                                       const ReportOptions& aOptions) {
+    return processYears(parseAll(aSources), aOptions);
+}
+
+std::vector<FinalReport> ReportProcessor::processYears(ParseResult aParsed,
+                                                       const ReportOptions& aOptions) {
+    std::vector<ProcessingWarning> warnings;
+    auto& dividendInstruments = aParsed.mStatement.mDividendInstruments;
+    auto& interestTransactions = aParsed.mStatement.mInterestTransactions;
+    if (aOptions.mFxRates != nullptr) {
+        for (auto& instrument : dividendInstruments) {
+            NormalizeToEur(instrument, *aOptions.mFxRates, warnings);
+        }
+        NormalizeToEur(interestTransactions, *aOptions.mFxRates, warnings);
+    }
+    // Indexed once; every year's report slices the dividends through the same index.
+    std::vector<YearIndex> dividendYears;
+    dividendYears.reserve(dividendInstruments.size());
+    for (auto& instrument : dividendInstruments) {
+        SortByDate(instrument.mTransactions);
+        dividendYears.emplace_back(std::span<const DividendTransaction>{instrument.mTransactions});
+    }
+
+    auto& instruments = aParsed.mStatement.mTradeInstruments;
+    std::vector<InstrumentJob> completed(instruments.size());
+
+    if (aOptions.mMode == PipelineMode::Pipelined && instruments.size() > 1) {
+        RunPipelined(instruments, aOptions, completed);
+    } else {
+        for (std::size_t order = 0; order < instruments.size(); ++order) {
+            completed[order] = MakeJob(order, std::move(instruments[order]));
+            RunAllStages(completed[order], aOptions);
+        }
+    }
+
+    for (const auto& job : completed) {
+        warnings.insert(warnings.end(), job.mWarnings.begin(), job.mWarnings.end());
+    }
+
+    // Warnings concern the shared input history and are repeated in every year's report.
+    const std::size_t yearCount = YearCount(aOptions);
+    std::vector<FinalReport> reports(yearCount);
+    for (std::size_t slot = 0; slot < yearCount; ++slot) {
+        auto& report = reports[slot];
+        report.mTaxYear = aOptions.mTaxYear + static_cast<int>(slot);
+        report.mDividends = AggregateDividends(dividendInstruments, dividendYears, report.mTaxYear);
+        report.mInstruments.reserve(completed.size());
+        for (auto& job : completed) {
+            report.mInstruments.push_back(std::move(job.mReports[slot]));
+        }
+
+        const bool isLast = slot + 1 == yearCount;
+        report.mParseWarnings = isLast ? std::move(aParsed.mWarnings) : aParsed.mWarnings;
+        report.mWarnings = isLast ? std::move(warnings) : warnings;
+        report.mDividendInstruments =
+            isLast ? std::move(dividendInstruments) : dividendInstruments;
+        report.mInterestTransactions =
+            isLast ? std::move(interestTransactions) : interestTransactions;
+    }
+
+    return reports;
+}
+
+} // namespace taxbroker
@@ -0,0 +1,67 @@
+#include "processors/tax_cache.hpp"
+
+#include "utils/date_utils.hpp"
+
+namespace taxbroker {
+
+std::size_t EstimateFootprint(const InstrumentReport& aReport) {
+    const auto& matches = aReport.mMatches;
+    const auto& tax = aReport.mTax;
+
+    std::size_t bytes = sizeof(InstrumentReport);
+    bytes += matches.mIsin.capacity() + matches.mName.capacity();
+    bytes += tax.mIsin.capacity() + tax.mName.capacity();
+    bytes += matches.mMatches.capacity() * sizeof(matches.mMatches.front());
+    bytes += matches.mOpenLots.capacity() * sizeof(matches.mOpenLots.front());
+    bytes += tax.mSales.capacity() * sizeof(tax.mSales.front());
+    for (const auto& snapshot : matches.mYearEndSnapshots) {
+        bytes += sizeof(snapshot) + snapshot.mIsin.capacity();
+        bytes += snapshot.mOpenLots.capacity() * sizeof(snapshot.mOpenLots.front());
+    }
+    return bytes;
+}
+
+ContentHash MakeTaxCacheKey(const TradeInstrument& aInstrument, int aTaxYear) {
+    return MakeTaxCacheKeys(aInstrument, aTaxYear, aTaxYear).front();
+}
+
+std::vector<ContentHash> MakeTaxCacheKeys(const TradeInstrument& aInstrument, int aFirstTaxYear,
+                                          int aLastTaxYear) {
+    ContentHasher hasher;
+    hasher.add(std::uint64_t{TAX_RULESET_VERSION});
+    hasher.add(aInstrument.mIsin);
+    hasher.add(aInstrument.mName);
+
+    hasher.add(static_cast<std::uint64_t>(aInstrument.mTransactions.size()));
+    for (const auto& transaction : aInstrument.mTransactions) {
+        hasher.add(static_cast<std::int64_t>(DaySerial(transaction.mDate)));
+        hasher.add(static_cast<std::uint64_t>(transaction.mTradeSide));
+        hasher.add(transaction.mUnitPrice);
+        hasher.add(transaction.mUnits);
+        hasher.add(static_cast<std::uint64_t>(transaction.mCurrency));
+    }
+
+    hasher.add(static_cast<std::uint64_t>(aInstrument.mCorporateActions.size()));
+    for (const auto& action : aInstrument.mCorporateActions) {
+        hasher.add(static_cast<std::int64_t>(DaySerial(action.mDate)));
+        hasher.add(static_cast<std::uint64_t>(action.mType));
+        hasher.add(action.mRatio);
+    }
+
+    // The year goes last, so every year's key continues from the same history state.
+    std::vector<ContentHash> keys;
+    for (int year = aFirstTaxYear; year <= aLastTaxYear; ++year) {
+        auto yearHasher = hasher;
+        yearHasher.add(static_cast<std::int64_t>(year));
+        keys.push_back(yearHasher.finish());
+    }
+    return keys;
+}
+
+void TaxResultCache::insert(const ContentHash& aKey, InstrumentReport aReport) {
+    const std::size_t bytes = EstimateFootprint(aReport);
+    LruByteCache::insert(aKey, std::make_shared<const InstrumentReport>(std::move(aReport)),
+                         bytes);
+}
+
+} // namespace taxbroker
@@ -0,0 +1,213 @@
+#include "processors/tax_processor.hpp"
+
+#include "utils/date_utils.hpp"
+#include "utils/numeric_util.hpp"
+
+#include <algorithm>
+
+namespace {
+
+using taxbroker::InstrumentMatches;
+using taxbroker::Money;
+using taxbroker::REPURCHASE_WINDOW_DAYS;
+
+// Columnar copy of the lot slices of in-year sales, consumed by SumByHoldingPeriod.
+struct SliceColumns {
+    std::vector<std::int32_t> mHeldKeys;
+    std::vector<Money> mGains;
+    std::vector<std::uint8_t> mLossRecognized;
+
+    void reserve(std::size_t aCount) {
+        mHeldKeys.reserve(aCount);
+        mGains.reserve(aCount);
+        mLossRecognized.reserve(aCount);
+    }
+
+    void truncate(std::size_t aCount) {
+        mHeldKeys.resize(aCount);
+        mGains.resize(aCount);
+        mLossRecognized.resize(aCount);
+    }
+};
+
+/*
+    Day serials of all buy lots of an instrument in FIFO (= chronological) order.
+    Consumed lots come from the matches, remaining ones from the open lots; a lot split
+    across several sells appears once.
+*/
+struct BuyDateIndex {
+    std::vector<std::int32_t> mDays;
+    std::vector<std::uint32_t> mBuyIndices;
+
+    explicit BuyDateIndex(const InstrumentMatches& aMatches) {
+        mDays.reserve(aMatches.mOpenLots.size() + aMatches.mMatches.size());
+        mBuyIndices.reserve(mDays.capacity());
+
+        const auto append = [this](std::uint32_t aBuyIndex, taxbroker::Date aDate) {
+            if (mBuyIndices.empty() || mBuyIndices.back() != aBuyIndex) {
+                mBuyIndices.push_back(aBuyIndex);
+                mDays.push_back(taxbroker::DaySerial(aDate));
+            }
+        };
+        for (const auto& match : aMatches.mMatches) {
+            append(match.mBuyIndex, match.mBuyDate);
+        }
+        for (const auto& lot : aMatches.mOpenLots) {
+            append(lot.mTransactionIndex, lot.mDate);
+        }
+    }
+
+    // Position of aBuyIndex; consumed lots are looked up in FIFO order so the cursor only advances.
+    std::size_t positionOf(std::uint32_t aBuyIndex, std::size_t aCursor) const {
+        while (aCursor < mBuyIndices.size() && mBuyIndices[aCursor] != aBuyIndex) {
+            ++aCursor;
+        }
+        return aCursor;
+    }
+
+    /*
+        True if a lot other than the consumed range [aFirstConsumed, aLastConsumed] was
+        bought within the window around aSellDay.
+    */
+    bool hasRepurchase(std::int32_t aSellDay, std::size_t aFirstConsumed,
+                       std::size_t aLastConsumed) const {
+        const auto windowBegin =
+            std::lower_bound(mDays.begin(), mDays.end(), aSellDay - REPURCHASE_WINDOW_DAYS);
+        const auto windowEnd =
+            std::upper_bound(windowBegin, mDays.end(), aSellDay + REPURCHASE_WINDOW_DAYS);
+
+        const auto first = static_cast<std::size_t>(windowBegin - mDays.begin());
+        const auto last = static_cast<std::size_t>(windowEnd - mDays.begin());
+        const std::size_t overlapBegin = std::max(first, aFirstConsumed);
+        const std::size_t overlapEnd = std::min(last, aLastConsumed + 1);
+        const std::size_t overlap = overlapEnd > overlapBegin ? overlapEnd - overlapBegin : 0;
+
+        return last - first > overlap;
+    }
+};
+
+} // namespace
+
+namespace taxbroker {
+
+HoldingPeriodTotals SumByHoldingPeriod(std::span<const std::int32_t> aHeldKeys,
+                                       std::span<const Money> aGains,
+                                       std::span<const std::uint8_t> aLossRecognized) {
+    constexpr std::int32_t kStep = HOLDING_PERIOD_STEP_YEARS * CALENDAR_KEY_YEAR;
+
+    // Sums of slices held at least bucket * 5 years; buckets are differences of neighbours.
+    std::array<Money, HOLDING_PERIOD_BUCKET_COUNT> gainsAtLeast{};
+    std::array<Money, HOLDING_PERIOD_BUCKET_COUNT> lossesAtLeast{};
+
+    for (std::size_t index = 0; index < aGains.size(); ++index) {
+        const Money gain = aGains[index];
+        const Money positive = std::max(gain, Money{0});
+        const Money negative = (gain - positive) * static_cast<Money>(aLossRecognized[index]);
+        const std::int32_t heldKey = aHeldKeys[index];
+
+        for (std::size_t bucket = 0; bucket < HOLDING_PERIOD_BUCKET_COUNT; ++bucket) {
+            const auto reached =
+                static_cast<Money>(heldKey >= static_cast<std::int32_t>(bucket) * kStep);
+            gainsAtLeast[bucket] += positive * reached;
+            lossesAtLeast[bucket] += negative * reached;
+        }
+    }
+
+    HoldingPeriodTotals totals;
+    for (std::size_t bucket = 0; bucket < HOLDING_PERIOD_BUCKET_COUNT; ++bucket) {
+        const bool isLast = bucket + 1 == HOLDING_PERIOD_BUCKET_COUNT;
+        totals.mGains[bucket] = gainsAtLeast[bucket] - (isLast ? 0 : gainsAtLeast[bucket + 1]);
+        totals.mLosses[bucket] = lossesAtLeast[bucket] - (isLast ? 0 : lossesAtLeast[bucket + 1]);
+    }
+
+    return totals;
+}
+
+InstrumentTaxResult TaxProcessor::process(const InstrumentMatches& aMatches) const {
+    return TaxProcessor{mFirstTaxYear}.processYears(aMatches).front();
+}
+
+std::vector<InstrumentTaxResult>
+TaxProcessor::processYears(const InstrumentMatches& aMatches) const {
+    const auto yearCount = static_cast<std::size_t>(std::max(mLastTaxYear - mFirstTaxYear + 1, 1));
+    std::vector<InstrumentTaxResult> results(yearCount);
+    std::vector<SliceColumns> yearColumns(yearCount);
+    for (std::size_t slot = 0; slot < yearCount; ++slot) {
+        results[slot].mIsin = aMatches.mIsin;
+        results[slot].mName = aMatches.mName;
+        results[slot].mTaxYear = mFirstTaxYear + static_cast<int>(slot);
+    }
+
+    const Date rangeBegin = MakeDate(mFirstTaxYear, 1, 1);
+    const Date rangeEnd = MakeDate(mFirstTaxYear + static_cast<int>(yearCount) - 1, 12, 31);
+    const BuyDateIndex buyIndex{aMatches};
+
+    const auto& matches = aMatches.mMatches;
+    if (yearCount == 1) {
+        yearColumns.front().reserve(matches.size());
+    }
+
+    // Sales come in date order, so the year slot only moves forward.
+    std::size_t slot = 0;
+    Date nextYearBegin = MakeDate(mFirstTaxYear + 1, 1, 1);
+
+    std::size_t buyCursor = 0;
+    std::size_t sliceBegin = 0;
+    while (sliceBegin < matches.size()) {
+        const auto& firstSlice = matches[sliceBegin];
+
+        SaleAssessment sale;
+        sale.mSellIndex = firstSlice.mSellIndex;
+        sale.mSellDate = firstSlice.mSellDate;
+
+        const bool inRange = sale.mSellDate >= rangeBegin && sale.mSellDate <= rangeEnd;
+        while (inRange && sale.mSellDate >= nextYearBegin) {
+            ++slot;
+            nextYearBegin = MakeDate(mFirstTaxYear + static_cast<int>(slot) + 1, 1, 1);
+        }
+        auto& columns = yearColumns[slot];
+
+        const std::size_t firstConsumed = buyIndex.positionOf(firstSlice.mBuyIndex, buyCursor);
+        const std::size_t firstColumn = columns.mGains.size();
+        const std::int32_t sellKey = CalendarKey(sale.mSellDate);
+
+        std::size_t sliceEnd = sliceBegin;
+        for (; sliceEnd < matches.size() && matches[sliceEnd].mSellIndex == sale.mSellIndex;
+             ++sliceEnd) {
+            const auto& slice = matches[sliceEnd];
+            const Money proceeds = multiplyMoneyUnits(slice.mSellUnitPrice, slice.mUnits);
+            const Money costBasis = multiplyMoneyUnits(slice.mBuyUnitPrice, slice.mUnits);
+            sale.mUnits += slice.mUnits;
+            sale.mProceeds += proceeds;
+            sale.mCostBasis += costBasis;
+
+            columns.mHeldKeys.push_back(sellKey - CalendarKey(slice.mBuyDate));
+            columns.mGains.push_back(proceeds - costBasis);
+        }
+        const std::size_t lastConsumed =
+            buyIndex.positionOf(matches[sliceEnd - 1].mBuyIndex, firstConsumed);
+        buyCursor = lastConsumed;
+        sliceBegin = sliceEnd;
+
+        if (!inRange) {
+            columns.truncate(firstColumn);
+            continue;
+        }
+
+        if (sale.mProceeds < sale.mCostBasis) {
+            sale.mLossDisallowed =
+                buyIndex.hasRepurchase(DaySerial(sale.mSellDate), firstConsumed, lastConsumed);
+        }
+        columns.mLossRecognized.resize(columns.mGains.size(), sale.mLossDisallowed ? 0 : 1);
+        results[slot].mSales.push_back(sale);
+    }
+
+    for (std::size_t year = 0; year < yearCount; ++year) {
+        const auto& columns = yearColumns[year];
+        results[year].mHoldingPeriods =
+            SumByHoldingPeriod(columns.mHeldKeys, columns.mGains, columns.mLossRecognized);
+    }
+    return results;
+}
+
+} // namespace taxbroker
@@ -0,0 +1,36 @@
+#include "server/api/report_api.hpp"
+
+namespace {
+
+using taxbroker::FormData;
+using taxbroker::ReportRequest;
+
+FormData RequestForm(const ReportRequest& aRequest) {
+    FormData form = aRequest.mForm;
+    form.mYear = aRequest.mOptions.mTaxYear;
+    return form;
+}
+
+} // namespace
+
+namespace taxbroker {
+
+ReportResponse ReportApi::generate(const ReportRequest& aRequest) {
+    ReportResponse response;
+    response.mReport = ReportProcessor{mPool}.process(aRequest.mSources, aRequest.mOptions);
+    response.mForms = GenerateForms(response.mReport, RequestForm(aRequest),
+                                    aRequest.mTaxPayer, mPool, aRequest.mSelection, mKdvpCache);
+    return response;
+}
+
+ReportBundleResponse ReportApi::bundle(const ReportRequest& aRequest, ZipWriter& aArchive) {
+    ReportBundleResponse response;
+    response.mReport = ReportProcessor{mPool}.process(aRequest.mSources, aRequest.mOptions);
+    response.mValidationErrors = WriteFormBundle(aArchive, response.mReport,
+                                                 RequestForm(aRequest), aRequest.mTaxPayer,
+                                                 mPool, aRequest.mSelection, mKdvpCache);
+    response.mWritten = aArchive.finish();
+    return response;
+}
+
+} // namespace taxbroker
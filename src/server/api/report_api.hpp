@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "generators/form_generator.hpp"
+#include "processors/report_processor.hpp"
+
+namespace taxbroker {
+
+// One taxpayer's report request: broker exports, processing options and form header.
+struct ReportRequest {
+    std::vector<ReportSource> mSources;
+    ReportOptions mOptions;
+    FormData mForm; // mYear is taken from mOptions.mTaxYear.
+    TaxPayer mTaxPayer;
+    FormSelection mSelection;
+};
+
+struct ReportResponse {
+    FinalReport mReport;
+    GeneratedForms mForms;
+};
+
+struct ReportBundleResponse {
+    FinalReport mReport;
+    std::vector<std::string> mValidationErrors; // Of all forms in the bundle.
+    bool mWritten{false};                       // False if the archive failed.
+};
+
+/*
+    Report endpoint of the server: processes a request's exports and renders the selected
+    forms from the result. Request handlers share one instance, so the thread pool and
+    the KDVP fragment cache are shared across requests; the instance holds no other state.
+*/
+class ReportApi {
+  public:
+    explicit ReportApi(ThreadPool& aPool, FragmentCache* aKdvpCache = nullptr)
+        : mPool(aPool), mKdvpCache(aKdvpCache) {}
+
+    [[nodiscard]] ReportResponse generate(const ReportRequest& aRequest);
+
+    // Like generate(), but streams the forms and the audit trail into aArchive with
+    // WriteFormBundle(), e.g. straight to the response socket. Finishes the archive.
+    [[nodiscard]] ReportBundleResponse bundle(const ReportRequest& aRequest,
+                                              ZipWriter& aArchive);
+
+  private:
+    ThreadPool& mPool;
+    FragmentCache* mKdvpCache;
+};
+
+} // namespace taxbroker
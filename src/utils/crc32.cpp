@@ -0,0 +1,166 @@
+#include "utils/crc32.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#elif defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#if !defined(__ARM_FEATURE_CRC32)
+
+constexpr std::uint32_t kPolynomial = 0xEDB88320U;
+
+using CrcTables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+// Table k maps a byte to its CRC followed by k zero bytes.
+constexpr CrcTables MakeCrcTables() {
+    CrcTables tables{};
+    for (std::uint32_t byte = 0; byte < 256; ++byte) {
+        std::uint32_t crc = byte;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1U) != 0 ? (crc >> 1) ^ kPolynomial : crc >> 1;
+        }
+        tables[0][byte] = crc;
+    }
+    for (std::size_t table = 1; table < tables.size(); ++table) {
+        for (std::size_t byte = 0; byte < 256; ++byte) {
+            const std::uint32_t previous = tables[table - 1][byte];
+            tables[table][byte] = (previous >> 8) ^ tables[0][previous & 0xFFU];
+        }
+    }
+    return tables;
+}
+
+constexpr CrcTables kCrcTables = MakeCrcTables();
+
+std::uint32_t UpdateByte(std::uint32_t aCrc, unsigned char aByte) noexcept {
+    return kCrcTables[0][(aCrc ^ aByte) & 0xFFU] ^ (aCrc >> 8);
+}
+
+#endif
+
+#if !defined(__ARM_FEATURE_CRC32) && defined(__x86_64__) && defined(__GNUC__)
+
+// Shorter inputs stay on the tables; folding needs one 64-byte block to start.
+constexpr std::size_t kFoldMinimumBytes = 64;
+
+const bool kHasPclmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+
+__attribute__((target("pclmul,sse4.1"))) __m128i Load(const char* aData) noexcept {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(aData));
+}
+
+// aAccumulator * x^(k) folded onto aNext, with the two halves of aConstants as the k.
+__attribute__((target("pclmul,sse4.1"))) __m128i Fold(__m128i aAccumulator, __m128i aConstants,
+                                                      __m128i aNext) noexcept {
+    const __m128i low = _mm_clmulepi64_si128(aAccumulator, aConstants, 0x00);
+    const __m128i high = _mm_clmulepi64_si128(aAccumulator, aConstants, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(high, low), aNext);
+}
+
+/*
+    CRC state after aSize bytes (a multiple of 16, at least 64) with carry-less multiplies,
+    after Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ": four
+    128-bit lanes fold 64 bytes per step, merge into one lane, which is reduced to 64 and
+    then 32 bits with a Barrett reduction. The constants are for the reflected polynomial.
+*/
+__attribute__((target("pclmul,sse4.1"))) std::uint32_t FoldPclmul(const char* aData,
+                                                                  std::size_t aSize,
+                                                                  std::uint32_t aCrc) noexcept {
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i lowMask = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x1 = _mm_xor_si128(Load(aData), _mm_cvtsi32_si128(static_cast<int>(aCrc)));
+    __m128i x2 = Load(aData + 16);
+    __m128i x3 = Load(aData + 32);
+    __m128i x4 = Load(aData + 48);
+    aData += 64;
+    aSize -= 64;
+
+    for (; aSize >= 64; aData += 64, aSize -= 64) {
+        x1 = Fold(x1, k1k2, Load(aData));
+        x2 = Fold(x2, k1k2, Load(aData + 16));
+        x3 = Fold(x3, k1k2, Load(aData + 32));
+        x4 = Fold(x4, k1k2, Load(aData + 48));
+    }
+
+    x1 = Fold(x1, k3k4, x2);
+    x1 = Fold(x1, k3k4, x3);
+    x1 = Fold(x1, k3k4, x4);
+    for (; aSize >= 16; aData += 16, aSize -= 16) {
+        x1 = Fold(x1, k3k4, Load(aData));
+    }
+
+    // 128 to 64 bits.
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, lowMask), k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits.
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, lowMask), poly, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, lowMask), poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return static_cast<std::uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+#endif
+
+} // namespace
+
+namespace taxbroker {
+
+std::uint32_t Crc32(std::string_view aData, std::uint32_t aCrc) noexcept {
+    std::uint32_t crc = ~aCrc;
+    const char* data = aData.data();
+    std::size_t size = aData.size();
+
+#if defined(__ARM_FEATURE_CRC32)
+    for (; size >= 8; data += 8, size -= 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, data, sizeof(word));
+        crc = __crc32d(crc, word);
+    }
+    for (; size > 0; ++data, --size) {
+        crc = __crc32b(crc, static_cast<std::uint8_t>(*data));
+    }
+#else
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (kHasPclmul && size >= kFoldMinimumBytes) {
+        const std::size_t folded = size & ~std::size_t{15};
+        crc = FoldPclmul(data, folded, crc);
+        data += folded;
+        size -= folded;
+    }
+#endif
+    if constexpr (std::endian::native == std::endian::little) {
+        for (; size >= 8; data += 8, size -= 8) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, data, sizeof(word));
+            word ^= crc;
+            crc = kCrcTables[7][word & 0xFFU] ^ kCrcTables[6][(word >> 8) & 0xFFU] ^
+                  kCrcTables[5][(word >> 16) & 0xFFU] ^ kCrcTables[4][(word >> 24) & 0xFFU] ^
+                  kCrcTables[3][(word >> 32) & 0xFFU] ^ kCrcTables[2][(word >> 40) & 0xFFU] ^
+                  kCrcTables[1][(word >> 48) & 0xFFU] ^ kCrcTables[0][word >> 56];
+        }
+    }
+    for (; size > 0; ++data, --size) {
+        crc = UpdateByte(crc, static_cast<unsigned char>(*data));
+    }
+#endif
+
+    return ~crc;
+}
+
+} // namespace taxbroker
@@ -0,0 +1,45 @@
+#include "utils/date_utils.hpp"
+
+#include <chrono>
+
+namespace taxbroker {
+
+Date MakeDate(int aYear, unsigned aMonth, unsigned aDay) {
+    return Date{std::chrono::sys_days{std::chrono::year{aYear} / std::chrono::month{aMonth} /
+                                      std::chrono::day{aDay}}};
+}
+
+int YearOf(Date aDate) {
+    const std::chrono::year_month_day calendarDate{std::chrono::sys_days{aDate}};
+    return static_cast<int>(calendarDate.year());
+}
+
+std::array<char, ISO_DATE_LENGTH> FormatIsoDate(Date aDate) {
+    const std::chrono::year_month_day calendarDate{std::chrono::sys_days{aDate}};
+    const auto year = static_cast<unsigned>(static_cast<int>(calendarDate.year()));
+    const auto month = static_cast<unsigned>(calendarDate.month());
+    const auto day = static_cast<unsigned>(calendarDate.day());
+
+    std::array<char, ISO_DATE_LENGTH> text{};
+    text[0] = static_cast<char>('0' + year / 1000 % 10);
+    text[1] = static_cast<char>('0' + year / 100 % 10);
+    text[2] = static_cast<char>('0' + year / 10 % 10);
+    text[3] = static_cast<char>('0' + year % 10);
+    text[4] = '-';
+    text[5] = static_cast<char>('0' + month / 10);
+    text[6] = static_cast<char>('0' + month % 10);
+    text[7] = '-';
+    text[8] = static_cast<char>('0' + day / 10);
+    text[9] = static_cast<char>('0' + day % 10);
+    return text;
+}
+
+std::int32_t CalendarKey(Date aDate) {
+    const std::chrono::year_month_day calendarDate{std::chrono::sys_days{aDate}};
+    const int year = static_cast<int>(calendarDate.year());
+    const auto month = static_cast<unsigned>(calendarDate.month());
+    const auto day = static_cast<unsigned>(calendarDate.day());
+    return year * CALENDAR_KEY_YEAR + static_cast<std::int32_t>(month * 32 + day);
+}
+
+} // namespace taxbroker
@@ -0,0 +1,118 @@
+#include "utils/decimal_format.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace {
+
+using taxbroker::MAX_DECIMAL_PRECISION;
+
+constexpr std::array<char, 200> MakeDigitPairs() {
+    std::array<char, 200> pairs{};
+    for (int value = 0; value < 100; ++value) {
+        pairs[static_cast<std::size_t>(value) * 2] = static_cast<char>('0' + value / 10);
+        pairs[static_cast<std::size_t>(value) * 2 + 1] = static_cast<char>('0' + value % 10);
+    }
+    return pairs;
+}
+
+constexpr std::array<std::uint64_t, 20> MakePowersOfTen() {
+    std::array<std::uint64_t, 20> powers{};
+    std::uint64_t power = 1;
+    for (auto& entry : powers) {
+        entry = power;
+        power *= 10;
+    }
+    return powers;
+}
+
+constexpr std::array<char, 200> kDigitPairs = MakeDigitPairs();
+constexpr std::array<std::uint64_t, 20> kPowersOfTen = MakePowersOfTen();
+
+// Writes exactly aWidth digits of aValue ending right before aEnd; returns the first digit.
+char* WriteFixedDigits(std::uint64_t aValue, int aWidth, char* aEnd) noexcept {
+    while (aWidth >= 2) {
+        const auto pair = static_cast<std::size_t>(aValue % 100) * 2;
+        aValue /= 100;
+        aEnd -= 2;
+        std::memcpy(aEnd, &kDigitPairs[pair], 2);
+        aWidth -= 2;
+    }
+    if (aWidth == 1) {
+        *--aEnd = static_cast<char>('0' + aValue % 10);
+    }
+    return aEnd;
+}
+
+// Writes aValue without leading zeros ending right before aEnd; returns the first digit.
+char* WriteDigits(std::uint64_t aValue, char* aEnd) noexcept {
+    while (aValue >= 100) {
+        const auto pair = static_cast<std::size_t>(aValue % 100) * 2;
+        aValue /= 100;
+        aEnd -= 2;
+        std::memcpy(aEnd, &kDigitPairs[pair], 2);
+    }
+    if (aValue >= 10) {
+        aEnd -= 2;
+        std::memcpy(aEnd, &kDigitPairs[static_cast<std::size_t>(aValue) * 2], 2);
+    } else {
+        *--aEnd = static_cast<char>('0' + aValue);
+    }
+    return aEnd;
+}
+
+int Clamp(int aValue) noexcept {
+    return aValue < 0 ? 0 : (aValue > MAX_DECIMAL_PRECISION ? MAX_DECIMAL_PRECISION : aValue);
+}
+
+} // namespace
+
+namespace taxbroker {
+
+std::string_view FormatDecimal(std::int64_t aValue, int aScaleDigits, int aPrecision,
+                               char* aBuffer) noexcept {
+    aScaleDigits = Clamp(aScaleDigits);
+    aPrecision = Clamp(aPrecision);
+
+    std::uint64_t magnitude = aValue < 0 ? 0 - static_cast<std::uint64_t>(aValue)
+                                         : static_cast<std::uint64_t>(aValue);
+
+    // Drop surplus digits first, so the integer/fraction split below works on aPrecision.
+    int fractionDigits = aScaleDigits;
+    if (aPrecision < aScaleDigits) {
+        const std::uint64_t divisor = kPowersOfTen[aScaleDigits - aPrecision];
+        const std::uint64_t remainder = magnitude % divisor;
+        magnitude /= divisor;
+        if (remainder >= divisor - remainder) {
+            ++magnitude;
+        }
+        fractionDigits = aPrecision;
+    }
+
+    const std::uint64_t unit = kPowersOfTen[fractionDigits];
+    const std::uint64_t integerPart = magnitude / unit;
+    const std::uint64_t fractionPart = magnitude % unit;
+
+    // Built right to left from the end of the buffer, then moved to its start.
+    char* const end = aBuffer + DECIMAL_BUFFER_SIZE;
+    char* cursor = end;
+    if (aPrecision > fractionDigits) {
+        const auto padding = static_cast<std::size_t>(aPrecision - fractionDigits);
+        cursor -= padding;
+        std::memset(cursor, '0', padding);
+    }
+    if (aPrecision > 0) {
+        cursor = WriteFixedDigits(fractionPart, fractionDigits, cursor);
+        *--cursor = '.';
+    }
+    cursor = WriteDigits(integerPart, cursor);
+    if (aValue < 0 && magnitude != 0) {
+        *--cursor = '-';
+    }
+
+    const auto length = static_cast<std::size_t>(end - cursor);
+    std::memmove(aBuffer, cursor, length);
+    return std::string_view{aBuffer, length};
+}
+
+} // namespace taxbroker
@@ -0,0 +1,42 @@
+#include "utils/fd_write.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+
+#include <unistd.h>
+
+namespace {
+
+// Linux IOV_MAX.
+constexpr std::size_t kMaxChunksPerWrite = 1024;
+
+} // namespace
+
+namespace taxbroker {
+
+bool WriteAll(int aFd, std::span<iovec> aChunks) {
+    while (!aChunks.empty()) {
+        const auto count = std::min(aChunks.size(), kMaxChunksPerWrite);
+        const auto result = ::writev(aFd, aChunks.data(), static_cast<int>(count));
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        auto remaining = static_cast<std::size_t>(result);
+        while (!aChunks.empty() && remaining >= aChunks.front().iov_len) {
+            remaining -= aChunks.front().iov_len;
+            aChunks = aChunks.subspan(1);
+        }
+        if (remaining > 0) {
+            aChunks.front().iov_base = static_cast<char*>(aChunks.front().iov_base) + remaining;
+            aChunks.front().iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+} // namespace taxbroker
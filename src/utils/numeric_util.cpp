@@ -0,0 +1,107 @@
+#include "utils/numeric_util.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr auto kInt64Max = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+
+struct UInt128 {
+    std::uint64_t mHigh{};
+    std::uint64_t mLow{};
+};
+
+std::uint64_t Magnitude(std::int64_t aValue) {
+    // Negating in unsigned arithmetic keeps INT64_MIN well defined.
+    return aValue < 0 ? 0 - static_cast<std::uint64_t>(aValue) : static_cast<std::uint64_t>(aValue);
+}
+
+#if defined(__SIZEOF_INT128__)
+
+__extension__ typedef unsigned __int128 NativeUInt128;
+
+UInt128 MultiplyWide(std::uint64_t aLeft, std::uint64_t aRight) {
+    const NativeUInt128 product = static_cast<NativeUInt128>(aLeft) * aRight;
+    return UInt128{static_cast<std::uint64_t>(product >> 64), static_cast<std::uint64_t>(product)};
+}
+
+// aDividend / aDivisor; the caller guarantees aDividend.mHigh < aDivisor.
+std::uint64_t DivideWide(UInt128 aDividend, std::uint64_t aDivisor) {
+    const NativeUInt128 dividend = (static_cast<NativeUInt128>(aDividend.mHigh) << 64) |
+                                   aDividend.mLow;
+    return static_cast<std::uint64_t>(dividend / aDivisor);
+}
+
+#else
+
+// Schoolbook product of 32-bit halves, e.g. for MSVC which has no 128-bit type.
+UInt128 MultiplyWide(std::uint64_t aLeft, std::uint64_t aRight) {
+    constexpr std::uint64_t kLowMask = 0xFFFFFFFFu;
+    const std::uint64_t lowLow = (aLeft & kLowMask) * (aRight & kLowMask);
+    const std::uint64_t highLow = (aLeft >> 32) * (aRight & kLowMask);
+    const std::uint64_t lowHigh = (aLeft & kLowMask) * (aRight >> 32);
+    const std::uint64_t highHigh = (aLeft >> 32) * (aRight >> 32);
+
+    const std::uint64_t middle = (lowLow >> 32) + (highLow & kLowMask) + lowHigh;
+    return UInt128{highHigh + (highLow >> 32) + (middle >> 32),
+                   (middle << 32) | (lowLow & kLowMask)};
+}
+
+// Restoring division; the caller guarantees aDividend.mHigh < aDivisor.
+std::uint64_t DivideWide(UInt128 aDividend, std::uint64_t aDivisor) {
+    std::uint64_t remainder = aDividend.mHigh;
+    std::uint64_t quotient = 0;
+    for (int bit = 63; bit >= 0; --bit) {
+        const bool carry = (remainder >> 63) != 0;
+        remainder = (remainder << 1) | ((aDividend.mLow >> bit) & 1);
+        quotient <<= 1;
+        if (carry || remainder >= aDivisor) {
+            remainder -= aDivisor;
+            quotient |= 1;
+        }
+    }
+    return quotient;
+}
+
+#endif
+
+UInt128 Add(UInt128 aLeft, std::uint64_t aRight) {
+    const std::uint64_t low = aLeft.mLow + aRight;
+    return UInt128{aLeft.mHigh + (low < aLeft.mLow ? 1 : 0), low};
+}
+
+} // namespace
+
+taxbroker::Money multiplyMoneyUnits(taxbroker::Money price, taxbroker::Units units) {
+    // Rounded half away from zero back to Money precision.
+    return mulDivRounded(price, units, taxbroker::UNITS_SCALE);
+}
+
+std::int64_t mulDivRounded(std::int64_t value, std::int64_t multiplier, std::int64_t divisor) {
+    const bool negative = (value < 0) != (multiplier < 0);
+    const auto unsignedDivisor = static_cast<std::uint64_t>(divisor);
+    const UInt128 rounded =
+        Add(MultiplyWide(Magnitude(value), Magnitude(multiplier)), unsignedDivisor / 2);
+
+    if (rounded.mHigh >= unsignedDivisor) {
+        throw std::overflow_error("Scaled product does not fit in 64 bits");
+    }
+    const std::uint64_t quotient = DivideWide(rounded, unsignedDivisor);
+    if (quotient > kInt64Max) {
+        throw std::overflow_error("Scaled product does not fit in 64 bits");
+    }
+
+    const auto magnitude = static_cast<std::int64_t>(quotient);
+    return negative ? -magnitude : magnitude;
+}
+
+std::int64_t checkedMultiply(std::int64_t left, std::int64_t right) {
+    const UInt128 product = MultiplyWide(Magnitude(left), Magnitude(right));
+    if (product.mHigh != 0 || product.mLow > kInt64Max) {
+        throw std::overflow_error("Product does not fit in 64 bits");
+    }
+
+    const auto magnitude = static_cast<std::int64_t>(product.mLow);
+    return (left < 0) != (right < 0) ? -magnitude : magnitude;
+}
@@ -0,0 +1,144 @@
+#include "utils/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace {
+
+struct WorkerIdentity {
+    const void* mPool{nullptr};
+    std::size_t mIndex{};
+};
+
+thread_local WorkerIdentity tWorkerIdentity;
+
+} // namespace
+
+namespace taxbroker {
+
+ThreadPool::ThreadPool(std::size_t aThreadCount) {
+    const std::size_t threadCount = std::max<std::size_t>(aThreadCount, 1);
+
+    mQueues.reserve(threadCount);
+    for (std::size_t index = 0; index < threadCount; ++index) {
+        mQueues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    mWorkers.reserve(threadCount);
+    for (std::size_t index = 0; index < threadCount; ++index) {
+        mWorkers.emplace_back([this, index]() { workerLoop(index); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const std::lock_guard lock(mWakeMutex);
+        mStopping = true;
+    }
+    mWakeCondition.notify_all();
+
+    for (auto& worker : mWorkers) {
+        worker.join();
+    }
+}
+
+std::size_t ThreadPool::DefaultThreadCount() noexcept {
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void ThreadPool::enqueue(Task aTask) {
+    const bool isOwnWorker = tWorkerIdentity.mPool == this;
+    auto& queue = isOwnWorker ? *mQueues[tWorkerIdentity.mIndex] : mInjected;
+
+    // Counted before publishing so a thief can never decrement below zero.
+    {
+        const std::lock_guard lock(mWakeMutex);
+        mQueuedTasks.fetch_add(1, std::memory_order_release);
+    }
+
+    {
+        const std::lock_guard lock(queue.mMutex);
+        queue.mTasks.push_back(std::move(aTask));
+    }
+    mWakeCondition.notify_one();
+}
+
+bool ThreadPool::takeFront(WorkerQueue& aQueue, Task& aTask) {
+    const std::lock_guard lock(aQueue.mMutex);
+    if (aQueue.mTasks.empty()) {
+        return false;
+    }
+
+    aTask = std::move(aQueue.mTasks.front());
+    aQueue.mTasks.pop_front();
+    mQueuedTasks.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+// aWorkerIndex is mQueues.size() for a thread outside the pool.
+bool ThreadPool::tryAcquire(std::size_t aWorkerIndex, Task& aTask) {
+    // Own queue: newest spawned task first.
+    if (aWorkerIndex < mQueues.size()) {
+        auto& queue = *mQueues[aWorkerIndex];
+        const std::lock_guard lock(queue.mMutex);
+        if (!queue.mTasks.empty()) {
+            aTask = std::move(queue.mTasks.back());
+            queue.mTasks.pop_back();
+            mQueuedTasks.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+
+    // External submissions in the order they were made.
+    if (takeFront(mInjected, aTask)) {
+        return true;
+    }
+
+    // Steal: oldest task of another queue.
+    for (std::size_t offset = 1; offset <= mQueues.size(); ++offset) {
+        const std::size_t index = (aWorkerIndex + offset) % (mQueues.size() + 1);
+        if (index < mQueues.size() && takeFront(*mQueues[index], aTask)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ThreadPool::runPendingTask() {
+    if (mQueuedTasks.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    const std::size_t workerIndex =
+        tWorkerIdentity.mPool == this ? tWorkerIdentity.mIndex : mQueues.size();
+
+    Task task;
+    if (!tryAcquire(workerIndex, task)) {
+        return false;
+    }
+
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(std::size_t aWorkerIndex) {
+    tWorkerIdentity = WorkerIdentity{this, aWorkerIndex};
+
+    while (true) {
+        Task task;
+        if (tryAcquire(aWorkerIndex, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock lock(mWakeMutex);
+        mWakeCondition.wait(lock, [this]() {
+            return mStopping || mQueuedTasks.load(std::memory_order_acquire) > 0;
+        });
+        if (mStopping && mQueuedTasks.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+} // namespace taxbroker
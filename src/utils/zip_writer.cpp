@@ -0,0 +1,228 @@
+#include "utils/zip_writer.hpp"
+
+#include "utils/crc32.hpp"
+#include "utils/fd_write.hpp"
+#include "utils/logger.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::uint32_t kLocalHeaderSignature = 0x04034B50;
+constexpr std::uint32_t kCentralHeaderSignature = 0x02014B50;
+constexpr std::uint32_t kEndOfCentralDirectorySignature = 0x06054B50;
+
+constexpr std::uint32_t kVersion = 10;      // 1.0: stored entries.
+constexpr std::uint32_t kFlags = 1U << 11; // UTF-8 name.
+constexpr std::uint32_t kMethodStored = 0;
+constexpr std::uint32_t kDosTime = 0;
+constexpr std::uint32_t kDosDate = (1U << 5) | 1U; // 1980-01-01.
+
+// CRC and sizes in the local header, patched when the entry ends.
+constexpr std::uint64_t kLocalCrcOffset = 14;
+constexpr std::size_t kLocalCrcBytes = 12;
+
+constexpr std::uint64_t kMaxSize = 0xFFFFFFFFU;
+constexpr std::size_t kMaxEntries = 0xFFFF;
+
+// Smaller writes to a descriptor are collected before they go out.
+constexpr std::size_t kBufferSize = 64 * 1024;
+
+} // namespace
+
+namespace taxbroker {
+
+ZipWriter::ZipWriter(std::string& aOutput) : mBuffer(&aOutput), mInitialSize(aOutput.size()) {}
+
+ZipWriter::ZipWriter(int aFd) : mBuffer(&mOwnBuffer), mFd(aFd) {
+    mOwnBuffer.reserve(kBufferSize);
+    const int flags = ::fcntl(aFd, F_GETFL);
+    if (flags >= 0 && (flags & O_APPEND) == 0) {
+        mFdStart = ::lseek(aFd, 0, SEEK_CUR);
+    }
+}
+
+void ZipWriter::beginEntry(std::string_view aName) {
+    assert(!mFinished && "ZIP entry after the central directory");
+    endEntry();
+    if (mEntries.size() == kMaxEntries || aName.size() > 0xFFFF) {
+        fail("too many entries or a name that is too long");
+        return;
+    }
+
+    const std::uint64_t offset = bytesWritten();
+    put32(kLocalHeaderSignature);
+    put16(kVersion);
+    put16(kFlags);
+    put16(kMethodStored);
+    put16(kDosTime);
+    put16(kDosDate);
+    put32(0); // CRC and sizes, see patchHeader().
+    put32(0);
+    put32(0);
+    put16(static_cast<std::uint32_t>(aName.size()));
+    put16(0);
+    mBuffer->append(aName);
+
+    mEntries.push_back(Entry{std::string{aName}, 0, 0, offset});
+    mEntryOpen = true;
+}
+
+void ZipWriter::write(std::string_view aData) {
+    write(std::span<const std::string_view>{&aData, 1});
+}
+
+void ZipWriter::write(std::span<const std::string_view> aChunks) {
+    assert(mEntryOpen && "ZIP data outside of an entry");
+    if (!mEntryOpen) {
+        return;
+    }
+
+    Entry& entry = mEntries.back();
+    std::size_t chunkBytes = 0;
+    for (const auto& chunk : aChunks) {
+        entry.mCrc = Crc32(chunk, entry.mCrc);
+        chunkBytes += chunk.size();
+    }
+    entry.mSize += chunkBytes;
+
+    if (mFd < 0 || mFdStart < 0 || mBuffer->size() + chunkBytes < kBufferSize) {
+        for (const auto& chunk : aChunks) {
+            mBuffer->append(chunk);
+        }
+        return;
+    }
+    flush(aChunks);
+}
+
+void ZipWriter::endEntry() {
+    if (!mEntryOpen) {
+        return;
+    }
+    mEntryOpen = false;
+
+    const Entry& entry = mEntries.back();
+    if (entry.mSize > kMaxSize || entry.mOffset > kMaxSize) {
+        fail("entry beyond 4 GiB");
+    }
+    patchHeader(entry);
+    if (mFd >= 0 && mBuffer->size() >= kBufferSize) {
+        flush();
+    }
+}
+
+bool ZipWriter::finish() {
+    assert(!mFinished && "ZIP archive finished twice");
+    if (mFinished) {
+        return !mFailed;
+    }
+    endEntry();
+    mFinished = true;
+
+    const std::uint64_t directoryOffset = bytesWritten();
+    for (const auto& entry : mEntries) {
+        put32(kCentralHeaderSignature);
+        put16(kVersion);
+        put16(kVersion);
+        put16(kFlags);
+        put16(kMethodStored);
+        put16(kDosTime);
+        put16(kDosDate);
+        put32(entry.mCrc);
+        put32(entry.mSize);
+        put32(entry.mSize);
+        put16(static_cast<std::uint32_t>(entry.mName.size()));
+        put16(0); // Extra field, comment, disk number, internal and external attributes.
+        put16(0);
+        put16(0);
+        put16(0);
+        put32(0);
+        put32(entry.mOffset);
+        mBuffer->append(entry.mName);
+    }
+    const std::uint64_t directorySize = bytesWritten() - directoryOffset;
+    if (directoryOffset + directorySize > kMaxSize) {
+        fail("archive beyond 4 GiB");
+    }
+
+    put32(kEndOfCentralDirectorySignature);
+    put16(0);
+    put16(0);
+    put16(static_cast<std::uint32_t>(mEntries.size()));
+    put16(static_cast<std::uint32_t>(mEntries.size()));
+    put32(directorySize);
+    put32(directoryOffset);
+    put16(0);
+
+    if (mFd >= 0) {
+        flush();
+    }
+    return !mFailed;
+}
+
+void ZipWriter::put16(std::uint32_t aValue) {
+    const char bytes[2] = {static_cast<char>(aValue & 0xFFU), static_cast<char>(aValue >> 8)};
+    mBuffer->append(bytes, sizeof(bytes));
+}
+
+void ZipWriter::put32(std::uint64_t aValue) {
+    put16(static_cast<std::uint32_t>(aValue & 0xFFFFU));
+    put16(static_cast<std::uint32_t>((aValue >> 16) & 0xFFFFU));
+}
+
+void ZipWriter::patchHeader(const Entry& aEntry) {
+    char fields[kLocalCrcBytes];
+    for (std::size_t index = 0; index < 4; ++index) {
+        // Stored: compressed and uncompressed sizes are equal.
+        fields[index] = static_cast<char>(aEntry.mCrc >> (8 * index));
+        fields[4 + index] = static_cast<char>(aEntry.mSize >> (8 * index));
+        fields[8 + index] = fields[4 + index];
+    }
+
+    // A header is flushed as a whole, so it is either in the buffer or behind it.
+    const std::uint64_t position = aEntry.mOffset + kLocalCrcOffset;
+    if (position >= mFlushedBytes) {
+        mBuffer->replace(mInitialSize + (position - mFlushedBytes), kLocalCrcBytes, fields,
+                         kLocalCrcBytes);
+        return;
+    }
+    assert(mFdStart >= 0 && "ZIP header flushed to an unseekable descriptor");
+    const auto written = ::pwrite(mFd, fields, kLocalCrcBytes,
+                                  static_cast<off_t>(mFdStart + position));
+    if (!mFailed && written != static_cast<ssize_t>(kLocalCrcBytes)) {
+        LOG_ERROR("Patching ZIP header on descriptor {} failed: {}", mFd, std::strerror(errno));
+        mFailed = true;
+    }
+}
+
+void ZipWriter::fail(std::string_view aReason) {
+    if (!mFailed) {
+        LOG_ERROR("ZIP archive failed: {}", aReason);
+    }
+    mFailed = true;
+}
+
+void ZipWriter::flush(std::span<const std::string_view> aChunks) {
+    std::vector<iovec> chunks;
+    chunks.reserve(aChunks.size() + 1);
+    chunks.push_back(iovec{mBuffer->data(), mBuffer->size()});
+    std::size_t bytes = mBuffer->size();
+    for (const auto& chunk : aChunks) {
+        chunks.push_back(iovec{const_cast<char*>(chunk.data()), chunk.size()});
+        bytes += chunk.size();
+    }
+
+    if (!mFailed && !WriteAll(mFd, chunks)) {
+        LOG_ERROR("Writing ZIP archive to descriptor {} failed: {}", mFd, std::strerror(errno));
+        mFailed = true;
+    }
+    mFlushedBytes += bytes;
+    mBuffer->clear();
+}
+
+} // namespace taxbroker
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include "processors/batch_processor.hpp"
+#include "utils/date_utils.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace taxbroker {
+namespace {
+
+// Builds a one-instrument statement from the file name instead of reading the file.
+class FakeParser final : public CsvParser {
+  public:
+    ParseResult parse(const std::filesystem::path& aCsvPath) override {
+        if (aCsvPath.stem() == "broken") {
+            throw std::runtime_error("unreadable export");
+        }
+        if (aCsvPath.stem() == "foreign") {
+            throw 42; // Not derived from std::exception.
+        }
+
+        TradeInstrument instrument;
+        instrument.mIsin = aCsvPath.stem().string();
+        instrument.mTransactions.push_back(TradeTransaction{
+            MakeDate(2023, 2, 1), TradeSide::Buy, 10 * MONEY_SCALE, UNITS_SCALE, Currency::EUR});
+        instrument.mTransactions.push_back(TradeTransaction{
+            MakeDate(2024, 2, 1), TradeSide::Sell, 15 * MONEY_SCALE, UNITS_SCALE, Currency::EUR});
+
+        ParseResult result;
+        result.mStatement.mTradeInstruments.push_back(std::move(instrument));
+        return result;
+    }
+};
+
+ParserResolver CsvResolver() {
+    return [](const std::filesystem::path& aPath) -> std::shared_ptr<CsvParser> {
+        if (aPath.extension() != ".csv") {
+            return nullptr;
+        }
+        return std::make_shared<FakeParser>();
+    };
+}
+
+TEST(BatchProcessorTest, ParsesManifest) {
+    std::istringstream manifest{"# taxpayer;year;files\n"
+                                "\n"
+                                "12345678; 2024; a.csv, /data/b.csv\n"
+                                "87654321;2023;c.csv\n"};
+
+    const auto jobs = ParseBatchManifest(manifest, "/inputs");
+    ASSERT_TRUE(jobs.has_value());
+    ASSERT_EQ(jobs->size(), 2U);
+    EXPECT_EQ((*jobs)[0].mTaxpayerId, "12345678");
+    EXPECT_EQ((*jobs)[0].mTaxYear, 2024);
+    ASSERT_EQ((*jobs)[0].mInputFiles.size(), 2U);
+    EXPECT_EQ((*jobs)[0].mInputFiles[0], std::filesystem::path{"/inputs/a.csv"});
+    EXPECT_EQ((*jobs)[0].mInputFiles[1], std::filesystem::path{"/data/b.csv"});
+    EXPECT_EQ((*jobs)[1].mTaxYear, 2023);
+}
+
+TEST(BatchProcessorTest, RejectsMalformedManifest) {
+    std::istringstream missingFiles{"12345678;2024\n"};
+    EXPECT_FALSE(ParseBatchManifest(missingFiles).has_value());
+
+    std::istringstream badYear{"12345678;20x4;a.csv\n"};
+    EXPECT_FALSE(ParseBatchManifest(badYear).has_value());
+}
+
+TEST(BatchProcessorTest, ProcessesJobsAndIsolatesFailures) {
+    std::vector<BatchJob> jobs;
+    for (int index = 0; index < 12; ++index) {
+        jobs.push_back(BatchJob{"client" + std::to_string(index), 2024,
+                                {"US00000000" + std::to_string(10 + index) + ".csv"}});
+    }
+    jobs.push_back(BatchJob{"broken", 2024, {"broken.csv"}});
+    jobs.push_back(BatchJob{"unknown", 2024, {"export.pdf"}});
+
+    ThreadPool pool{4};
+    TaxResultCache cache{1 << 20};
+    BatchOptions options;
+    options.mMaxConcurrentJobs = 3;
+    options.mCache = &cache;
+    const auto batch = BatchProcessor{pool, CsvResolver()}.run(jobs, options);
+
+    ASSERT_EQ(batch.mJobs.size(), jobs.size());
+    for (std::size_t index = 0; index < 12; ++index) {
+        const auto& job = batch.mJobs[index];
+        EXPECT_EQ(job.mTaxpayerId, jobs[index].mTaxpayerId);
+        ASSERT_EQ(job.mStatus, BatchJobStatus::Completed);
+        ASSERT_EQ(job.mReport->mInstruments.size(), 1U);
+        EXPECT_EQ(job.mReport->mInstruments[0].mTax.mSales.size(), 1U);
+        EXPECT_GT(job.mReportBytes, 0U);
+    }
+    EXPECT_EQ(batch.mJobs[12].mStatus, BatchJobStatus::Failed);
+    EXPECT_EQ(batch.mJobs[12].mError, "unreadable export");
+    EXPECT_EQ(batch.mJobs[13].mStatus, BatchJobStatus::Failed);
+
+    const auto& summary = batch.mSummary;
+    EXPECT_EQ(summary.mJobCount, 14U);
+    EXPECT_EQ(summary.mCompletedCount, 12U);
+    EXPECT_EQ(summary.mFailedCount, 2U);
+    EXPECT_EQ(summary.mInstrumentCount, 12U);
+    EXPECT_LE(summary.mPeakConcurrentJobs, 3U);
+}
+
+TEST(BatchProcessorTest, ThrowingResolverFailsOnlyItsJob) {
+    const ParserResolver resolver = [](const std::filesystem::path& aPath) {
+        if (aPath.stem() == "locked") {
+            throw std::runtime_error("resolver unavailable");
+        }
+        return CsvResolver()(aPath);
+    };
+
+    std::vector<BatchJob> jobs;
+    jobs.push_back(BatchJob{"locked", 2024, {"locked.csv"}});
+    jobs.push_back(BatchJob{"foreign", 2024, {"foreign.csv"}});
+    for (int index = 0; index < 4; ++index) {
+        jobs.push_back(BatchJob{"client" + std::to_string(index), 2024,
+                                {"US00000000" + std::to_string(10 + index) + ".csv"}});
+    }
+
+    // One slot at a time: a slot leaked by a failed job would stall admission forever.
+    ThreadPool pool{2};
+    BatchOptions options;
+    options.mMaxConcurrentJobs = 1;
+    const auto batch = BatchProcessor{pool, resolver}.run(jobs, options);
+
+    EXPECT_EQ(batch.mJobs[0].mStatus, BatchJobStatus::Failed);
+    EXPECT_EQ(batch.mJobs[0].mError, "resolver unavailable");
+    EXPECT_EQ(batch.mJobs[1].mStatus, BatchJobStatus::Failed);
+    EXPECT_EQ(batch.mJobs[1].mError, "Unknown error");
+    EXPECT_EQ(batch.mSummary.mCompletedCount, 4U);
+    EXPECT_EQ(batch.mSummary.mFailedCount, 2U);
+}
+
+TEST(BatchProcessorTest, ScopesAuditLogPerJobIncludingCacheHits) {
+    // Same holding for both taxpayers; one job at a time, so the second is a cache hit.
+    std::vector<BatchJob> jobs;
+    jobs.push_back(BatchJob{"alice", 2024, {"US0000000042.csv"}});
+    jobs.push_back(BatchJob{"bob", 2024, {"US0000000042.csv"}});
+
+    ThreadPool pool{2};
+    TaxResultCache cache{1 << 20};
+    MatchAuditLog auditLog;
+    BatchOptions options;
+    options.mMaxConcurrentJobs = 1;
+    options.mCache = &cache;
+    options.mAuditLog = &auditLog;
+    const auto batch = BatchProcessor{pool, CsvResolver()}.run(jobs, options);
+    ASSERT_EQ(batch.mSummary.mCompletedCount, 2U);
+    EXPECT_EQ(cache.hitCount(), 1U);
+
+    EXPECT_EQ(auditLog.entryCount(), 2U);
+    for (const auto& job : jobs) {
+        const auto entries =
+            auditLog.query(BatchAuditScope(job), "US0000000042", Date::min(), Date::max());
+        ASSERT_EQ(entries.size(), 1U) << job.mTaxpayerId;
+        EXPECT_EQ(entries[0].mSellDate, MakeDate(2024, 2, 1));
+        EXPECT_EQ(entries[0].mBuyDate, MakeDate(2023, 2, 1));
+    }
+}
+
+TEST(BatchProcessorTest, MemoryBudgetLimitsConcurrentJobs) {
+    const auto directory = std::filesystem::temp_directory_path() / "taxbroker_batch_test";
+    std::filesystem::create_directories(directory);
+
+    std::vector<BatchJob> jobs;
+    for (int index = 0; index < 6; ++index) {
+        const auto path = directory / ("US00000000" + std::to_string(10 + index) + ".csv");
+        std::ofstream{path} << std::string(1000, 'x');
+        jobs.push_back(BatchJob{"client" + std::to_string(index), 2024, {path}});
+    }
+
+    ThreadPool pool{4};
+    BatchOptions options;
+    options.mMemoryBudgetBytes = 2 * 1000 * BatchProcessor::MEMORY_PER_INPUT_BYTE;
+    const auto batch = BatchProcessor{pool, CsvResolver()}.run(jobs, options);
+
+    EXPECT_EQ(batch.mSummary.mCompletedCount, 6U);
+    EXPECT_LE(batch.mSummary.mPeakConcurrentJobs, 2U);
+    EXPECT_LE(batch.mSummary.mPeakReservedBytes, options.mMemoryBudgetBytes);
+    EXPECT_EQ(batch.mJobs[0].mInputBytes, 1000U);
+
+    std::filesystem::remove_all(directory);
+}
+
+} // namespace
+} // namespace taxbroker
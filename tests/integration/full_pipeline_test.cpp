@@ -0,0 +1,440 @@
+#include <gtest/gtest.h>
+
+#include "generators/dho_generator.hpp"
+#include "generators/div_generator.hpp"
+#include "generators/form_generator.hpp"
+#include "generators/kdvp_generator.hpp"
+#include "processors/report_processor.hpp"
+#include "utils/date_utils.hpp"
+
+#include <chrono>
+#include <future>
+
+namespace taxbroker {
+namespace {
+
+// Returns a prepared statement instead of reading the file.
+class FakeParser final : public CsvParser {
+  public:
+    explicit FakeParser(ParseResult aResult) : mResult(std::move(aResult)) {}
+
+    ParseResult parse(const std::filesystem::path& aCsvPath) override {
+        (void)aCsvPath;
+        return mResult;
+    }
+
+  private:
+    ParseResult mResult;
+};
+
+TradeTransaction MakeTrade(Date aDate, TradeSide aSide, Money aUnitPrice, Units aUnits,
+                           Currency aCurrency = Currency::EUR) {
+    return TradeTransaction{aDate, aSide, aUnitPrice, aUnits, aCurrency};
+}
+
+ParseResult MakeStatement(std::size_t aInstrumentCount) {
+    ParseResult result;
+    for (std::size_t index = 0; index < aInstrumentCount; ++index) {
+        TradeInstrument instrument;
+        instrument.mIsin = "US00000000" + std::to_string(10 + index);
+        for (int trade = 0; trade < 20; ++trade) {
+            const auto side = trade % 4 == 3 ? TradeSide::Sell : TradeSide::Buy;
+            instrument.mTransactions.push_back(
+                MakeTrade(MakeDate(2023, 1, 1) + DayDuration{trade * 30}, side,
+                          (100 + trade) * MONEY_SCALE, UNITS_SCALE));
+        }
+        result.mStatement.mTradeInstruments.push_back(std::move(instrument));
+    }
+    return result;
+}
+
+TEST(FullPipelineTest, PipelinedRunEqualsSequentialRun) {
+    ThreadPool pool{6};
+    ReportProcessor processor{pool};
+
+    ReportOptions options;
+    options.mTaxYear = 2024;
+    options.mQueueCapacity = 2;
+    const auto pipelined = processor.process(MakeStatement(40), options);
+
+    options.mMode = PipelineMode::Sequential;
+    const auto sequential = processor.process(MakeStatement(40), options);
+
+    ASSERT_EQ(pipelined.mInstruments.size(), 40U);
+    ASSERT_EQ(sequential.mInstruments.size(), 40U);
+    for (std::size_t index = 0; index < pipelined.mInstruments.size(); ++index) {
+        const auto& left = pipelined.mInstruments[index].mTax;
+        const auto& right = sequential.mInstruments[index].mTax;
+        EXPECT_EQ(left.mIsin, right.mIsin);
+        ASSERT_EQ(left.mSales.size(), right.mSales.size());
+        EXPECT_EQ(left.mHoldingPeriods.mGains, right.mHoldingPeriods.mGains);
+    }
+}
+
+TEST(FullPipelineTest, PipelinedRunInsidePoolTaskOnSaturatedPool) {
+    constexpr std::size_t kWorkerCount = ReportProcessor::PIPELINE_STAGE_COUNT + 1;
+    ThreadPool pool{kWorkerCount};
+    ReportProcessor processor{pool};
+
+    // The pool has a worker per stage, but all are parked except the one running the caller.
+    std::promise<void> release;
+    const auto gate = release.get_future().share();
+    std::vector<std::future<void>> blockers;
+    for (std::size_t worker = 1; worker < kWorkerCount; ++worker) {
+        blockers.push_back(pool.submit([gate]() { gate.wait(); }));
+    }
+
+    ReportOptions options;
+    options.mTaxYear = 2024;
+    options.mQueueCapacity = 2;
+    auto run = pool.submit([&]() { return processor.process(MakeStatement(20), options); });
+
+    const bool finished = run.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+    release.set_value();
+    for (auto& blocker : blockers) {
+        blocker.get();
+    }
+    ASSERT_TRUE(finished);
+    EXPECT_EQ(run.get().mInstruments.size(), 20U);
+}
+
+TEST(FullPipelineTest, MergesSourcesAndAppliesFxAndCorporateActions) {
+    ParseResult first;
+    TradeInstrument buys;
+    buys.mIsin = "US0378331005";
+    buys.mTransactions.push_back(MakeTrade(MakeDate(2023, 5, 2), TradeSide::Buy,
+                                           200 * MONEY_SCALE, 2 * UNITS_SCALE, Currency::USD));
+    first.mStatement.mTradeInstruments.push_back(buys);
+
+    ParseResult second;
+    TradeInstrument sells;
+    sells.mIsin = "US0378331005";
+    sells.mTransactions.push_back(MakeTrade(MakeDate(2024, 7, 1), TradeSide::Sell,
+                                            60 * MONEY_SCALE, 8 * UNITS_SCALE));
+    sells.mCorporateActions.push_back(
+        CorporateAction{MakeDate(2024, 1, 2), CorporateActionType::Split, 4 * CORP_RATIO_SCALE});
+    second.mStatement.mTradeInstruments.push_back(sells);
+
+    FxRateTable rates;
+    rates.addRate(Currency::USD, MakeDate(2023, 5, 1), 2 * FX_RATE_SCALE);
+
+    const std::vector<ReportSource> sources{
+        {"first.csv", std::make_shared<FakeParser>(first)},
+        {"second.csv", std::make_shared<FakeParser>(second)},
+    };
+
+    ThreadPool pool{2};
+    ReportOptions options;
+    options.mTaxYear = 2024;
+    options.mFxRates = &rates;
+    const auto report = ReportProcessor{pool}.process(sources, options);
+
+    ASSERT_EQ(report.mInstruments.size(), 1U);
+    const auto& tax = report.mInstruments[0].mTax;
+    ASSERT_EQ(tax.mSales.size(), 1U);
+    EXPECT_EQ(tax.mSales[0].mUnits, 8 * UNITS_SCALE);
+    EXPECT_EQ(tax.mSales[0].mCostBasis, 200 * MONEY_SCALE);
+    EXPECT_EQ(tax.mSales[0].mProceeds, 480 * MONEY_SCALE);
+    EXPECT_TRUE(report.mWarnings.empty());
+}
+
+TEST(FullPipelineTest, SkipsInstrumentsAndDividendsOutsideTaxYear) {
+    ParseResult parsed;
+    TradeInstrument held;
+    held.mIsin = "US0378331005";
+    held.mName = "Apple";
+    held.mTransactions.push_back(
+        MakeTrade(MakeDate(2024, 3, 1), TradeSide::Buy, 100 * MONEY_SCALE, UNITS_SCALE));
+    held.mTransactions.push_back(
+        MakeTrade(MakeDate(2023, 3, 1), TradeSide::Sell, 100 * MONEY_SCALE, UNITS_SCALE));
+    parsed.mStatement.mTradeInstruments.push_back(held);
+
+    DividendInstrument payer;
+    payer.mIsin = "US5949181045";
+    payer.mTransactions = {
+        DividendTransaction{MakeDate(2024, 6, 1), 3 * MONEY_SCALE, 0, Currency::EUR},
+        DividendTransaction{MakeDate(2023, 6, 1), 2 * MONEY_SCALE, 0, Currency::EUR},
+    };
+    parsed.mStatement.mDividendInstruments.push_back(payer);
+
+    ThreadPool pool{2};
+    ReportOptions options;
+    options.mTaxYear = 2024;
+    const auto report = ReportProcessor{pool}.process(std::move(parsed), options);
+
+    ASSERT_EQ(report.mInstruments.size(), 1U);
+    EXPECT_EQ(report.mInstruments[0].mTax.mIsin, "US0378331005");
+    EXPECT_EQ(report.mInstruments[0].mTax.mName, "Apple");
+    EXPECT_TRUE(report.mInstruments[0].mTax.mSales.empty());
+    EXPECT_TRUE(report.mInstruments[0].mMatches.mMatches.empty());
+    EXPECT_TRUE(report.mWarnings.empty()); // The 2023 short sale is never matched.
+
+    ASSERT_EQ(report.mDividends.mGroups.size(), 1U);
+    EXPECT_EQ(report.mDividends.mGrossTotal, 3 * MONEY_SCALE);
+}
+
+TEST(FullPipelineTest, CacheRecomputesOnlyChangedInstruments) {
+    ThreadPool pool{6};
+    ReportProcessor processor{pool};
+    TaxResultCache cache{16 << 20};
+
+    ReportOptions options;
+    options.mTaxYear = 2024;
+    options.mCache = &cache;
+    const auto draft = processor.process(MakeStatement(10), options);
+    EXPECT_EQ(cache.size(), 10U);
+    EXPECT_EQ(cache.hitCount(), 0U);
+
+    auto revised = MakeStatement(10);
+    revised.mStatement.mTradeInstruments[3].mTransactions.back().mUnitPrice += MONEY_SCALE;
+    const auto final = processor.process(std::move(revised), options);
+
+    EXPECT_EQ(cache.hitCount(), 9U);
+    EXPECT_EQ(cache.missCount(), 11U);
+    ASSERT_EQ(final.mInstruments.size(), 10U);
+    for (std::size_t index = 0; index < final.mInstruments.size(); ++index) {
+        EXPECT_EQ(final.mInstruments[index].mTax.mIsin, draft.mInstruments[index].mTax.mIsin);
+        EXPECT_EQ(final.mInstruments[index].mMatches.mMatches.size(),
+                  draft.mInstruments[index].mMatches.mMatches.size());
+    }
+}
+
+TEST(FullPipelineTest, MultiYearRunEqualsSingleYearRuns) {
+    ThreadPool pool{6};
+    ReportProcessor processor{pool};
+
+    ReportOptions options;
+    options.mTaxYear = 2022;
+    options.mLastTaxYear = 2025;
+    const auto reports = processor.processYears(MakeStatement(12), options);
+
+    ASSERT_EQ(reports.size(), 4U);
+    for (std::size_t slot = 0; slot < reports.size(); ++slot) {
+        ReportOptions single;
+        single.mTaxYear = 2022 + static_cast<int>(slot);
+        const auto expected = processor.process(MakeStatement(12), single);
+
+        const auto& report = reports[slot];
+        EXPECT_EQ(report.mTaxYear, single.mTaxYear);
+        ASSERT_EQ(report.mInstruments.size(), expected.mInstruments.size());
+        for (std::size_t index = 0; index < report.mInstruments.size(); ++index) {
+            const auto& actual = report.mInstruments[index];
+            const auto& reference = expected.mInstruments[index];
+            EXPECT_EQ(actual.mTax.mTaxYear, single.mTaxYear);
+            ASSERT_EQ(actual.mTax.mSales.size(), reference.mTax.mSales.size());
+            EXPECT_EQ(actual.mTax.mHoldingPeriods.mGains, reference.mTax.mHoldingPeriods.mGains);
+            EXPECT_EQ(actual.mMatches.mMatches.size(), reference.mMatches.mMatches.size());
+            if (!reference.mTax.mSales.empty()) {
+                EXPECT_EQ(actual.mMatches.mOpenLots.size(), reference.mMatches.mOpenLots.size());
+            }
+            for (const auto& match : actual.mMatches.mMatches) {
+                EXPECT_EQ(YearOf(match.mSellDate), single.mTaxYear);
+            }
+        }
+    }
+
+    // The last trades are in 2024; the quiet year 2025 inherits that year's open lots.
+    ReportOptions lastActive;
+    lastActive.mTaxYear = 2024;
+    const auto finalLots =
+        processor.process(MakeStatement(1), lastActive).mInstruments[0].mMatches.mOpenLots;
+    EXPECT_FALSE(reports[1].mInstruments[0].mMatches.mOpenLots.empty());
+    EXPECT_EQ(reports[3].mInstruments[0].mMatches.mOpenLots.size(), finalLots.size());
+}
+
+TEST(FullPipelineTest, CachesEveryYearOfMultiYearRun) {
+    ThreadPool pool{2};
+    ReportProcessor processor{pool};
+    TaxResultCache cache{16 << 20};
+
+    ReportOptions options;
+    options.mTaxYear = 2023;
+    options.mLastTaxYear = 2024;
+    options.mCache = &cache;
+    const auto computed = processor.processYears(MakeStatement(10), options);
+    EXPECT_EQ(cache.size(), 20U);
+
+    const auto cached = processor.processYears(MakeStatement(10), options);
+    EXPECT_EQ(cache.hitCount(), 20U);
+    ASSERT_EQ(cached.size(), 2U);
+    for (std::size_t slot = 0; slot < cached.size(); ++slot) {
+        ASSERT_EQ(cached[slot].mInstruments.size(), 10U);
+        for (std::size_t index = 0; index < 10; ++index) {
+            const auto& left = cached[slot].mInstruments[index];
+            const auto& right = computed[slot].mInstruments[index];
+            EXPECT_EQ(left.mTax.mTaxYear, right.mTax.mTaxYear);
+            EXPECT_EQ(left.mMatches.mMatches.size(), right.mMatches.mMatches.size());
+            EXPECT_EQ(left.mMatches.mOpenLots.size(), right.mMatches.mOpenLots.size());
+        }
+    }
+}
+
+TEST(FullPipelineTest, CachedYearKeepsUnmatchedSellOfItsHistory) {
+    ParseResult parsed;
+    TradeInstrument instrument;
+    instrument.mIsin = "US0000000099";
+    instrument.mTransactions = {
+        MakeTrade(MakeDate(2022, 2, 1), TradeSide::Buy, 100 * MONEY_SCALE, UNITS_SCALE),
+        MakeTrade(MakeDate(2022, 6, 1), TradeSide::Sell, 110 * MONEY_SCALE, 3 * UNITS_SCALE),
+    };
+    parsed.mStatement.mTradeInstruments.push_back(std::move(instrument));
+
+    ThreadPool pool{2};
+    ReportProcessor processor{pool};
+    ReportOptions single;
+    single.mTaxYear = 2022;
+    const auto fresh = processor.process(parsed, single);
+    ASSERT_EQ(fresh.mWarnings.size(), 1U);
+    EXPECT_EQ(fresh.mInstruments[0].mMatches.mUnmatchedSellUnits, 2 * UNITS_SCALE);
+
+    // The range run fills the cache for 2022; the single year is then served from it.
+    TaxResultCache cache{16 << 20};
+    ReportOptions range;
+    range.mTaxYear = 2022;
+    range.mLastTaxYear = 2024;
+    range.mCache = &cache;
+    (void)processor.processYears(parsed, range);
+    single.mCache = &cache;
+    const auto cached = processor.process(parsed, single);
+
+    EXPECT_EQ(cache.hitCount(), 1U);
+    ASSERT_EQ(cached.mWarnings.size(), 1U);
+    EXPECT_EQ(cached.mWarnings[0].mCode, ProcessingWarningCode::UnmatchedSell);
+    EXPECT_EQ(cached.mInstruments[0].mMatches.mUnmatchedSellUnits, 2 * UNITS_SCALE);
+}
+
+// Twelve traded instruments, one dividend payer and interest, reported for 2024.
+FinalReport MakeFormReport(ThreadPool& aPool) {
+    ParseResult parsed = MakeStatement(12);
+    DividendInstrument payer;
+    payer.mIsin = "US5949181045";
+    payer.mName = "Microsoft";
+    payer.mTransactions = {
+        DividendTransaction{MakeDate(2024, 6, 13), 1234567, 185185, Currency::EUR},
+    };
+    parsed.mStatement.mDividendInstruments.push_back(payer);
+    parsed.mStatement.mInterestTransactions = {
+        InterestTransaction{MakeDate(2024, 1, 31), 42 * MONEY_SCALE, 0, Currency::EUR},
+        InterestTransaction{MakeDate(2024, 2, 29), 38 * MONEY_SCALE, 0, Currency::EUR},
+        InterestTransaction{MakeDate(2023, 12, 31), 40 * MONEY_SCALE, 0, Currency::EUR},
+    };
+
+    ReportOptions options;
+    options.mTaxYear = 2024;
+    return ReportProcessor{aPool}.process(std::move(parsed), options);
+}
+
+TEST(FullPipelineTest, GeneratesAllFormsConcurrentlyFromOneReport) {
+    ThreadPool pool{4};
+    const auto report = MakeFormReport(pool);
+
+    FormData form;
+    form.mYear = 2024;
+    TaxPayer taxPayer;
+    taxPayer.mTaxNumber = "12345678";
+
+    const auto forms = GenerateForms(report, form, taxPayer, pool);
+    ASSERT_TRUE(forms.mKdvp && forms.mDiv && forms.mDho);
+    EXPECT_TRUE(forms.mValidationErrors.empty()) << forms.mValidationErrors.front();
+    EXPECT_EQ(*forms.mKdvp, GenerateKdvp(BuildKdvpData(report, form), taxPayer));
+    EXPECT_EQ(*forms.mDiv, GenerateDiv(BuildDivData(report, form), taxPayer));
+    EXPECT_EQ(*forms.mDho, GenerateDho(BuildDhoData(report, form), taxPayer));
+
+    // Every instrument sells in 2024; the running stock of the reported rows ends at zero.
+    const auto kdvp = BuildKdvpData(report, form);
+    ASSERT_EQ(kdvp.mItems.size(), 12U);
+    const auto& rows = kdvp.mItems[0].mSecurities->mRows;
+    ASSERT_FALSE(rows.empty());
+    ASSERT_TRUE(rows.back().has(KdvpRow::F8));
+    EXPECT_EQ(rows.back().mF8, 0);
+    EXPECT_NE(forms.mKdvp->find("<SecurityCount>12</SecurityCount>"), std::string::npos);
+
+    EXPECT_NE(forms.mDiv->find("<Dividend><Date>2024-06-13</Date><PayerIdentificationNumber>"
+                               "US5949181045</PayerIdentificationNumber><PayerName>Microsoft"
+                               "</PayerName><PayerCountry>US</PayerCountry><Type>1</Type>"
+                               "<Value>123.46</Value><ForeignTax>18.52</ForeignTax>"),
+              std::string::npos);
+    EXPECT_NE(forms.mDho->find("<Doh_DHO_Totals><TotalInterestEarned>80.00</TotalInterestEarned>"),
+              std::string::npos);
+
+    const FormSelection selection{.mKdvp = true, .mDiv = false, .mDho = false};
+    const auto kdvpOnly = GenerateForms(report, form, taxPayer, pool, selection);
+    EXPECT_TRUE(kdvpOnly.mKdvp);
+    EXPECT_FALSE(kdvpOnly.mDiv || kdvpOnly.mDho);
+}
+
+TEST(FullPipelineTest, FormsLeaveOutAmountsWithoutFxRate) {
+    // Instruments 0 and 1 trade in EUR; instrument 1 sells once in USD, without a rate.
+    ParseResult parsed = MakeStatement(2);
+    parsed.mStatement.mTradeInstruments[1].mTransactions.back().mCurrency = Currency::USD;
+    DividendInstrument payer;
+    payer.mIsin = "US5949181045";
+    payer.mTransactions = {
+        DividendTransaction{MakeDate(2024, 6, 13), 1234567, 185185, Currency::USD},
+    };
+    parsed.mStatement.mDividendInstruments.push_back(payer);
+    parsed.mStatement.mInterestTransactions = {
+        InterestTransaction{MakeDate(2024, 1, 31), 42 * MONEY_SCALE, 0, Currency::EUR},
+        InterestTransaction{MakeDate(2024, 2, 29), 38 * MONEY_SCALE, 0, Currency::USD},
+    };
+
+    ThreadPool pool{2};
+    const FxRateTable rates;
+    ReportOptions options;
+    options.mTaxYear = 2024;
+    options.mFxRates = &rates;
+    const auto report = ReportProcessor{pool}.process(std::move(parsed), options);
+    EXPECT_EQ(report.mWarnings.size(), 3U); // One MissingFxRate per unconverted entry.
+
+    FormData form;
+    form.mYear = 2024;
+    const auto kdvp = BuildKdvpData(report, form);
+    ASSERT_EQ(kdvp.mItems.size(), 1U);
+    EXPECT_EQ(kdvp.mItems[0].mSecurities->mIsin, report.mInstruments[0].mMatches.mIsin);
+    EXPECT_TRUE(BuildDivData(report, form).mItems.empty());
+    const auto dho = BuildDhoData(report, form);
+    ASSERT_EQ(dho.mItems.size(), 1U);
+    EXPECT_EQ(dho.mItems[0].mAmount, 42 * MONEY_SCALE);
+}
+
+TEST(FullPipelineTest, StreamsFormBundleIntoZip) {
+    ThreadPool pool{4};
+    const auto report = MakeFormReport(pool);
+    FormData form;
+    form.mYear = 2024;
+    TaxPayer taxPayer;
+    taxPayer.mTaxNumber = "12345678";
+    const auto forms = GenerateForms(report, form, taxPayer, pool);
+
+    std::string archive;
+    ZipWriter zip{archive};
+    const auto errors = WriteFormBundle(zip, report, form, taxPayer, pool);
+    EXPECT_TRUE(zip.finish());
+    EXPECT_TRUE(errors.empty()) << errors.front();
+    EXPECT_EQ(zip.entryCount(), 4U);
+
+    // Entries are stored, so every document appears verbatim after its local header.
+    const auto kdvp = archive.find(*forms.mKdvp);
+    const auto div = archive.find(*forms.mDiv);
+    const auto dho = archive.find(*forms.mDho);
+    ASSERT_NE(kdvp, std::string::npos);
+    ASSERT_NE(div, std::string::npos);
+    ASSERT_NE(dho, std::string::npos);
+    EXPECT_EQ(archive.substr(kdvp - BUNDLE_KDVP_ENTRY.size(), BUNDLE_KDVP_ENTRY.size()),
+              BUNDLE_KDVP_ENTRY);
+    EXPECT_LT(kdvp, div);
+    EXPECT_LT(div, dho);
+
+    const auto audit = archive.find("isin,sell_index,buy_index,buy_date,sell_date,units,");
+    ASSERT_NE(audit, std::string::npos);
+    EXPECT_GT(audit, dho);
+    const auto& match = report.mInstruments[0].mMatches.mMatches.front();
+    EXPECT_NE(archive.find(report.mInstruments[0].mMatches.mIsin + "," +
+                               std::to_string(match.mSellIndex) + "," +
+                               std::to_string(match.mBuyIndex) + ",",
+                           audit),
+              std::string::npos);
+}
+
+} // namespace
+} // namespace taxbroker
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include "server/api/report_api.hpp"
+#include "utils/date_utils.hpp"
+
+namespace taxbroker {
+namespace {
+
+// One instrument bought in 2023 and sold in 2024, whatever the path.
+class FakeParser final : public CsvParser {
+  public:
+    ParseResult parse(const std::filesystem::path& aCsvPath) override {
+        (void)aCsvPath;
+        TradeInstrument instrument;
+        instrument.mIsin = "IE00B4L5Y983";
+        instrument.mName = "iShares Core MSCI World";
+        instrument.mTransactions = {
+            TradeTransaction{MakeDate(2023, 3, 1), TradeSide::Buy, 70 * MONEY_SCALE,
+                             2 * UNITS_SCALE, Currency::EUR},
+            TradeTransaction{MakeDate(2024, 5, 2), TradeSide::Sell, 90 * MONEY_SCALE,
+                             UNITS_SCALE, Currency::EUR},
+        };
+
+        ParseResult result;
+        result.mStatement.mTradeInstruments.push_back(std::move(instrument));
+        return result;
+    }
+};
+
+ReportRequest MakeRequest() {
+    ReportRequest request;
+    request.mSources.push_back(ReportSource{"export.csv", std::make_shared<FakeParser>()});
+    request.mOptions.mTaxYear = 2024;
+    request.mTaxPayer.mTaxNumber = "12345678";
+    request.mSelection = FormSelection{.mKdvp = true, .mDiv = true, .mDho = false};
+    return request;
+}
+
+TEST(ReportApiTest, ProcessesSourcesAndRendersSelectedForms) {
+    ThreadPool pool{2};
+    FragmentCache kdvpCache{1 << 20};
+    ReportApi api{pool, &kdvpCache};
+
+    const auto request = MakeRequest();
+    const auto response = api.generate(request);
+    ASSERT_EQ(response.mReport.mInstruments.size(), 1U);
+    EXPECT_EQ(response.mReport.mInstruments[0].mTax.mSales.size(), 1U);
+    ASSERT_TRUE(response.mForms.mKdvp && response.mForms.mDiv);
+    EXPECT_FALSE(response.mForms.mDho);
+    EXPECT_TRUE(response.mForms.mValidationErrors.empty())
+        << response.mForms.mValidationErrors.front();
+    EXPECT_NE(response.mForms.mKdvp->find("<Year>2024</Year>"), std::string::npos);
+    EXPECT_NE(response.mForms.mKdvp->find("IE00B4L5Y983"), std::string::npos);
+    EXPECT_GT(kdvpCache.size(), 0U);
+}
+
+TEST(ReportApiTest, StreamsSelectedFormsAsBundle) {
+    ThreadPool pool{2};
+    ReportApi api{pool};
+
+    std::string archive;
+    ZipWriter zip{archive};
+    const auto response = api.bundle(MakeRequest(), zip);
+    EXPECT_TRUE(response.mWritten);
+    ASSERT_EQ(response.mReport.mInstruments.size(), 1U);
+    EXPECT_TRUE(response.mValidationErrors.empty()) << response.mValidationErrors.front();
+    EXPECT_EQ(zip.entryCount(), 3U); // Doh-KDVP, Doh-Div and the audit trail.
+    EXPECT_NE(archive.find(BUNDLE_KDVP_ENTRY), std::string::npos);
+    EXPECT_NE(archive.find(BUNDLE_DIV_ENTRY), std::string::npos);
+    EXPECT_EQ(archive.find(BUNDLE_DHO_ENTRY), std::string::npos);
+    EXPECT_NE(archive.find("<Year>2024</Year>"), std::string::npos);
+    EXPECT_NE(archive.find("IE00B4L5Y983"), std::string::npos);
+}
+
+} // namespace
+} // namespace taxbroker
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include "processors/corporate_actions.hpp"
+#include "utils/date_utils.hpp"
+
+#include <stdexcept>
+
+namespace taxbroker {
+namespace {
+
+TradeTransaction MakeBuy(Date aDate, Money aUnitPrice, Units aUnits) {
+    return TradeTransaction{aDate, TradeSide::Buy, aUnitPrice, aUnits, Currency::EUR};
+}
+
+TEST(CorporateActionTableTest, EmptyTableLeavesTransactionsUntouched) {
+    const CorporateActionTable table;
+    const auto buy = MakeBuy(MakeDate(2020, 1, 10), 100 * MONEY_SCALE, 3 * UNITS_SCALE);
+
+    const auto restated = table.restate(buy);
+
+    EXPECT_EQ(restated.mUnits, buy.mUnits);
+    EXPECT_EQ(restated.mUnitPrice, buy.mUnitPrice);
+}
+
+TEST(CorporateActionTableTest, AppliesOnlyActionsAfterTradeDate) {
+    const std::vector<CorporateAction> actions{
+        {MakeDate(2022, 6, 1), CorporateActionType::ReverseSplit, 3 * CORP_RATIO_SCALE},
+        {MakeDate(2021, 3, 1), CorporateActionType::Split, 4 * CORP_RATIO_SCALE},
+    };
+    const CorporateActionTable table{actions};
+
+    const auto beforeBoth = table.factorAfter(MakeDate(2020, 1, 1));
+    EXPECT_EQ(beforeBoth.mNumerator, 4);
+    EXPECT_EQ(beforeBoth.mDenominator, 3);
+
+    const auto onSplitDate = table.factorAfter(MakeDate(2021, 3, 1));
+    EXPECT_EQ(onSplitDate.mNumerator, 1);
+    EXPECT_EQ(onSplitDate.mDenominator, 3);
+
+    const auto afterBoth = table.factorAfter(MakeDate(2023, 1, 1));
+    EXPECT_EQ(afterBoth.mNumerator, 1);
+    EXPECT_EQ(afterBoth.mDenominator, 1);
+}
+
+TEST(CorporateActionTableTest, RestatesUnitsAndPriceKeepingCostBasis) {
+    const std::vector<CorporateAction> actions{
+        {MakeDate(2021, 3, 1), CorporateActionType::Split, 4 * CORP_RATIO_SCALE},
+    };
+    const CorporateActionTable table{actions};
+
+    const auto restated =
+        table.restate(MakeBuy(MakeDate(2020, 5, 5), 200 * MONEY_SCALE, 10 * UNITS_SCALE));
+
+    EXPECT_EQ(restated.mUnits, 40 * UNITS_SCALE);
+    EXPECT_EQ(restated.mUnitPrice, 50 * MONEY_SCALE);
+}
+
+TEST(CorporateActionTableTest, RestateTransactionsCopiesInstrumentHistory) {
+    TradeInstrument instrument;
+    instrument.mIsin = "US0000000001";
+    instrument.mTransactions = {
+        MakeBuy(MakeDate(2019, 1, 2), 90 * MONEY_SCALE, 2 * UNITS_SCALE),
+        MakeBuy(MakeDate(2023, 1, 2), 30 * MONEY_SCALE, 1 * UNITS_SCALE),
+    };
+    instrument.mCorporateActions = {
+        {MakeDate(2020, 1, 1), CorporateActionType::Merger, CORP_RATIO_SCALE / 2},
+    };
+
+    const auto restated = RestateTransactions(instrument);
+
+    ASSERT_EQ(restated.size(), 2U);
+    EXPECT_EQ(restated[0].mUnits, 1 * UNITS_SCALE);
+    EXPECT_EQ(restated[0].mUnitPrice, 180 * MONEY_SCALE);
+    EXPECT_EQ(restated[1].mUnits, 1 * UNITS_SCALE);
+    EXPECT_EQ(instrument.mTransactions[0].mUnits, 2 * UNITS_SCALE);
+}
+
+TEST(CorporateActionTableTest, RejectsFactorsThatOverflow) {
+    // Denominators of 1e8 with coprime numerators stop fitting after the third action.
+    const std::vector<CorporateAction> actions{
+        {MakeDate(2020, 1, 1), CorporateActionType::Merger, CORP_RATIO_SCALE + 1},
+        {MakeDate(2021, 1, 1), CorporateActionType::Merger, CORP_RATIO_SCALE + 3},
+        {MakeDate(2022, 1, 1), CorporateActionType::Merger, CORP_RATIO_SCALE + 7},
+    };
+
+    EXPECT_THROW(CorporateActionTable{actions}, std::overflow_error);
+}
+
+} // namespace
+} // namespace taxbroker
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include "taxbroker/types.hpp"
+#include "utils/decimal_format.hpp"
+
+#include <array>
+#include <limits>
+#include <string>
+
+namespace taxbroker {
+namespace {
+
+std::string Format(std::int64_t aValue, int aScaleDigits, int aPrecision) {
+    std::array<char, DECIMAL_BUFFER_SIZE> buffer;
+    return std::string{FormatDecimal(aValue, aScaleDigits, aPrecision, buffer.data())};
+}
+
+TEST(DecimalFormatTest, WritesExactScaleDigits) {
+    EXPECT_EQ(Format(123456, MONEY_SCALE_DIGITS, 4), "12.3456");
+    EXPECT_EQ(Format(UNITS_SCALE + 5, UNITS_SCALE_DIGITS, 8), "1.00000005");
+    EXPECT_EQ(Format(0, MONEY_SCALE_DIGITS, 4), "0.0000");
+    EXPECT_EQ(Format(-7, MONEY_SCALE_DIGITS, 4), "-0.0007");
+    EXPECT_EQ(Format(1234567890, 0, 0), "1234567890");
+}
+
+TEST(DecimalFormatTest, PadsExtraPrecision) {
+    EXPECT_EQ(Format(2505000, MONEY_SCALE_DIGITS, 8), "250.50000000");
+    EXPECT_EQ(Format(42, 0, 2), "42.00");
+}
+
+TEST(DecimalFormatTest, RoundsHalfAwayFromZero) {
+    EXPECT_EQ(Format(23450, MONEY_SCALE_DIGITS, 2), "2.35");
+    EXPECT_EQ(Format(-23450, MONEY_SCALE_DIGITS, 2), "-2.35");
+    EXPECT_EQ(Format(23449, MONEY_SCALE_DIGITS, 2), "2.34");
+    EXPECT_EQ(Format(99995, MONEY_SCALE_DIGITS, 2), "10.00");
+    EXPECT_EQ(Format(5 * MONEY_SCALE / 10, MONEY_SCALE_DIGITS, 0), "1");
+    EXPECT_EQ(Format(-49, MONEY_SCALE_DIGITS, 2), "0.00");
+}
+
+TEST(DecimalFormatTest, HandlesInt64Extremes) {
+    EXPECT_EQ(Format(std::numeric_limits<std::int64_t>::max(), 8, 8),
+              "92233720368.54775807");
+    EXPECT_EQ(Format(std::numeric_limits<std::int64_t>::min(), 0, 18),
+              "-9223372036854775808.000000000000000000");
+}
+
+} // namespace
+} // namespace taxbroker
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include "processors/dividend_aggregator.hpp"
+#include "utils/date_utils.hpp"
+
+namespace taxbroker {
+namespace {
+
+DividendTransaction MakeDividend(Date aDate, Money aGross, Money aTaxPaid) {
+    return DividendTransaction{aDate, aGross, aTaxPaid, Currency::EUR};
+}
+
+TEST(DividendAggregatorTest, GroupsByPayerAndDay) {
+    DividendInstrument microsoft;
+    microsoft.mIsin = "US5949181045";
+    microsoft.mName = "Microsoft";
+    microsoft.mTransactions = {
+        MakeDividend(MakeDate(2024, 6, 13), 10 * MONEY_SCALE, 15 * MONEY_SCALE / 10),
+        MakeDividend(MakeDate(2024, 3, 14), 8 * MONEY_SCALE, 12 * MONEY_SCALE / 10),
+        MakeDividend(MakeDate(2024, 6, 13), 5 * MONEY_SCALE, 0),
+    };
+
+    DividendInstrument allianz;
+    allianz.mIsin = "DE0008404005";
+    allianz.mName = "Allianz";
+    allianz.mTransactions = {
+        MakeDividend(MakeDate(2024, 5, 10), 30 * MONEY_SCALE, 79 * MONEY_SCALE / 10),
+    };
+
+    const std::vector<DividendInstrument> instruments{microsoft, allianz};
+    const auto aggregation = AggregateDividends(instruments);
+
+    ASSERT_EQ(aggregation.mGroups.size(), 3U);
+    EXPECT_EQ(aggregation.mGroups[0].mIsin, "DE0008404005");
+    EXPECT_EQ(aggregation.mGroups[0].mSourceCountry, "DE");
+
+    const auto& march = aggregation.mGroups[1];
+    EXPECT_EQ(march.mDate, MakeDate(2024, 3, 14));
+    EXPECT_EQ(march.mSourceCountry, "US");
+    EXPECT_EQ(march.mGrossAmount, 8 * MONEY_SCALE);
+
+    const auto& june = aggregation.mGroups[2];
+    EXPECT_EQ(june.mName, "Microsoft");
+    EXPECT_EQ(june.mDate, MakeDate(2024, 6, 13));
+    EXPECT_EQ(june.mGrossAmount, 15 * MONEY_SCALE);
+    EXPECT_EQ(june.mTaxPaid, 15 * MONEY_SCALE / 10);
+    EXPECT_EQ(june.mTransactionCount, 2U);
+
+    EXPECT_EQ(aggregation.mGrossTotal, 53 * MONEY_SCALE);
+    EXPECT_EQ(aggregation.mTaxPaidTotal, 106 * MONEY_SCALE / 10);
+}
+
+TEST(DividendAggregatorTest, MergesPayerSpreadOverInstruments) {
+    DividendInstrument first;
+    first.mIsin = "IE00B4L5Y983";
+    first.mTransactions = {MakeDividend(MakeDate(2024, 1, 2), MONEY_SCALE, 0)};
+    auto second = first;
+
+    const std::vector<DividendInstrument> instruments{first, second};
+    const auto aggregation = AggregateDividends(instruments);
+
+    ASSERT_EQ(aggregation.mGroups.size(), 1U);
+    EXPECT_EQ(aggregation.mGroups[0].mGrossAmount, 2 * MONEY_SCALE);
+    EXPECT_EQ(aggregation.mGroups[0].mTransactionCount, 2U);
+}
+
+TEST(DividendAggregatorTest, KeepsUnconvertedCurrenciesApart) {
+    DividendInstrument payer;
+    payer.mIsin = "US5949181045";
+    payer.mTransactions = {
+        MakeDividend(MakeDate(2024, 6, 13), 10 * MONEY_SCALE, MONEY_SCALE),
+        DividendTransaction{MakeDate(2024, 6, 13), 7 * MONEY_SCALE, 0, Currency::USD},
+    };
+
+    const std::vector<DividendInstrument> instruments{payer};
+    const auto aggregation = AggregateDividends(instruments);
+
+    ASSERT_EQ(aggregation.mGroups.size(), 2U);
+    EXPECT_EQ(aggregation.mGroups[0].mCurrency, Currency::EUR);
+    EXPECT_EQ(aggregation.mGroups[0].mGrossAmount, 10 * MONEY_SCALE);
+    EXPECT_EQ(aggregation.mGroups[1].mCurrency, Currency::USD);
+    EXPECT_EQ(aggregation.mGroups[1].mGrossAmount, 7 * MONEY_SCALE);
+    EXPECT_EQ(aggregation.mGrossTotal, 10 * MONEY_SCALE);
+    EXPECT_EQ(aggregation.mTaxPaidTotal, MONEY_SCALE);
+}
+
+TEST(DividendAggregatorTest, LeavesNonCountryIsinPrefixesWithoutCountry) {
+    DividendInstrument eurobond;
+    eurobond.mIsin = "XS1234567890";
+    eurobond.mTransactions = {MakeDividend(MakeDate(2024, 1, 2), MONEY_SCALE, 0)};
+    DividendInstrument supranational;
+    supranational.mIsin = "EU000A1G0DC6";
+    supranational.mTransactions = {MakeDividend(MakeDate(2024, 1, 3), MONEY_SCALE, 0)};
+
+    const std::vector<DividendInstrument> instruments{eurobond, supranational};
+    const auto aggregation = AggregateDividends(instruments);
+
+    ASSERT_EQ(aggregation.mGroups.size(), 2U);
+    EXPECT_TRUE(aggregation.mGroups[0].mSourceCountry.empty());
+    EXPECT_TRUE(aggregation.mGroups[1].mSourceCountry.empty());
+}
+
+TEST(DividendAggregatorTest, SlicesYearsThroughPrecomputedIndex) {
+    DividendInstrument payer;
+    payer.mIsin = "DE0008404005";
+    payer.mTransactions = {
+        MakeDividend(MakeDate(2023, 5, 10), 2 * MONEY_SCALE, 0),
+        MakeDividend(MakeDate(2024, 5, 10), 3 * MONEY_SCALE, 0),
+    };
+
+    const std::vector<DividendInstrument> instruments{payer};
+    const std::vector<YearIndex> years{YearIndex{payer.mTransactions}};
+
+    EXPECT_EQ(AggregateDividends(instruments, years, 2023).mGrossTotal, 2 * MONEY_SCALE);
+    EXPECT_EQ(AggregateDividends(instruments, years, 2024).mGrossTotal, 3 * MONEY_SCALE);
+    EXPECT_TRUE(AggregateDividends(instruments, years, 2025).mGroups.empty());
+}
+
+TEST(DividendAggregatorTest, EmptyInput) {
+    const auto aggregation = AggregateDividends({});
+    EXPECT_TRUE(aggregation.mGroups.empty());
+    EXPECT_EQ(aggregation.mGrossTotal, 0);
+}
+
+} // namespace
+} // namespace taxbroker
@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+
+#include "core/fifo_snapshot.hpp"
+#include "processors/fifo_matcher.hpp"
+#include "utils/date_utils.hpp"
+
+namespace taxbroker {
+namespace {
+
+TradeTransaction MakeTrade(Date aDate, TradeSide aSide, Money aUnitPrice, Units aUnits) {
+    return TradeTransaction{aDate, aSide, aUnitPrice, aUnits, Currency::EUR};
+}
+
+TEST(LotRingTest, KeepsFifoOrderAcrossGrowthAndWrapAround) {
+    LotRing ring;
+    std::uint32_t nextPushed = 0;
+    std::uint32_t nextPopped = 0;
+
+    for (int round = 0; round < 100; ++round) {
+        for (int push = 0; push < 3; ++push) {
+            OpenLot lot;
+            lot.mTransactionIndex = nextPushed++;
+            ring.pushBack(lot);
+        }
+        for (int pop = 0; pop < 2; ++pop) {
+            ASSERT_EQ(ring.front().mTransactionIndex, nextPopped++);
+            ring.popFront();
+        }
+    }
+
+    EXPECT_EQ(ring.size(), 100U);
+    const auto lots = ring.toVector();
+    for (std::size_t index = 0; index < lots.size(); ++index) {
+        EXPECT_EQ(lots[index].mTransactionIndex, nextPopped + index);
+    }
+}
+
+TEST(FifoMatcherTest, SellConsumesOldestLotsWithPartialOffsets) {
+    TradeInstrument instrument;
+    instrument.mIsin = "IE00B4L5Y983";
+    instrument.mTransactions = {
+        MakeTrade(MakeDate(2024, 1, 2), TradeSide::Buy, 10 * MONEY_SCALE, 5 * UNITS_SCALE),
+        MakeTrade(MakeDate(2024, 2, 2), TradeSide::Buy, 12 * MONEY_SCALE, 5 * UNITS_SCALE),
+        MakeTrade(MakeDate(2024, 3, 2), TradeSide::Sell, 15 * MONEY_SCALE, 7 * UNITS_SCALE),
+        MakeTrade(MakeDate(2024, 4, 2), TradeSide::Sell, 16 * MONEY_SCALE, 1 * UNITS_SCALE),
+    };
+
+    const auto result = FifoMatcher{}.match(instrument);
+
+    ASSERT_EQ(result.mMatches.size(), 3U);
+    EXPECT_EQ(result.mMatches[0].mBuyIndex, 0U);
+    EXPECT_EQ(result.mMatches[0].mUnits, 5 * UNITS_SCALE);
+    EXPECT_EQ(result.mMatches[1].mBuyIndex, 1U);
+    EXPECT_EQ(result.mMatches[1].mUnits, 2 * UNITS_SCALE);
+    EXPECT_EQ(result.mMatches[2].mSellIndex, 3U);
+    EXPECT_EQ(result.mMatches[2].mBuyIndex, 1U);
+    EXPECT_EQ(result.mMatches[2].mBuyUnitPrice, 12 * MONEY_SCALE);
+
+    ASSERT_EQ(result.mOpenLots.size(), 1U);
+    EXPECT_EQ(result.mOpenLots[0].mConsumed, 3 * UNITS_SCALE);
+    EXPECT_EQ(result.mUnmatchedSellUnits, 0);
+}
+
+TEST(FifoMatcherTest, ProcessesUnsortedInputChronologically) {
+    TradeInstrument instrument;
+    instrument.mTransactions = {
+        MakeTrade(MakeDate(2024, 5, 1), TradeSide::Sell, 20 * MONEY_SCALE, 1 * UNITS_SCALE),
+        MakeTrade(MakeDate(2024, 1, 1), TradeSide::Buy, 10 * MONEY_SCALE, 1 * UNITS_SCALE),
+    };
+
+    const auto result = FifoMatcher{}.match(instrument);
+
+    ASSERT_EQ(result.mMatches.size(), 1U);
+    EXPECT_EQ(result.mMatches[0].mSellIndex, 0U);
+    EXPECT_EQ(result.mMatches[0].mBuyIndex, 1U);
+    EXPECT_TRUE(result.mOpenLots.empty());
+}
+
+TEST(FifoMatcherTest, ReportsSellsWithoutOpenLots) {
+    TradeInstrument instrument;
+    instrument.mTransactions = {
+        MakeTrade(MakeDate(2024, 1, 1), TradeSide::Buy, 10 * MONEY_SCALE, 1 * UNITS_SCALE),
+        MakeTrade(MakeDate(2024, 2, 1), TradeSide::Sell, 11 * MONEY_SCALE, 3 * UNITS_SCALE),
+    };
+
+    const auto result = FifoMatcher{}.match(instrument);
+
+    ASSERT_EQ(result.mMatches.size(), 1U);
+    EXPECT_EQ(result.mUnmatchedSellUnits, 2 * UNITS_SCALE);
+}
+
+TEST(FifoMatcherTest, ParallelMatchingEqualsSerialOrder) {
+    std::vector<TradeInstrument> instruments(6);
+    for (std::size_t index = 0; index < instruments.size(); ++index) {
+        auto& instrument = instruments[index];
+        instrument.mIsin = "XS000000000" + std::to_string(index);
+        const int tradeCount = static_cast<int>(index % 3) * 200 + 2;
+        for (int trade = 0; trade < tradeCount; ++trade) {
+            const auto side = trade % 2 == 0 ? TradeSide::Buy : TradeSide::Sell;
+            instrument.mTransactions.push_back(
+                MakeTrade(MakeDate(2020, 1, 1) + DayDuration{trade}, side,
+                          (10 + trade) * MONEY_SCALE, (trade % 5 + 1) * UNITS_SCALE));
+        }
+    }
+
+    ThreadPool pool{4};
+    const FifoMatcher matcher;
+    const auto parallel = matcher.matchAll(instruments, pool);
+
+    ASSERT_EQ(parallel.size(), instruments.size());
+    for (std::size_t index = 0; index < instruments.size(); ++index) {
+        const auto serial = matcher.match(instruments[index]);
+        EXPECT_EQ(parallel[index].mIsin, instruments[index].mIsin);
+        ASSERT_EQ(parallel[index].mMatches.size(), serial.mMatches.size());
+        for (std::size_t match = 0; match < serial.mMatches.size(); ++match) {
+            EXPECT_EQ(parallel[index].mMatches[match].mBuyIndex, serial.mMatches[match].mBuyIndex);
+            EXPECT_EQ(parallel[index].mMatches[match].mUnits, serial.mMatches[match].mUnits);
+        }
+        EXPECT_EQ(parallel[index].mUnmatchedSellUnits, serial.mUnmatchedSellUnits);
+    }
+}
+
+TEST(FifoMatcherTest, ResumingFromYearEndSnapshotMatchesFullReplay) {
+    TradeInstrument history;
+    history.mIsin = "DE0005140008";
+    for (int year = 2011; year <= 2026; ++year) {
+        history.mTransactions.push_back(MakeTrade(MakeDate(year, 2, 1), TradeSide::Buy,
+                                                  year * MONEY_SCALE, 3 * UNITS_SCALE));
+        history.mTransactions.push_back(MakeTrade(MakeDate(year, 9, 1), TradeSide::Sell,
+                                                  (year + 5) * MONEY_SCALE, 2 * UNITS_SCALE));
+    }
+
+    const FifoMatcher matcher{FifoMatcherOptions{true}};
+    const auto fullReplay = matcher.match(history);
+    ASSERT_EQ(fullReplay.mYearEndSnapshots.size(), 16U);
+
+    const auto& snapshot2025 = fullReplay.mYearEndSnapshots[14];
+    ASSERT_EQ(snapshot2025.mYear, 2025);
+    EXPECT_EQ(snapshot2025.mNextTransactionIndex, 30U);
+
+    const auto restored = DeserializeSnapshots(SerializeSnapshots({&snapshot2025, 1}));
+    ASSERT_TRUE(restored.has_value());
+    ASSERT_EQ(restored->size(), 1U);
+
+    TradeInstrument newYear;
+    newYear.mIsin = history.mIsin;
+    newYear.mTransactions.assign(history.mTransactions.begin() + 30, history.mTransactions.end());
+    const auto resumed = matcher.match(newYear, restored->front());
+
+    const auto firstNewMatch =
+        std::find_if(fullReplay.mMatches.begin(), fullReplay.mMatches.end(),
+                     [](const LotMatch& aMatch) { return aMatch.mSellIndex >= 30; });
+    ASSERT_EQ(static_cast<std::size_t>(fullReplay.mMatches.end() - firstNewMatch),
+              resumed.mMatches.size());
+    for (std::size_t index = 0; index < resumed.mMatches.size(); ++index) {
+        EXPECT_EQ(resumed.mMatches[index].mSellIndex, firstNewMatch[index].mSellIndex);
+        EXPECT_EQ(resumed.mMatches[index].mBuyIndex, firstNewMatch[index].mBuyIndex);
+        EXPECT_EQ(resumed.mMatches[index].mUnits, firstNewMatch[index].mUnits);
+        EXPECT_EQ(resumed.mMatches[index].mBuyDate, firstNewMatch[index].mBuyDate);
+    }
+    ASSERT_EQ(resumed.mOpenLots.size(), fullReplay.mOpenLots.size());
+    EXPECT_EQ(resumed.mOpenLots.back().mConsumed, fullReplay.mOpenLots.back().mConsumed);
+}
+
+TEST(FifoMatcherTest, CompactedLotsGiveIdenticalResults) {
+    // Savings plan: several same-day, same-price buys, interleaved with sells. Pairs of
+    // equal-sized buys share a provenance part that sells then split.
+    TradeInstrument instrument;
+    instrument.mIsin = "IE00B4L5Y983";
+    for (int month = 0; month < 36; ++month) {
+        const Date date = MakeDate(2022 + month / 12, static_cast<unsigned>(month % 12 + 1), 2);
+        const Money price = (70 + month % 5) * MONEY_SCALE;
+        for (int part = 0; part < 6; ++part) {
+            instrument.mTransactions.push_back(
+                MakeTrade(date, TradeSide::Buy, price, (part / 2 + 1) * UNITS_SCALE / 7));
+        }
+        if (month % 3 == 2) {
+            instrument.mTransactions.push_back(
+                MakeTrade(date, TradeSide::Sell, price + MONEY_SCALE, UNITS_SCALE));
+            instrument.mTransactions.push_back(MakeTrade(date, TradeSide::Buy, price, 3));
+        }
+    }
+
+    FifoMatcherOptions options;
+    options.mEmitYearEndSnapshots = true;
+    const auto plain = FifoMatcher{options}.match(instrument);
+    options.mCompactLots = true;
+    const auto compacted = FifoMatcher{options}.match(instrument);
+
+    const auto expectSameLots = [](const std::vector<OpenLot>& aLeft,
+                                   const std::vector<OpenLot>& aRight) {
+        ASSERT_EQ(aLeft.size(), aRight.size());
+        for (std::size_t index = 0; index < aLeft.size(); ++index) {
+            EXPECT_EQ(aLeft[index].mTransactionIndex, aRight[index].mTransactionIndex);
+            EXPECT_EQ(aLeft[index].mUnits, aRight[index].mUnits);
+            EXPECT_EQ(aLeft[index].mConsumed, aRight[index].mConsumed);
+            EXPECT_EQ(aLeft[index].mDate, aRight[index].mDate);
+        }
+    };
+
+    ASSERT_EQ(compacted.mMatches.size(), plain.mMatches.size());
+    for (std::size_t index = 0; index < plain.mMatches.size(); ++index) {
+        EXPECT_EQ(compacted.mMatches[index].mSellIndex, plain.mMatches[index].mSellIndex);
+        EXPECT_EQ(compacted.mMatches[index].mBuyIndex, plain.mMatches[index].mBuyIndex);
+        EXPECT_EQ(compacted.mMatches[index].mUnits, plain.mMatches[index].mUnits);
+        EXPECT_EQ(compacted.mMatches[index].mBuyUnitPrice, plain.mMatches[index].mBuyUnitPrice);
+    }
+    expectSameLots(compacted.mOpenLots, plain.mOpenLots);
+    ASSERT_EQ(compacted.mYearEndSnapshots.size(), plain.mYearEndSnapshots.size());
+    for (std::size_t index = 0; index < plain.mYearEndSnapshots.size(); ++index) {
+        expectSameLots(compacted.mYearEndSnapshots[index].mOpenLots,
+                       plain.mYearEndSnapshots[index].mOpenLots);
+    }
+
+    // Resuming a compacting matcher from an expanded snapshot stays exact as well.
+    TradeInstrument tail = instrument;
+    const auto& snapshot = plain.mYearEndSnapshots.front();
+    tail.mTransactions.erase(tail.mTransactions.begin(),
+                             tail.mTransactions.begin() + snapshot.mNextTransactionIndex);
+    const auto resumed = FifoMatcher{options}.match(tail, snapshot);
+    expectSameLots(resumed.mOpenLots, plain.mOpenLots);
+}
+
+TEST(FifoSnapshotTest, RejectsTruncatedData) {
+    OpenLotSnapshot snapshot;
+    snapshot.mIsin = "US0378331005";
+    snapshot.mYear = 2024;
+    snapshot.mOpenLots.push_back(OpenLot{MakeDate(2024, 3, 3), 150 * MONEY_SCALE,
+                                         2 * UNITS_SCALE, UNITS_SCALE / 2, Currency::USD, 7});
+
+    const auto encoded = SerializeSnapshots({&snapshot, 1});
+    EXPECT_FALSE(DeserializeSnapshots(std::string_view{encoded}.substr(0, encoded.size() - 1)));
+
+    const auto decoded = DeserializeSnapshots(encoded);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->front().mOpenLots.front().mDate, MakeDate(2024, 3, 3));
+    EXPECT_EQ(decoded->front().mOpenLots.front().mCurrency, Currency::USD);
+    EXPECT_EQ(decoded->front().mOpenLots.front().mConsumed, UNITS_SCALE / 2);
+}
+
+} // namespace
+} // namespace taxbroker
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include "generators/dho_generator.hpp"
+#include "generators/div_generator.hpp"
+#include "generators/form_batch.hpp"
+#include "utils/date_utils.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace taxbroker {
+namespace {
+
+std::vector<BatchFiling> MakeFilings(std::size_t aCount) {
+    std::vector<BatchFiling> filings(aCount);
+    for (std::size_t index = 0; index < aCount; ++index) {
+        BatchFiling& filing = filings[index];
+        filing.mTaxPayer.mTaxNumber = std::to_string(10'000'000 + index);
+        filing.mTaxPayer.mName = "Taxpayer " + std::to_string(index);
+
+        if (index % 3 != 2) {
+            DohDivData div;
+            div.mYear = 2024;
+            for (std::size_t item = 0; item <= index % 4; ++item) {
+                DivItem dividend;
+                dividend.mDate = MakeDate(2024, 3, static_cast<unsigned>(item + 1));
+                dividend.mPayer.mIsin = "US5949181045";
+                dividend.mGrossIncome = static_cast<Money>(1000 + index) * MONEY_SCALE;
+                dividend.mWithholdingTax = 150 * MONEY_SCALE;
+                div.mItems.push_back(dividend);
+            }
+            filing.mDiv = div;
+        }
+        if (index % 2 == 0) {
+            DohDhoData dho;
+            dho.mYear = 2024;
+            dho.mItems.push_back(
+                DhoItem{DhoPayer::TradeRepublic, static_cast<Money>(index) * MONEY_SCALE, 0});
+            filing.mDho = dho;
+        }
+    }
+    return filings;
+}
+
+std::string ReadFile(const std::string& aPath) {
+    std::ifstream file{aPath, std::ios::binary};
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+TEST(FormBatchTest, MatchesDocumentsRenderedOneByOne) {
+    const auto filings = MakeFilings(60);
+    const auto batch = RenderFormBatch(filings);
+    EXPECT_TRUE(batch.mErrors.empty()) << batch.mErrors.front();
+    ASSERT_EQ(batch.mDocuments.size(), 40U + 30U);
+
+    std::size_t offset = 0;
+    for (const auto& document : batch.mDocuments) {
+        const BatchFiling& filing = filings[document.mFiling];
+        EXPECT_EQ(document.mOffset, offset);
+        offset += document.mLength;
+        if (document.mForm == XmlSchema::DohDiv) {
+            EXPECT_EQ(batch.document(document), GenerateDiv(*filing.mDiv, filing.mTaxPayer));
+            EXPECT_EQ(batch.fileName(document), filing.mTaxPayer.mTaxNumber + "_2024_Doh_Div.xml");
+        } else {
+            EXPECT_EQ(batch.document(document), GenerateDho(*filing.mDho, filing.mTaxPayer));
+            EXPECT_EQ(batch.fileName(document), filing.mTaxPayer.mTaxNumber + "_2024_Doh_DHO.xml");
+        }
+    }
+    EXPECT_EQ(offset, batch.mArena.size());
+}
+
+TEST(FormBatchTest, ReportsViolationsAndSkipsUnusableTaxNumbers) {
+    auto filings = MakeFilings(4);
+    filings[1].mTaxPayer.mTaxNumber = "../etc";
+    filings[2].mTaxPayer.mTaxNumber = "1234";
+
+    const auto batch = RenderFormBatch(filings);
+    ASSERT_EQ(batch.mErrors.size(), 2U);
+    EXPECT_EQ(batch.mErrors[0], "filing 1: tax number '../etc' cannot name a file");
+    EXPECT_EQ(batch.mErrors[1], "1234_2024_Doh_DHO.xml: Envelope/edp:Header/edp:taxpayer/"
+                                "edp:taxNumber: has the wrong number of digits '1234'");
+    EXPECT_EQ(batch.mDocuments.size(), 2U + 1U + 1U);
+}
+
+TEST(FormBatchTest, SkipsDocumentsThatWouldOverwriteAnother) {
+    auto filings = MakeFilings(3);
+    filings[1].mTaxPayer.mTaxNumber = filings[0].mTaxPayer.mTaxNumber;
+    filings[2].mTaxPayer.mTaxNumber = filings[0].mTaxPayer.mTaxNumber;
+    filings[2].mDiv = filings[0].mDiv;
+    filings[2].mDiv->mYear = 2023;
+
+    // Filing 1 repeats filing 0's Doh-Div; filing 2 files another year and Doh-DHO again.
+    const auto batch = RenderFormBatch(filings);
+    ASSERT_EQ(batch.mErrors.size(), 2U);
+    EXPECT_EQ(batch.mErrors[0], "filing 1: 10000000_2024_Doh_Div.xml duplicates an earlier filing");
+    EXPECT_EQ(batch.mErrors[1], "filing 2: 10000000_2024_Doh_DHO.xml duplicates an earlier filing");
+    ASSERT_EQ(batch.mDocuments.size(), 3U);
+    EXPECT_EQ(batch.fileName(batch.mDocuments[2]), "10000000_2023_Doh_Div.xml");
+}
+
+TEST(FormBatchTest, WritesOneFilePerDocument) {
+    const auto filings = MakeFilings(9);
+    const auto batch = RenderFormBatch(filings);
+
+    char directory[] = "/tmp/taxbroker_batch_XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+    EXPECT_EQ(WriteFormBatch(batch, directory), batch.mDocuments.size());
+
+    for (const auto& document : batch.mDocuments) {
+        const auto path = std::string{directory} + "/" + std::string{batch.fileName(document)};
+        EXPECT_EQ(ReadFile(path), batch.document(document));
+        std::remove(path.c_str());
+    }
+    std::remove(directory);
+
+    EXPECT_EQ(WriteFormBatch(batch, "/nonexistent/taxbroker"), 0U);
+}
+
+} // namespace
+} // namespace taxbroker
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include "parsers/ibkr_dividend_join.hpp"
+#include "parsers/ibkr_parser.hpp"
+#include "utils/date_utils.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+namespace taxbroker::ibkr {
+namespace {
+
+TEST(IbkrDividendJoinTest, AttachesWithholdingToDividend) {
+    const std::vector<DividendRow> dividends{
+        {"US5949181045", "MSFT", MakeDate(2024, 3, 14), 75 * MONEY_SCALE, Currency::USD, 1},
+        {"US5949181045", "MSFT", MakeDate(2024, 6, 13), 75 * MONEY_SCALE, Currency::USD, 2},
+        {"US0378331005", "AAPL", MakeDate(2024, 5, 16), 24 * MONEY_SCALE, Currency::USD, 3},
+    };
+    const std::vector<WithholdingRow> withholdings{
+        {"US0378331005", MakeDate(2024, 5, 16), -36 * MONEY_SCALE / 10, Currency::USD, 10},
+        {"US5949181045", MakeDate(2024, 6, 13), -1125 * MONEY_SCALE / 100, Currency::USD, 11},
+        {"US5949181045", MakeDate(2024, 3, 14), -1125 * MONEY_SCALE / 100, Currency::USD, 12},
+    };
+
+    std::vector<ParseWarning> warnings;
+    const auto instruments = JoinDividendWithholding(dividends, withholdings, "ibkr.csv", warnings);
+
+    EXPECT_TRUE(warnings.empty());
+    ASSERT_EQ(instruments.size(), 2U);
+    EXPECT_EQ(instruments[0].mIsin, "US5949181045");
+    EXPECT_EQ(instruments[0].mName, "MSFT");
+    ASSERT_EQ(instruments[0].mTransactions.size(), 2U);
+    EXPECT_EQ(instruments[0].mTransactions[0].mDate, MakeDate(2024, 3, 14));
+    EXPECT_EQ(instruments[0].mTransactions[0].mTaxPaid, 1125 * MONEY_SCALE / 100);
+    EXPECT_EQ(instruments[0].mTransactions[0].mCurrency, Currency::USD);
+    ASSERT_EQ(instruments[1].mTransactions.size(), 1U);
+    EXPECT_EQ(instruments[1].mTransactions[0].mGrossAmount, 24 * MONEY_SCALE);
+    EXPECT_EQ(instruments[1].mTransactions[0].mTaxPaid, 36 * MONEY_SCALE / 10);
+}
+
+TEST(IbkrDividendJoinTest, NetsReversalsAndLaterAdjustments) {
+    const std::vector<DividendRow> dividends{
+        // Reversed and rebooked with a corrected amount on the same day.
+        {"US5949181045", "MSFT", MakeDate(2024, 3, 14), 75 * MONEY_SCALE, Currency::USD, 1},
+        {"US5949181045", "MSFT", MakeDate(2024, 3, 14), -75 * MONEY_SCALE, Currency::USD, 2},
+        {"US5949181045", "MSFT", MakeDate(2024, 3, 14), 80 * MONEY_SCALE, Currency::USD, 3},
+        // Fully reversed a week later.
+        {"US0378331005", "AAPL", MakeDate(2024, 5, 16), 24 * MONEY_SCALE, Currency::USD, 4},
+        {"US0378331005", "AAPL", MakeDate(2024, 5, 23), -24 * MONEY_SCALE, Currency::USD, 5},
+    };
+    const std::vector<WithholdingRow> withholdings{
+        {"US5949181045", MakeDate(2024, 3, 14), -12 * MONEY_SCALE, Currency::USD, 10},
+        // Partial refund booked after the payment.
+        {"US5949181045", MakeDate(2024, 4, 2), 4 * MONEY_SCALE, Currency::USD, 11},
+        {"US0378331005", MakeDate(2024, 5, 16), -36 * MONEY_SCALE / 10, Currency::USD, 12},
+        {"US0378331005", MakeDate(2024, 5, 23), 36 * MONEY_SCALE / 10, Currency::USD, 13},
+    };
+
+    std::vector<ParseWarning> warnings;
+    const auto instruments = JoinDividendWithholding(dividends, withholdings, "ibkr.csv", warnings);
+
+    EXPECT_TRUE(warnings.empty());
+    ASSERT_EQ(instruments.size(), 1U);
+    ASSERT_EQ(instruments[0].mTransactions.size(), 1U);
+    EXPECT_EQ(instruments[0].mTransactions[0].mGrossAmount, 80 * MONEY_SCALE);
+    EXPECT_EQ(instruments[0].mTransactions[0].mTaxPaid, 8 * MONEY_SCALE);
+}
+
+TEST(IbkrDividendJoinTest, WarnsAboutOrphanWithholding) {
+    const std::vector<WithholdingRow> withholdings{
+        {"US5949181045", MakeDate(2024, 1, 5), 2 * MONEY_SCALE, Currency::USD, 7},
+    };
+
+    std::vector<ParseWarning> warnings;
+    const auto instruments = JoinDividendWithholding({}, withholdings, "ibkr.csv", warnings);
+
+    ASSERT_EQ(warnings.size(), 1U);
+    EXPECT_EQ(warnings[0].mRowIndex, 7U);
+    EXPECT_EQ(warnings[0].mSourceFile, "ibkr.csv");
+    ASSERT_EQ(instruments.size(), 1U);
+    EXPECT_EQ(instruments[0].mTransactions[0].mTaxPaid, -2 * MONEY_SCALE);
+}
+
+TEST(IbkrParserTest, JoinsDividendAndWithholdingSections) {
+    const auto path = std::filesystem::temp_directory_path() / "taxbroker_ibkr_statement.csv";
+    std::ofstream{path}
+        << "Statement,Header,Field Name,Field Value\n"
+           "Dividends,Header,Currency,Date,Description,Amount\n"
+           "Dividends,Data,USD,2024-03-14,MSFT(US5949181045) Cash Dividend USD 0.75 per "
+           "Share (Ordinary Dividend),75\n"
+           "Dividends,Data,USD,2024-03-18,MSFT(US5949181045) Cash Dividend USD 0.75 per "
+           "Share - Reversal,-75\n"
+           "Dividends,Data,USD,2024-03-21,MSFT(US5949181045) Cash Dividend USD 0.80 per "
+           "Share (Ordinary Dividend),80\n"
+           "Dividends,Data,Total,,,80\n"
+           "Withholding Tax,Header,Currency,Date,Description,Amount,Code\n"
+           "Withholding Tax,Data,USD,2024-03-21,\"MSFT(US5949181045) Cash Dividend, US Tax\","
+           "-12.00005,\n"
+           "Trades,Header,DataDiscriminator,Asset Category,Currency,Symbol\n"
+           "Trades,Data,Order,Stocks,USD,MSFT\n";
+
+    const auto result = IbkrParser{}.parse(path);
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(result.mWarnings.size(), 1U);
+    EXPECT_EQ(result.mWarnings[0].mCode, WarningCode::UnsupportedRowType);
+    ASSERT_EQ(result.mStatement.mDividendInstruments.size(), 1U);
+    const auto& instrument = result.mStatement.mDividendInstruments[0];
+    EXPECT_EQ(instrument.mIsin, "US5949181045");
+    EXPECT_EQ(instrument.mName, "MSFT");
+    ASSERT_EQ(instrument.mTransactions.size(), 1U);
+    EXPECT_EQ(instrument.mTransactions[0].mDate, MakeDate(2024, 3, 21));
+    EXPECT_EQ(instrument.mTransactions[0].mGrossAmount, 80 * MONEY_SCALE);
+    EXPECT_EQ(instrument.mTransactions[0].mTaxPaid, 120001);
+    EXPECT_EQ(instrument.mTransactions[0].mCurrency, Currency::USD);
+}
+
+TEST(IbkrParserTest, RejectsOverflowingAmountsAndImpossibleDates) {
+    const auto path = std::filesystem::temp_directory_path() / "taxbroker_ibkr_invalid.csv";
+    std::ofstream{path}
+        << "Dividends,Header,Currency,Date,Description,Amount\n"
+           "Dividends,Data,USD,2024-02-30,MSFT(US5949181045) Cash Dividend,75\n"
+           "Dividends,Data,USD,2023-02-29,MSFT(US5949181045) Cash Dividend,75\n"
+           "Dividends,Data,USD,2024-03-14,MSFT(US5949181045) Cash Dividend,"
+           "99999999999999999999999\n"
+           "Dividends,Data,USD,2024-03-15,MSFT(US5949181045) Cash Dividend,922337203685477\n"
+           "Dividends,Data,USD,2024-02-29,MSFT(US5949181045) Cash Dividend,"
+           "922337203685476.9999\n";
+
+    const auto result = IbkrParser{}.parse(path);
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(result.mWarnings.size(), 4U);
+    for (const auto& warning : result.mWarnings) {
+        EXPECT_EQ(warning.mCode, WarningCode::InvalidValue);
+    }
+    ASSERT_EQ(result.mStatement.mDividendInstruments.size(), 1U);
+    const auto& transactions = result.mStatement.mDividendInstruments[0].mTransactions;
+    ASSERT_EQ(transactions.size(), 1U);
+    EXPECT_EQ(transactions[0].mDate, MakeDate(2024, 2, 29));
+    EXPECT_EQ(transactions[0].mGrossAmount, 9223372036854769999);
+}
+
+} // namespace
+} // namespace taxbroker::ibkr
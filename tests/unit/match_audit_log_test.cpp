@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include "core/match_audit_log.hpp"
+#include "processors/fifo_matcher.hpp"
+#include "utils/date_utils.hpp"
+
+namespace taxbroker {
+namespace {
+
+TradeInstrument MakeHistory(std::size_t aMonths) {
+    TradeInstrument instrument;
+    instrument.mIsin = "US5949181045";
+    for (std::size_t month = 0; month < aMonths; ++month) {
+        const Date date = MakeDate(2015, 1, 5) + DayDuration{static_cast<int>(month) * 30};
+        for (int buy = 0; buy < 3; ++buy) {
+            instrument.mTransactions.push_back(TradeTransaction{
+                date, TradeSide::Buy, (100 + buy) * MONEY_SCALE, UNITS_SCALE, Currency::EUR});
+        }
+        instrument.mTransactions.push_back(TradeTransaction{
+            date + DayDuration{10}, TradeSide::Sell, 110 * MONEY_SCALE,
+            25 * UNITS_SCALE / 10, Currency::EUR});
+    }
+    return instrument;
+}
+
+TEST(MatchAuditLogTest, MatcherRecordsQueryableProvenance) {
+    const auto instrument = MakeHistory(120);
+    MatchAuditLog log;
+    FifoMatcherOptions options;
+    options.mAuditLog = &log;
+    const auto matches = FifoMatcher{options}.match(instrument);
+
+    EXPECT_EQ(log.entryCount(), matches.mMatches.size());
+    EXPECT_LT(log.encodedBytes(), matches.mMatches.size() * sizeof(LotMatch) / 4);
+
+    const Date from = MakeDate(2018, 3, 1);
+    const Date to = MakeDate(2019, 6, 30);
+    const auto entries = log.query("", instrument.mIsin, from, to);
+
+    std::vector<LotMatch> expected;
+    for (const auto& match : matches.mMatches) {
+        if (match.mSellDate >= from && match.mSellDate <= to) {
+            expected.push_back(match);
+        }
+    }
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(entries.size(), expected.size());
+    for (std::size_t index = 0; index < entries.size(); ++index) {
+        EXPECT_EQ(entries[index].mSellIndex, expected[index].mSellIndex);
+        EXPECT_EQ(entries[index].mBuyIndex, expected[index].mBuyIndex);
+        EXPECT_EQ(entries[index].mSellDate, expected[index].mSellDate);
+        EXPECT_EQ(entries[index].mBuyDate, expected[index].mBuyDate);
+        EXPECT_EQ(entries[index].mUnits, expected[index].mUnits);
+    }
+
+    EXPECT_TRUE(log.query("", "US0378331005", from, to).empty());
+    EXPECT_TRUE(
+        log.query("", instrument.mIsin, MakeDate(2030, 1, 1), MakeDate(2031, 1, 1)).empty());
+}
+
+TEST(MatchAuditLogTest, RerunReplacesAndResumeExtends) {
+    const auto instrument = MakeHistory(24);
+    MatchAuditLog log;
+    FifoMatcherOptions options;
+    options.mAuditLog = &log;
+    options.mEmitYearEndSnapshots = true;
+
+    const auto full = FifoMatcher{options}.match(instrument);
+    const auto rerun = FifoMatcher{options}.match(instrument);
+    EXPECT_EQ(log.entryCount(), full.mMatches.size());
+
+    MatchAuditLog resumedLog;
+    options.mAuditLog = &resumedLog;
+    options.mEmitYearEndSnapshots = false;
+    const auto& snapshot = full.mYearEndSnapshots.front();
+    TradeInstrument head = instrument;
+    head.mTransactions.resize(snapshot.mNextTransactionIndex);
+    TradeInstrument tail = instrument;
+    tail.mTransactions.erase(tail.mTransactions.begin(),
+                             tail.mTransactions.begin() + snapshot.mNextTransactionIndex);
+    (void)FifoMatcher{options}.match(head);
+    (void)FifoMatcher{options}.match(tail, snapshot);
+
+    EXPECT_EQ(resumedLog.entryCount(), full.mMatches.size());
+    const auto entries = resumedLog.query("", instrument.mIsin, Date::min(), Date::max());
+    ASSERT_EQ(entries.size(), full.mMatches.size());
+    EXPECT_EQ(entries.back().mSellIndex, full.mMatches.back().mSellIndex);
+}
+
+} // namespace
+} // namespace taxbroker
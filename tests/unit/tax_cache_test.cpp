@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include "processors/tax_cache.hpp"
+#include "utils/date_utils.hpp"
+
+namespace taxbroker {
+namespace {
+
+TradeInstrument MakeInstrument() {
+    TradeInstrument instrument;
+    instrument.mIsin = "US5949181045";
+    instrument.mTransactions.push_back(TradeTransaction{MakeDate(2023, 3, 1), TradeSide::Buy,
+                                                        100 * MONEY_SCALE, UNITS_SCALE,
+                                                        Currency::EUR});
+    instrument.mTransactions.push_back(TradeTransaction{MakeDate(2024, 3, 1), TradeSide::Sell,
+                                                        120 * MONEY_SCALE, UNITS_SCALE,
+                                                        Currency::EUR});
+    return instrument;
+}
+
+InstrumentReport MakeReport(const TradeInstrument& aInstrument, int aTaxYear) {
+    InstrumentReport report;
+    report.mMatches = FifoMatcher{}.match(aInstrument);
+    report.mTax = TaxProcessor{aTaxYear}.process(report.mMatches);
+    return report;
+}
+
+TEST(TaxCacheTest, KeyCoversTransactionsActionsAndYear) {
+    const auto instrument = MakeInstrument();
+    const auto key = MakeTaxCacheKey(instrument, 2024);
+    EXPECT_EQ(key, MakeTaxCacheKey(MakeInstrument(), 2024));
+    EXPECT_NE(key, MakeTaxCacheKey(instrument, 2023));
+
+    auto repriced = instrument;
+    repriced.mTransactions[1].mUnitPrice += 1;
+    EXPECT_NE(key, MakeTaxCacheKey(repriced, 2024));
+
+    auto split = instrument;
+    split.mCorporateActions.push_back(
+        CorporateAction{MakeDate(2023, 6, 1), CorporateActionType::Split, 2 * CORP_RATIO_SCALE});
+    EXPECT_NE(key, MakeTaxCacheKey(split, 2024));
+
+    auto renamed = instrument;
+    renamed.mIsin = "US0378331005";
+    EXPECT_NE(key, MakeTaxCacheKey(renamed, 2024));
+}
+
+TEST(TaxCacheTest, ReturnsInsertedReport) {
+    const auto instrument = MakeInstrument();
+    const auto key = MakeTaxCacheKey(instrument, 2024);
+
+    TaxResultCache cache{1 << 20};
+    EXPECT_EQ(cache.find(key), nullptr);
+    cache.insert(key, MakeReport(instrument, 2024));
+
+    const auto cached = cache.find(key);
+    ASSERT_NE(cached, nullptr);
+    ASSERT_EQ(cached->mTax.mSales.size(), 1U);
+    EXPECT_EQ(cached->mTax.mSales[0].mProceeds, 120 * MONEY_SCALE);
+    EXPECT_EQ(cache.hitCount(), 1U);
+    EXPECT_EQ(cache.missCount(), 1U);
+    EXPECT_GT(cache.memoryUsage(), 0U);
+}
+
+TEST(TaxCacheTest, EvictsLeastRecentlyUsedOverBudget) {
+    const auto instrument = MakeInstrument();
+    const auto report = MakeReport(instrument, 2024);
+
+    TaxResultCache probe{1 << 20};
+    probe.insert(MakeTaxCacheKey(instrument, 2024), report);
+    const std::size_t entryBytes = probe.memoryUsage();
+
+    TaxResultCache cache{2 * entryBytes};
+    const auto first = MakeTaxCacheKey(instrument, 2022);
+    const auto second = MakeTaxCacheKey(instrument, 2023);
+    const auto third = MakeTaxCacheKey(instrument, 2024);
+    cache.insert(first, report);
+    cache.insert(second, report);
+    ASSERT_NE(cache.find(first), nullptr); // Now more recent than second.
+    cache.insert(third, report);
+
+    EXPECT_EQ(cache.size(), 2U);
+    EXPECT_LE(cache.memoryUsage(), 2 * entryBytes);
+    EXPECT_NE(cache.find(first), nullptr);
+    EXPECT_EQ(cache.find(second), nullptr);
+    EXPECT_NE(cache.find(third), nullptr);
+}
+
+} // namespace
+} // namespace taxbroker
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include "processors/tax_processor.hpp"
+#include "utils/date_utils.hpp"
+
+namespace taxbroker {
+namespace {
+
+TradeTransaction MakeTrade(Date aDate, TradeSide aSide, Money aUnitPrice, Units aUnits) {
+    return TradeTransaction{aDate, aSide, aUnitPrice, aUnits, Currency::EUR};
+}
+
+InstrumentTaxResult Evaluate(const std::vector<TradeTransaction>& aTransactions, int aYear) {
+    TradeInstrument instrument;
+    instrument.mIsin = "US5949181045";
+    instrument.mTransactions = aTransactions;
+    return TaxProcessor{aYear}.process(FifoMatcher{}.match(instrument));
+}
+
+TEST(TaxProcessorTest, AggregatesSlicesPerSale) {
+    const auto result = Evaluate(
+        {
+            MakeTrade(MakeDate(2023, 1, 10), TradeSide::Buy, 10 * MONEY_SCALE, 2 * UNITS_SCALE),
+            MakeTrade(MakeDate(2023, 2, 10), TradeSide::Buy, 20 * MONEY_SCALE, 2 * UNITS_SCALE),
+            MakeTrade(MakeDate(2024, 6, 1), TradeSide::Sell, 30 * MONEY_SCALE, 3 * UNITS_SCALE),
+        },
+        2024);
+
+    ASSERT_EQ(result.mSales.size(), 1U);
+    EXPECT_EQ(result.mSales[0].mUnits, 3 * UNITS_SCALE);
+    EXPECT_EQ(result.mSales[0].mProceeds, 90 * MONEY_SCALE);
+    EXPECT_EQ(result.mSales[0].mCostBasis, 40 * MONEY_SCALE);
+    EXPECT_FALSE(result.mSales[0].mLossDisallowed);
+}
+
+TEST(TaxProcessorTest, ReportsOnlySalesOfTheTaxYear) {
+    const auto result = Evaluate(
+        {
+            MakeTrade(MakeDate(2022, 1, 10), TradeSide::Buy, 10 * MONEY_SCALE, 2 * UNITS_SCALE),
+            MakeTrade(MakeDate(2023, 3, 1), TradeSide::Sell, 12 * MONEY_SCALE, 1 * UNITS_SCALE),
+            MakeTrade(MakeDate(2024, 3, 1), TradeSide::Sell, 14 * MONEY_SCALE, 1 * UNITS_SCALE),
+        },
+        2024);
+
+    ASSERT_EQ(result.mSales.size(), 1U);
+    EXPECT_EQ(result.mSales[0].mSellIndex, 2U);
+}
+
+TEST(TaxProcessorTest, DisallowsLossWhenRepurchasedAfterSale) {
+    const auto result = Evaluate(
+        {
+            MakeTrade(MakeDate(2024, 1, 10), TradeSide::Buy, 50 * MONEY_SCALE, 1 * UNITS_SCALE),
+            MakeTrade(MakeDate(2024, 6, 1), TradeSide::Sell, 40 * MONEY_SCALE, 1 * UNITS_SCALE),
+            MakeTrade(MakeDate(2024, 6, 20), TradeSide::Buy, 41 * MONEY_SCALE, 1 * UNITS_SCALE),
+        },
+        2024);
+
+    ASSERT_EQ(result.mSales.size(), 1U);
+    EXPECT_TRUE(result.mSales[0].mLossDisallowed);
+}
+
+TEST(TaxProcessorTest, DisallowsLossWhenBoughtShortlyBeforeSale) {
+    const auto result = Evaluate(
+        {
+            MakeTrade(MakeDate(2024, 1, 10), TradeSide::Buy, 50 * MONEY_SCALE, 1 * UNITS_SCALE),
+            MakeTrade(MakeDate(2024, 5, 20), TradeSide::Buy, 39 * MONEY_SCALE, 1 * UNITS_SCALE),
+            MakeTrade(MakeDate(2024, 6, 1), TradeSide::Sell, 40 * MONEY_SCALE, 1 * UNITS_SCALE),
+        },
+        2024);
+
+    ASSERT_EQ(result.mSales.size(), 1U);
+    EXPECT_TRUE(result.mSales[0].mLossDisallowed);
+}
+
+TEST(TaxProcessorTest, IgnoresLotsConsumedBySaleAndBuysOutsideWindow) {
+    const auto result = Evaluate(
+        {
+            MakeTrade(MakeDate(2024, 5, 25), TradeSide::Buy, 50 * MONEY_SCALE, 1 * UNITS_SCALE),
+            MakeTrade(MakeDate(2024, 6, 1), TradeSide::Sell, 40 * MONEY_SCALE, 1 * UNITS_SCALE),
+            MakeTrade(MakeDate(2024, 7, 2), TradeSide::Buy, 41 * MONEY_SCALE, 1 * UNITS_SCALE),
+        },
+        2024);
+
+    ASSERT_EQ(result.mSales.size(), 1U);
+    EXPECT_FALSE(result.mSales[0].mLossDisallowed);
+}
+
+TEST(TaxProcessorTest, BucketsGainsByWholeYearsHeld) {
+    const auto result = Evaluate(
+        {
+            MakeTrade(MakeDate(2009, 3, 1), TradeSide::Buy, 10 * MONEY_SCALE, 1 * UNITS_SCALE),
+            MakeTrade(MakeDate(2019, 3, 2), TradeSide::Buy, 10 * MONEY_SCALE, 1 * UNITS_SCALE),
+            MakeTrade(MakeDate(2019, 3, 1), TradeSide::Buy, 10 * MONEY_SCALE, 1 * UNITS_SCALE),
+            MakeTrade(MakeDate(2024, 3, 1), TradeSide::Sell, 15 * MONEY_SCALE, 3 * UNITS_SCALE),
+        },
+        2024);
+
+    // 2009-03-01 -> 15 years, 2019-03-01 -> exactly 5 years, 2019-03-02 -> one day short.
+    EXPECT_EQ(result.mHoldingPeriods.mGains[0], 5 * MONEY_SCALE);
+    EXPECT_EQ(result.mHoldingPeriods.mGains[1], 5 * MONEY_SCALE);
+    EXPECT_EQ(result.mHoldingPeriods.mGains[2], 0);
+    EXPECT_EQ(result.mHoldingPeriods.mGains[3], 5 * MONEY_SCALE);
+    EXPECT_EQ(result.mHoldingPeriods.mGains[4], 0);
+}
+
+TEST(TaxProcessorTest, SumByHoldingPeriodSkipsDisallowedLosses) {
+    const std::vector<std::int32_t> heldKeys{0, 25 * CALENDAR_KEY_YEAR, 7 * CALENDAR_KEY_YEAR,
+                                             2 * CALENDAR_KEY_YEAR};
+    const std::vector<Money> gains{-4, 9, -6, -1};
+    const std::vector<std::uint8_t> lossRecognized{1, 1, 1, 0};
+
+    const auto totals = SumByHoldingPeriod(heldKeys, gains, lossRecognized);
+
+    EXPECT_EQ(totals.mGains[4], 9);
+    EXPECT_EQ(totals.mLosses[0], -4);
+    EXPECT_EQ(totals.mLosses[1], -6);
+    EXPECT_EQ(totals.mLosses[4], 0);
+}
+
+TEST(TaxProcessorTest, ProcessesYearRangeInOnePass) {
+    TradeInstrument instrument;
+    instrument.mIsin = "US5949181045";
+    instrument.mTransactions = {
+        MakeTrade(MakeDate(2019, 1, 10), TradeSide::Buy, 10 * MONEY_SCALE, 5 * UNITS_SCALE),
+        MakeTrade(MakeDate(2020, 3, 1), TradeSide::Sell, 12 * MONEY_SCALE, 1 * UNITS_SCALE),
+        MakeTrade(MakeDate(2022, 3, 1), TradeSide::Sell, 8 * MONEY_SCALE, 1 * UNITS_SCALE),
+        MakeTrade(MakeDate(2022, 3, 15), TradeSide::Buy, 7 * MONEY_SCALE, 1 * UNITS_SCALE),
+        MakeTrade(MakeDate(2024, 3, 1), TradeSide::Sell, 14 * MONEY_SCALE, 2 * UNITS_SCALE),
+    };
+    const auto matches = FifoMatcher{}.match(instrument);
+
+    const auto years = TaxProcessor{2019, 2025}.processYears(matches);
+
+    ASSERT_EQ(years.size(), 7U);
+    for (std::size_t slot = 0; slot < years.size(); ++slot) {
+        const int year = 2019 + static_cast<int>(slot);
+        const auto single = TaxProcessor{year}.process(matches);
+        EXPECT_EQ(years[slot].mTaxYear, year);
+        ASSERT_EQ(years[slot].mSales.size(), single.mSales.size()) << year;
+        for (std::size_t sale = 0; sale < single.mSales.size(); ++sale) {
+            EXPECT_EQ(years[slot].mSales[sale].mSellIndex, single.mSales[sale].mSellIndex);
+            EXPECT_EQ(years[slot].mSales[sale].mLossDisallowed,
+                      single.mSales[sale].mLossDisallowed);
+        }
+        EXPECT_EQ(years[slot].mHoldingPeriods.mGains, single.mHoldingPeriods.mGains);
+        EXPECT_EQ(years[slot].mHoldingPeriods.mLosses, single.mHoldingPeriods.mLosses);
+    }
+    EXPECT_TRUE(years[2022 - 2019].mSales[0].mLossDisallowed);
+    EXPECT_TRUE(years[2023 - 2019].mSales.empty());
+}
+
+} // namespace
+} // namespace taxbroker
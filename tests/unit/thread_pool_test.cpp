@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include "utils/thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <latch>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace taxbroker {
+namespace {
+
+constexpr int kTaskCount = 8;
+
+std::vector<int> ExpectedOrder() {
+    std::vector<int> order;
+    for (int index = 0; index < kTaskCount; ++index) {
+        order.push_back(index);
+    }
+    return order;
+}
+
+TEST(ThreadPoolTest, SingleWorkerRunsExternalTasksInSubmissionOrder) {
+    ThreadPool pool{1};
+    std::promise<void> release;
+    auto blocker = pool.submit([gate = release.get_future().share()]() { gate.wait(); });
+
+    std::mutex mutex;
+    std::vector<int> order;
+    std::vector<std::future<void>> tasks;
+    for (int index = 0; index < kTaskCount; ++index) {
+        tasks.push_back(pool.submit([&mutex, &order, index]() {
+            const std::lock_guard lock(mutex);
+            order.push_back(index);
+        }));
+    }
+
+    release.set_value();
+    blocker.get();
+    for (auto& task : tasks) {
+        task.get();
+    }
+    EXPECT_EQ(order, ExpectedOrder());
+}
+
+TEST(ThreadPoolTest, ExternalTasksStartInSubmissionOrderAcrossWorkers) {
+    constexpr std::size_t kWorkerCount = 4;
+    ThreadPool pool{kWorkerCount};
+
+    // Park every worker so the queued tasks are only taken by runPendingTask below.
+    std::promise<void> release;
+    const auto gate = release.get_future().share();
+    std::latch parked{static_cast<std::ptrdiff_t>(kWorkerCount)};
+    std::vector<std::future<void>> blockers;
+    for (std::size_t worker = 0; worker < kWorkerCount; ++worker) {
+        blockers.push_back(pool.submit([&parked, gate]() {
+            parked.count_down();
+            gate.wait();
+        }));
+    }
+    parked.wait();
+
+    std::vector<int> order;
+    std::vector<std::future<void>> tasks;
+    for (int index = 0; index < kTaskCount; ++index) {
+        tasks.push_back(pool.submit([&order, index]() { order.push_back(index); }));
+    }
+    while (pool.runPendingTask()) {
+    }
+
+    release.set_value();
+    for (auto& blocker : blockers) {
+        blocker.get();
+    }
+    EXPECT_EQ(order, ExpectedOrder());
+}
+
+TEST(ThreadPoolTest, AwaitAllWaitsForEveryTaskBeforeRethrowing) {
+    ThreadPool pool{2};
+    std::promise<void> release;
+    const auto gate = release.get_future().share();
+    std::atomic<bool> slowFinished{false};
+
+    std::vector<std::future<void>> tasks;
+    tasks.push_back(pool.submit([]() { throw std::runtime_error("first"); }));
+    tasks.push_back(pool.submit([&slowFinished, gate]() {
+        gate.wait();
+        slowFinished = true;
+    }));
+    tasks.push_back(pool.submit([]() { throw std::logic_error("second"); }));
+
+    // Releases the slow task only after awaitAll has seen the first failure.
+    auto releaser = std::async(std::launch::async, [&release]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        release.set_value();
+    });
+    try {
+        pool.awaitAll(std::span{tasks});
+        FAIL() << "awaitAll did not rethrow";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(error.what(), "first");
+    }
+    EXPECT_TRUE(slowFinished);
+    releaser.get();
+}
+
+} // namespace
+} // namespace taxbroker
@@ -0,0 +1,388 @@
+#include <gtest/gtest.h>
+
+#include "generators/kdvp_generator.hpp"
+#include "generators/xml_generator.hpp"
+#include "utils/date_utils.hpp"
+
+#include <array>
+#include <cstdio>
+#include <string>
+
+namespace taxbroker {
+namespace {
+
+TaxPayer MakeTaxPayer() {
+    TaxPayer taxPayer;
+    taxPayer.mTaxNumber = "12345678";
+    taxPayer.mName = "Ana Novak";
+    taxPayer.mCity = "Ljubljana";
+    return taxPayer;
+}
+
+DohKdvpData MakeKdvp(std::size_t aItems, std::size_t aRowsPerItem) {
+    DohKdvpData data;
+    data.mYear = 2024;
+    data.mEmail = "ana@example.com";
+    for (std::size_t item = 0; item < aItems; ++item) {
+        Securities securities;
+        securities.mIsin = "US5949181045";
+        securities.mName = "Microsoft & Co <Class A>";
+        for (std::size_t row = 0; row < aRowsPerItem; ++row) {
+            KdvpRow inventoryRow =
+                row % 2 == 0 ? MakePurchaseRow(MakeDate(2023, 3, 14), GainType::B,
+                                               15 * UNITS_SCALE / 10, 2505 * MONEY_SCALE / 10)
+                             : MakeSaleRow(MakeDate(2024, 6, 3), 15 * UNITS_SCALE / 10, 3101234,
+                                           false);
+            inventoryRow.mId = static_cast<int>(row + 1);
+            inventoryRow.mF8 = row % 2 == 0 ? 15 * UNITS_SCALE / 10 : 0;
+            inventoryRow.mFields |= KdvpRow::F8;
+            securities.mRows.push_back(inventoryRow);
+        }
+
+        KdvpItem kdvpItem;
+        kdvpItem.mItemId = static_cast<int>(item + 1);
+        kdvpItem.mSecurities = securities;
+        data.mItems.push_back(kdvpItem);
+    }
+    return data;
+}
+
+TEST(XmlWriterTest, EscapesTextAndAttributes) {
+    std::string output;
+    XmlWriter writer{output};
+    writer.startElement("Name");
+    writer.attribute("note", R"(say "hi" & <bye>)");
+    writer.text("AT&T <Inc> \"quoted\"");
+    writer.endElement();
+    EXPECT_TRUE(writer.finish());
+
+    EXPECT_EQ(output, "<Name note=\"say &quot;hi&quot; &amp; &lt;bye&gt;\">"
+                      "AT&amp;T &lt;Inc&gt; \"quoted\"</Name>");
+}
+
+TEST(XmlWriterTest, ClosesEmptyElementsAndTracksDepth) {
+    std::string output;
+    XmlWriter writer{output};
+    writer.startElement("a");
+    writer.startElement("b");
+    EXPECT_EQ(writer.depth(), 2U);
+    writer.endElement();
+    writer.integerElement("c", -42);
+    writer.booleanElement("d", true);
+    writer.endElement();
+    EXPECT_EQ(writer.depth(), 0U);
+    EXPECT_TRUE(writer.finish());
+
+    EXPECT_EQ(output, "<a><b/><c>-42</c><d>true</d></a>");
+    EXPECT_EQ(writer.bytesWritten(), output.size());
+}
+
+TEST(XmlWriterTest, FormatsFixedPointDecimals) {
+    std::string output;
+    XmlWriter writer{output};
+    writer.startElement("v");
+    writer.decimalElement("m", 1234567, 4, 2);
+    writer.decimalElement("u", -5, 8, 8);
+    writer.decimalElement("i", 7, 0, 0);
+    writer.endElement();
+    EXPECT_TRUE(writer.finish());
+
+    EXPECT_EQ(output, "<v><m>123.46</m><u>-0.00000005</u><i>7</i></v>");
+}
+
+TEST(XmlWriterTest, WritesNamespacedEnvelope) {
+    std::string output;
+    XmlWriter writer{output};
+    WriteEnvelopeStart(writer, XmlSchema::DohKdvp, FormType::Original, MakeTaxPayer());
+    EXPECT_EQ(writer.depth(), 2U);
+    WriteEnvelopeEnd(writer);
+    EXPECT_TRUE(writer.finish());
+
+    EXPECT_EQ(output.rfind("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Envelope xmlns=\"", 0),
+              0U);
+    EXPECT_NE(output.find(std::string{"xmlns:edp=\""} + std::string{NS_EDP} + "\""),
+              std::string::npos);
+    EXPECT_NE(output.find("<edp:taxpayer><edp:taxNumber>12345678</edp:taxNumber>"
+                          "<edp:taxpayerType>FO</edp:taxpayerType><edp:name>Ana Novak</edp:name>"
+                          "<edp:city>Ljubljana</edp:city><edp:resident>true</edp:resident>"
+                          "</edp:taxpayer>"),
+              std::string::npos);
+    EXPECT_NE(output.find("<edp:DocumentWorkflowID>O</edp:DocumentWorkflowID>"),
+              std::string::npos);
+    EXPECT_NE(output.find("<edp:Signatures/><body></body></Envelope>"), std::string::npos);
+}
+
+TEST(XmlWriterTest, SkeletonEnvelopeMatchesElementByElement) {
+    TaxPayer taxPayer = MakeTaxPayer();
+    taxPayer.mAddress1 = "Trg & <Ulica> 1";
+    taxPayer.mPostNumber = "1000";
+    taxPayer.mBirthDate = MakeDate(1980, 2, 29);
+    taxPayer.mResident = false;
+
+    for (const auto workflow : {FormType::Original, FormType::SelfReport}) {
+        std::string expected;
+        {
+            XmlWriter writer{expected};
+            writer.declaration();
+            writer.startElement("Envelope");
+            writer.namespaceDeclaration("", NS_DOH_DIV);
+            writer.namespaceDeclaration("edp", NS_EDP);
+            writer.startElement("edp:Header");
+            writer.startElement("edp:taxpayer");
+            writer.element("edp:taxNumber", taxPayer.mTaxNumber);
+            writer.element("edp:taxpayerType", taxPayer.mType);
+            writer.element("edp:name", *taxPayer.mName);
+            writer.element("edp:address1", *taxPayer.mAddress1);
+            writer.element("edp:city", *taxPayer.mCity);
+            writer.element("edp:postNumber", *taxPayer.mPostNumber);
+            writer.dateElement("edp:birthDate", *taxPayer.mBirthDate);
+            writer.booleanElement("edp:resident", taxPayer.mResident);
+            writer.endElement();
+            writer.startElement("edp:Workflow");
+            writer.element("edp:DocumentWorkflowID", WorkflowId(workflow));
+            writer.element("edp:DocumentWorkflowName", ToString(workflow));
+            writer.endElement();
+            writer.endElement();
+            writer.startElement("edp:Signatures");
+            writer.endElement();
+            writer.startElement("body");
+            writer.element("Name", "x");
+            writer.endElement();
+            writer.endElement();
+            EXPECT_TRUE(writer.finish());
+        }
+
+        std::string output;
+        XmlWriter writer{output};
+        WriteEnvelopeStart(writer, XmlSchema::DohDiv, workflow, taxPayer);
+        EXPECT_EQ(writer.depth(), 2U);
+        writer.element("Name", "x");
+        WriteEnvelopeEnd(writer);
+        EXPECT_EQ(writer.depth(), 0U);
+        EXPECT_TRUE(writer.finish());
+        EXPECT_EQ(output, expected);
+    }
+}
+
+TEST(XmlWriterTest, SkeletonTracksOpenElements) {
+    static constexpr std::string_view kText = "<a xmlns:p='urn:p'><p:b>\x01</p:b><c/>";
+    static constexpr XmlSkeleton kSkeleton{JoinSkeletonText<kText>()};
+    static_assert(kSkeleton.slotCount() == 1);
+
+    std::string output;
+    XmlWriter writer{output};
+    const std::array<std::string_view, 1> slots{"1 < 2"};
+    writer.skeleton(kSkeleton, slots);
+    EXPECT_EQ(writer.depth(), 1U);
+    writer.element("p:d", "y");
+    writer.endElement();
+    EXPECT_TRUE(writer.finish());
+
+    EXPECT_EQ(output, "<a xmlns:p='urn:p'><p:b>1 &lt; 2</p:b><c/><p:d>y</p:d></a>");
+}
+
+TEST(XmlWriterTest, DescriptorSinkMatchesStringSink) {
+    const auto data = MakeKdvp(40, 25);
+    const auto expected = GenerateKdvp(data, MakeTaxPayer());
+
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    {
+        XmlWriter writer{fileno(file), 512};
+        WriteKdvp(writer, data, MakeTaxPayer());
+        EXPECT_TRUE(writer.finish());
+        EXPECT_EQ(writer.bytesWritten(), expected.size());
+    }
+
+    std::string written(expected.size() + 1, '\0');
+    std::rewind(file);
+    const auto read = std::fread(written.data(), 1, written.size(), file);
+    std::fclose(file);
+    written.resize(read);
+    EXPECT_EQ(written, expected);
+}
+
+TEST(KdvpGeneratorTest, WritesItemsAndRows) {
+    const auto document = GenerateKdvp(MakeKdvp(2, 2), MakeTaxPayer());
+
+    EXPECT_NE(document.find("<Year>2024</Year><PeriodStart>2024-01-01</PeriodStart>"
+                            "<PeriodEnd>2024-12-31</PeriodEnd>"),
+              std::string::npos);
+    EXPECT_NE(document.find("<SecurityCount>2</SecurityCount>"), std::string::npos);
+    EXPECT_NE(document.find("<Email>ana@example.com</Email></KDVP>"), std::string::npos);
+    EXPECT_NE(document.find("<KDVPItem><ItemID>1</ItemID><InventoryListType>PLVP"
+                            "</InventoryListType><Securities><ISIN>US5949181045</ISIN>"
+                            "<Name>Microsoft &amp; Co &lt;Class A&gt;</Name>"
+                            "<IsFond>false</IsFond>"),
+              std::string::npos);
+    EXPECT_NE(document.find("<Row><ID>1</ID><Purchase><F1>2023-03-14</F1><F2>B</F2>"
+                            "<F3>1.50000000</F3><F4>250.50000000</F4></Purchase>"
+                            "<F8>1.50000000</F8></Row>"),
+              std::string::npos);
+    EXPECT_NE(document.find("<Row><ID>2</ID><Sale><F6>2024-06-03</F6><F7>1.50000000</F7>"
+                            "<F9>310.12340000</F9><F10>false</F10></Sale>"
+                            "<F8>0.00000000</F8></Row>"),
+              std::string::npos);
+    EXPECT_NE(document.find("</Doh_KDVP></body></Envelope>\n"), std::string::npos);
+}
+
+TEST(KdvpGeneratorTest, WritesOnlyPresentRowFields) {
+    KdvpRow inherited = MakePurchaseRow(MakeDate(2022, 1, 5), GainType::F, UNITS_SCALE, 0);
+    inherited.mF5 = 125 * MONEY_SCALE;
+    inherited.mF11 = 7 * MONEY_SCALE;
+    inherited.mFields = KdvpRow::DATE | KdvpRow::F2 | KdvpRow::QUANTITY | KdvpRow::F5 |
+                        KdvpRow::F11;
+
+    KdvpRow sold = MakeSaleRow(MakeDate(2024, 2, 1), UNITS_SCALE, 9 * MONEY_SCALE, true);
+    sold.mId = 1;
+    sold.mFields &= ~KdvpRow::F10;
+
+    KdvpItem item;
+    item.mSecurities = Securities{};
+    item.mSecurities->mName = "Fund";
+    item.mSecurities->mRows = {inherited, sold};
+
+    const auto fragment = RenderKdvpItem(item);
+    EXPECT_NE(fragment.find("<Row><ID>0</ID><Purchase><F1>2022-01-05</F1><F2>F</F2>"
+                            "<F3>1.00000000</F3><F5>125.0000</F5><F11>7.00000000</F11>"
+                            "</Purchase></Row>"),
+              std::string::npos);
+    EXPECT_NE(fragment.find("<Row><ID>1</ID><Sale><F6>2024-02-01</F6><F7>1.00000000</F7>"
+                            "<F9>9.00000000</F9></Sale></Row>"),
+              std::string::npos);
+}
+
+TEST(KdvpGeneratorTest, ParallelRenderingMatchesSerial) {
+    auto data = MakeKdvp(301, 7);
+    for (std::size_t index = 0; index < data.mItems.size(); index += 3) {
+        data.mItems[index].mSecurities->mRows.resize(index % 11);
+    }
+    const auto expected = GenerateKdvp(data, MakeTaxPayer());
+
+    ThreadPool pool{4};
+    EXPECT_EQ(GenerateKdvp(data, MakeTaxPayer(), pool), expected);
+
+    const auto fragments = RenderKdvpItems(data, pool);
+    ASSERT_EQ(fragments.size(), data.mItems.size());
+    auto unnumbered = data.mItems[5];
+    unnumbered.mItemId.reset();
+    EXPECT_EQ(*fragments[5], RenderKdvpItem(unnumbered));
+
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    {
+        XmlWriter writer{fileno(file), 256};
+        WriteKdvp(writer, data, MakeTaxPayer(), pool);
+        EXPECT_TRUE(writer.finish());
+    }
+
+    std::string written(expected.size() + 1, '\0');
+    std::rewind(file);
+    written.resize(std::fread(written.data(), 1, written.size(), file));
+    std::fclose(file);
+    EXPECT_EQ(written, expected);
+}
+
+TEST(KdvpGeneratorTest, ParallelRenderingWritesSeveralBatches) {
+    const auto data = MakeKdvp(2 * KDVP_BATCH_ITEMS + 5, 2);
+    ThreadPool pool{4};
+    EXPECT_EQ(GenerateKdvp(data, MakeTaxPayer(), pool), GenerateKdvp(data, MakeTaxPayer()));
+}
+
+TEST(KdvpGeneratorTest, ParallelRenderingHandlesNoItems) {
+    DohKdvpData data;
+    data.mYear = 2024;
+    ThreadPool pool{2};
+    EXPECT_EQ(GenerateKdvp(data, MakeTaxPayer(), pool), GenerateKdvp(data, MakeTaxPayer()));
+}
+
+TEST(KdvpGeneratorTest, FragmentCacheRerendersOnlyChangedItems) {
+    auto data = MakeKdvp(50, 6);
+    for (std::size_t index = 0; index < data.mItems.size(); ++index) {
+        data.mItems[index].mSecurities->mName = "Security " + std::to_string(index);
+    }
+
+    ThreadPool pool{4};
+    FragmentCache cache{1 << 20};
+    EXPECT_EQ(GenerateKdvp(data, MakeTaxPayer(), pool, &cache),
+              GenerateKdvp(data, MakeTaxPayer()));
+    EXPECT_EQ(cache.size(), 50U);
+    EXPECT_EQ(cache.missCount(), 50U);
+
+    data.mItems[7].mSecurities->mRows[1].mUnitValue += 1;
+    const auto regenerated = GenerateKdvp(data, MakeTaxPayer(), pool, &cache);
+    EXPECT_EQ(regenerated, GenerateKdvp(data, MakeTaxPayer()));
+    EXPECT_EQ(cache.hitCount(), 49U);
+    EXPECT_EQ(cache.missCount(), 51U);
+
+    // A new first security shifts every ItemID; only the new item is rendered.
+    data.mItems.insert(data.mItems.begin(), data.mItems[3]);
+    data.mItems.front().mSecurities->mName = "New security";
+    for (std::size_t index = 0; index < data.mItems.size(); ++index) {
+        data.mItems[index].mItemId = static_cast<int>(index + 1);
+    }
+    EXPECT_EQ(GenerateKdvp(data, MakeTaxPayer(), pool, &cache),
+              GenerateKdvp(data, MakeTaxPayer()));
+    EXPECT_EQ(cache.hitCount(), 99U);
+    EXPECT_EQ(cache.missCount(), 52U);
+
+    // Form settings are part of the key.
+    const auto key = MakeKdvpItemKey(data.mItems[0], data);
+    auto selfReport = data;
+    selfReport.mDocId = FormType::SelfReport;
+    EXPECT_NE(MakeKdvpItemKey(data.mItems[0], selfReport), key);
+
+    auto withoutF8 = data.mItems[0];
+    withoutF8.mSecurities->mRows[1].mFields &= ~KdvpRow::F8;
+    EXPECT_NE(MakeKdvpItemKey(withoutF8, data), key);
+}
+
+TEST(FragmentCacheTest, EvictsLeastRecentlyUsedOverBudget) {
+    const auto fragment = std::make_shared<const std::string>(200, 'x');
+    const ContentHash first{1, 1};
+    const ContentHash second{2, 2};
+    const ContentHash third{3, 3};
+
+    FragmentCache cache{700};
+    cache.insert(first, fragment);
+    cache.insert(second, fragment);
+    EXPECT_NE(cache.find(first), nullptr);
+    cache.insert(third, fragment);
+
+    EXPECT_LE(cache.memoryUsage(), 700U);
+    EXPECT_NE(cache.find(first), nullptr);
+    EXPECT_EQ(cache.find(second), nullptr);
+    EXPECT_NE(cache.find(third), nullptr);
+}
+
+#ifndef NDEBUG
+TEST(XmlWriterDeathTest, RejectsMalformedStructure) {
+    EXPECT_DEATH(
+        {
+            std::string output;
+            XmlWriter writer{output};
+            writer.endElement();
+        },
+        "Unbalanced XML end tag");
+    EXPECT_DEATH(
+        {
+            std::string output;
+            XmlWriter writer{output};
+            writer.startElement("edp:Header");
+            writer.text("x");
+        },
+        "undeclared namespace prefix");
+    EXPECT_DEATH(
+        {
+            std::string output;
+            XmlWriter writer{output};
+            writer.startElement("a");
+            writer.text("x");
+            writer.attribute("b", "c");
+        },
+        "attribute outside of a start tag");
+}
+#endif
+
+} // namespace
+} // namespace taxbroker
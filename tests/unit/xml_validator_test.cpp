@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+
+#include "generators/dho_generator.hpp"
+#include "generators/div_generator.hpp"
+#include "generators/kdvp_generator.hpp"
+#include "generators/xml_validator.hpp"
+#include "utils/date_utils.hpp"
+
+#include <string>
+
+namespace taxbroker {
+namespace {
+
+TaxPayer MakeTaxPayer() {
+    TaxPayer taxPayer;
+    taxPayer.mTaxNumber = "12345678";
+    taxPayer.mName = "Ana Novak";
+    return taxPayer;
+}
+
+DohKdvpData MakeKdvp(std::size_t aItems) {
+    DohKdvpData data;
+    data.mYear = 2024;
+    for (std::size_t item = 0; item < aItems; ++item) {
+        KdvpRow bought =
+            MakePurchaseRow(MakeDate(2023, 3, 14), GainType::B, 2 * UNITS_SCALE, 100 * MONEY_SCALE);
+        bought.mId = 0;
+        bought.mF8 = 2 * UNITS_SCALE;
+        bought.mFields |= KdvpRow::F8;
+
+        KdvpRow sold = MakeSaleRow(MakeDate(2024, 6, 3), 2 * UNITS_SCALE, 120 * MONEY_SCALE, false);
+        sold.mId = 1;
+        sold.mF8 = 0;
+        sold.mFields |= KdvpRow::F8;
+
+        Securities securities;
+        securities.mIsin = "US5949181045";
+        securities.mName = "Security " + std::to_string(item);
+        securities.mRows = {bought, sold};
+
+        KdvpItem kdvpItem;
+        kdvpItem.mItemId = static_cast<int>(item + 1);
+        kdvpItem.mSecurities = securities;
+        data.mItems.push_back(kdvpItem);
+    }
+    return data;
+}
+
+// Errors of a <Row> written by aWrite.
+template <typename Write>
+std::vector<std::string> RowErrors(Write aWrite) {
+    const auto* row = FindSchemaElement(XmlSchema::DohKdvp, "Row");
+    EXPECT_NE(row, nullptr);
+    XmlValidator validator{*row};
+    std::string output;
+    XmlWriter writer{output};
+    writer.setValidator(&validator);
+    writer.startElement("Row");
+    aWrite(writer);
+    writer.endElement();
+    EXPECT_TRUE(writer.finish());
+    return validator.errors();
+}
+
+TEST(XmlValidatorTest, AcceptsGeneratedForms) {
+    std::string output;
+    {
+        XmlValidator validator{XmlSchema::DohKdvp};
+        XmlWriter writer{output};
+        writer.setValidator(&validator);
+        WriteKdvp(writer, MakeKdvp(3), MakeTaxPayer());
+        EXPECT_TRUE(writer.finish());
+        EXPECT_TRUE(validator.valid()) << validator.errors().front();
+    }
+    {
+        DohDivData data;
+        data.mYear = 2024;
+        DivItem item;
+        item.mDate = MakeDate(2024, 6, 13);
+        item.mPayer.mIsin = "US5949181045";
+        item.mGrossIncome = 1234567;
+        item.mWithholdingTax = 185185;
+        data.mItems.push_back(item);
+
+        XmlValidator validator{XmlSchema::DohDiv};
+        XmlWriter writer{output};
+        writer.setValidator(&validator);
+        WriteDiv(writer, data, MakeTaxPayer());
+        EXPECT_TRUE(writer.finish());
+        EXPECT_TRUE(validator.valid()) << validator.errors().front();
+    }
+    {
+        DohDhoData data;
+        data.mYear = 2024;
+        data.mItems.push_back(DhoItem{DhoPayer::TradeRepublic, 42 * MONEY_SCALE, 0});
+
+        XmlValidator validator{XmlSchema::DohDho};
+        XmlWriter writer{output};
+        writer.setValidator(&validator);
+        WriteDho(writer, data, MakeTaxPayer());
+        EXPECT_TRUE(writer.finish());
+        EXPECT_TRUE(validator.valid()) << validator.errors().front();
+    }
+}
+
+TEST(XmlValidatorTest, ChecksParallelItemsWithTheirPath) {
+    auto data = MakeKdvp(20);
+    ThreadPool pool{4};
+    FragmentCache cache{1 << 20};
+
+    {
+        std::string output;
+        XmlValidator validator{XmlSchema::DohKdvp};
+        XmlWriter writer{output};
+        writer.setValidator(&validator);
+        WriteKdvp(writer, data, MakeTaxPayer(), pool, &cache);
+        EXPECT_TRUE(writer.finish());
+        EXPECT_TRUE(validator.valid()) << validator.errors().front();
+        EXPECT_EQ(output, GenerateKdvp(data, MakeTaxPayer()));
+    }
+
+    // Fifteen integer digits do not fit typeDecimalPos14_8.
+    data.mItems[4].mSecurities->mRows[0].mUnitValue = 100'000'000'000'000 * MONEY_SCALE;
+    for (int run = 0; run < 2; ++run) {
+        std::string output;
+        XmlValidator validator{XmlSchema::DohKdvp};
+        XmlWriter writer{output};
+        writer.setValidator(&validator);
+        WriteKdvp(writer, data, MakeTaxPayer(), pool, &cache);
+        EXPECT_TRUE(writer.finish());
+        ASSERT_EQ(validator.errors().size(), 1U);
+        EXPECT_EQ(validator.errors()[0],
+                  "Envelope/body/Doh_KDVP/KDVPItem/Securities/Row/Purchase/F4: has too many "
+                  "integer digits '100000000000000.00000000'");
+    }
+}
+
+TEST(XmlValidatorTest, ReportsOrderAndRequiredElements) {
+    EXPECT_EQ(RowErrors([](XmlWriter& aWriter) { aWriter.integerElement("ID", 1); }),
+              std::vector<std::string>{"Row: missing required element 'Purchase'"});
+
+    EXPECT_EQ(RowErrors([](XmlWriter& aWriter) {
+                  aWriter.integerElement("ID", 1);
+                  aWriter.startElement("Sale");
+                  aWriter.endElement();
+                  aWriter.integerElement("ID", 2);
+              }),
+              std::vector<std::string>{"Row: element out of order 'ID'"});
+
+    EXPECT_EQ(RowErrors([](XmlWriter& aWriter) {
+                  aWriter.integerElement("ID", 1);
+                  aWriter.startElement("Purchase");
+                  aWriter.endElement();
+                  aWriter.startElement("Sale");
+                  aWriter.endElement();
+              }),
+              std::vector<std::string>{"Row: element out of order 'Sale'"});
+
+    EXPECT_EQ(RowErrors([](XmlWriter& aWriter) {
+                  aWriter.integerElement("ID", -1);
+                  aWriter.startElement("Purchase");
+                  aWriter.element("F2", "Z");
+                  aWriter.element("F4", "1.123456789");
+                  aWriter.element("F1", "2024-13-01");
+                  aWriter.endElement();
+                  aWriter.element("Notes", "x");
+              }),
+              (std::vector<std::string>{
+                  "Row/ID: is not a valid integer '-1'",
+                  "Row/Purchase/F2: is not an allowed value 'Z'",
+                  "Row/Purchase/F4: has too many fraction digits '1.123456789'",
+                  "Row/Purchase: element out of order 'F1'",
+                  "Row: unexpected element 'Notes'",
+              }));
+}
+
+TEST(XmlValidatorTest, ChecksTotalDigitsAndSign) {
+    const auto* totals = FindSchemaElement(XmlSchema::DohDho, "Doh_DHO_Totals");
+    ASSERT_NE(totals, nullptr);
+
+    XmlValidator validator{*totals};
+    std::string output;
+    XmlWriter writer{output};
+    writer.setValidator(&validator);
+    writer.startElement("Doh_DHO_Totals");
+    writer.element("TotalInterestEarned", "12345678901.25");
+    writer.element("TotalForeignTaxPaid", "-1.00");
+    writer.element("Notes", std::string(501, 'n'));
+    writer.element("Year", "0999");
+    writer.endElement();
+    EXPECT_TRUE(writer.finish());
+
+    ASSERT_EQ(validator.errorCount(), 4U);
+    EXPECT_EQ(validator.errors()[0],
+              "Doh_DHO_Totals/TotalInterestEarned: has too many digits '12345678901.25'");
+    EXPECT_EQ(validator.errors()[1],
+              "Doh_DHO_Totals/TotalForeignTaxPaid: must not be negative '-1.00'");
+    EXPECT_EQ(validator.errors()[3], "Doh_DHO_Totals/Year: is not a year '0999'");
+}
+
+TEST(XmlValidatorTest, ReportsUnfinishedDocument) {
+    XmlValidator validator{XmlSchema::DohDiv};
+    validator.startElement("Envelope");
+    validator.finish();
+    EXPECT_EQ(validator.errors(),
+              std::vector<std::string>{"Envelope: document ends inside an open element"});
+
+    XmlValidator empty{XmlSchema::DohDiv};
+    empty.finish();
+    EXPECT_EQ(empty.errors(), std::vector<std::string>{"missing root element 'Envelope'"});
+}
+
+} // namespace
+} // namespace taxbroker
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include "core/year_index.hpp"
+#include "utils/date_utils.hpp"
+
+namespace taxbroker {
+namespace {
+
+TradeTransaction MakeTrade(Date aDate, TradeSide aSide) {
+    return TradeTransaction{aDate, aSide, MONEY_SCALE, UNITS_SCALE, Currency::EUR};
+}
+
+TEST(YearIndexTest, PartitionsSortedTransactionsByYear) {
+    std::vector<TradeTransaction> transactions{
+        MakeTrade(MakeDate(2024, 2, 1), TradeSide::Sell),
+        MakeTrade(MakeDate(2021, 5, 3), TradeSide::Buy),
+        MakeTrade(MakeDate(2021, 12, 31), TradeSide::Buy),
+        MakeTrade(MakeDate(2024, 1, 1), TradeSide::Buy),
+        MakeTrade(MakeDate(2022, 7, 7), TradeSide::Sell),
+    };
+    SortByDate(transactions);
+    const YearIndex index{transactions};
+
+    EXPECT_EQ(index.firstYear(), 2021);
+    EXPECT_EQ(index.lastYear(), 2024);
+    EXPECT_EQ(index.range(2021).mBegin, 0U);
+    EXPECT_EQ(index.range(2021).mEnd, 2U);
+    EXPECT_EQ(index.range(2022).mBegin, 2U);
+    EXPECT_EQ(index.range(2022).mEnd, 3U);
+    EXPECT_TRUE(index.range(2023).empty());
+    EXPECT_EQ(index.range(2024).mBegin, 3U);
+    EXPECT_EQ(index.range(2024).mEnd, 5U);
+    EXPECT_TRUE(index.range(2020).empty());
+    EXPECT_TRUE(index.range(2025).empty());
+
+    EXPECT_FALSE(index.hasSells(2021));
+    EXPECT_TRUE(index.hasSells(2022));
+    EXPECT_FALSE(index.hasSells(2023));
+    EXPECT_TRUE(index.hasSells(2024));
+    EXPECT_FALSE(index.hasSells(2030));
+}
+
+TEST(YearIndexTest, SortKeepsSameDayOrder) {
+    std::vector<TradeTransaction> transactions{
+        MakeTrade(MakeDate(2024, 3, 1), TradeSide::Buy),
+        MakeTrade(MakeDate(2024, 1, 1), TradeSide::Buy),
+        MakeTrade(MakeDate(2024, 3, 1), TradeSide::Sell),
+    };
+    SortByDate(transactions);
+
+    EXPECT_EQ(transactions[0].mDate, MakeDate(2024, 1, 1));
+    EXPECT_EQ(transactions[1].mTradeSide, TradeSide::Buy);
+    EXPECT_EQ(transactions[2].mTradeSide, TradeSide::Sell);
+}
+
+TEST(YearIndexTest, IndexesDividends) {
+    const std::vector<DividendTransaction> dividends{
+        {MakeDate(2023, 6, 1), MONEY_SCALE, 0, Currency::EUR},
+        {MakeDate(2024, 6, 1), MONEY_SCALE, 0, Currency::EUR},
+    };
+    const YearIndex index{dividends};
+
+    EXPECT_TRUE(index.hasTransactions(2024));
+    EXPECT_FALSE(index.hasSells(2024));
+    EXPECT_TRUE(YearIndex{}.empty());
+    EXPECT_FALSE(YearIndex{}.hasTransactions(2024));
+}
+
+} // namespace
+} // namespace taxbroker
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include "utils/crc32.hpp"
+#include "utils/zip_writer.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+namespace taxbroker {
+namespace {
+
+std::uint32_t BitwiseCrc32(std::string_view aData) {
+    std::uint32_t crc = 0xFFFFFFFFU;
+    for (const char character : aData) {
+        crc ^= static_cast<unsigned char>(character);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1U) != 0 ? (crc >> 1) ^ 0xEDB88320U : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+std::uint32_t Read16(std::string_view aBytes, std::size_t aOffset) {
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(aBytes[aOffset])) |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(aBytes[aOffset + 1])) << 8;
+}
+
+std::uint32_t Read32(std::string_view aBytes, std::size_t aOffset) {
+    return Read16(aBytes, aOffset) | Read16(aBytes, aOffset + 2) << 16;
+}
+
+struct ZipEntry {
+    std::string mName;
+    std::string mData;
+};
+
+// Entries listed by the central directory, checked against their local headers, which
+// must carry CRC and sizes for streaming readers.
+std::vector<ZipEntry> ReadZip(std::string_view aArchive) {
+    std::vector<ZipEntry> entries;
+    const std::size_t end = aArchive.size() - 22;
+    EXPECT_EQ(Read32(aArchive, end), 0x06054B50U);
+    const std::uint32_t count = Read16(aArchive, end + 10);
+    std::size_t central = Read32(aArchive, end + 16);
+    EXPECT_EQ(central + Read32(aArchive, end + 12), end);
+
+    for (std::uint32_t index = 0; index < count; ++index) {
+        EXPECT_EQ(Read32(aArchive, central), 0x02014B50U);
+        const std::uint32_t crc = Read32(aArchive, central + 16);
+        const std::uint32_t size = Read32(aArchive, central + 24);
+        const std::uint32_t nameLength = Read16(aArchive, central + 28);
+        const std::size_t local = Read32(aArchive, central + 42);
+        ZipEntry entry{std::string{aArchive.substr(central + 46, nameLength)}, {}};
+
+        EXPECT_EQ(Read32(aArchive, local), 0x04034B50U);
+        EXPECT_EQ(Read16(aArchive, local + 6) & (1U << 3), 0U); // No data descriptor.
+        EXPECT_EQ(Read32(aArchive, local + 14), crc);
+        EXPECT_EQ(Read32(aArchive, local + 18), size);
+        EXPECT_EQ(Read32(aArchive, local + 22), size);
+        EXPECT_EQ(aArchive.substr(local + 30, nameLength), entry.mName);
+        const std::size_t data = local + 30 + nameLength + Read16(aArchive, local + 28);
+        entry.mData = std::string{aArchive.substr(data, size)};
+        EXPECT_EQ(Crc32(entry.mData), crc);
+        const std::uint32_t next = Read32(aArchive, data + size);
+        EXPECT_TRUE(next == 0x04034B50U || next == 0x02014B50U); // No data descriptor.
+
+        entries.push_back(std::move(entry));
+        central += 46 + nameLength;
+    }
+    return entries;
+}
+
+TEST(Crc32Test, MatchesReferenceValues) {
+    EXPECT_EQ(Crc32(""), 0U);
+    EXPECT_EQ(Crc32("123456789"), 0xCBF43926U);
+    EXPECT_EQ(Crc32("The quick brown fox jumps over the lazy dog"), 0x414FA339U);
+
+    std::string data;
+    for (int index = 0; index < 10'000; ++index) {
+        data.push_back(static_cast<char>(index * 31 + index / 7));
+    }
+    const std::uint32_t expected = BitwiseCrc32(data);
+    EXPECT_EQ(Crc32(data), expected);
+
+    // Chained over unaligned pieces of every length up to 17.
+    std::uint32_t crc = 0;
+    std::size_t position = 0;
+    for (std::size_t length = 0; position < data.size(); length = (length + 1) % 18) {
+        const auto piece = std::string_view{data}.substr(position, length);
+        crc = Crc32(piece, crc);
+        position += piece.size();
+    }
+    EXPECT_EQ(crc, expected);
+
+    // Pieces around the 64-byte folding threshold, continuing from a non-zero CRC.
+    crc = 0;
+    position = 0;
+    for (std::size_t length = 60; position < data.size(); length = length % 150 + 1) {
+        const auto piece = std::string_view{data}.substr(position, length);
+        crc = Crc32(piece, crc);
+        position += piece.size();
+    }
+    EXPECT_EQ(crc, expected);
+}
+
+TEST(ZipWriterTest, WritesStoredEntriesWithSizesInLocalHeaders) {
+    std::string archive = "prefix";
+    ZipWriter zip{archive};
+    zip.beginEntry("forms/Doh_Div.xml");
+    zip.write("<Envelope>");
+    const std::vector<std::string_view> chunks{"<body>", "", "</body>", "</Envelope>\n"};
+    zip.write(chunks);
+    zip.beginEntry("empty.txt");
+    zip.beginEntry("audit/matches.csv");
+    zip.write("isin\nUS5949181045\n");
+    EXPECT_TRUE(zip.finish());
+    EXPECT_EQ(zip.entryCount(), 3U);
+    EXPECT_EQ(zip.bytesWritten(), archive.size() - 6);
+
+    const auto entries = ReadZip(std::string_view{archive}.substr(6));
+    ASSERT_EQ(entries.size(), 3U);
+    EXPECT_EQ(entries[0].mName, "forms/Doh_Div.xml");
+    EXPECT_EQ(entries[0].mData, "<Envelope><body></body></Envelope>\n");
+    EXPECT_EQ(entries[1].mName, "empty.txt");
+    EXPECT_EQ(entries[1].mData, "");
+    EXPECT_EQ(entries[2].mData, "isin\nUS5949181045\n");
+}
+
+TEST(ZipWriterTest, DescriptorSinkMatchesStringSink) {
+    const std::string large(200'000, 'x');
+    const auto writeArchive = [&large](ZipWriter& aZip) {
+        aZip.beginEntry("small.txt");
+        aZip.write("small");
+        aZip.beginEntry("large.txt");
+        aZip.write(large);
+        aZip.write("tail");
+        EXPECT_TRUE(aZip.finish());
+    };
+
+    std::string expected;
+    ZipWriter stringZip{expected};
+    writeArchive(stringZip);
+
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    ZipWriter fileZip{fileno(file)};
+    writeArchive(fileZip);
+    EXPECT_EQ(fileZip.bytesWritten(), expected.size());
+
+    std::string written(expected.size() + 1, '\0');
+    std::rewind(file);
+    written.resize(std::fread(written.data(), 1, written.size(), file));
+    std::fclose(file);
+    EXPECT_EQ(written, expected);
+    EXPECT_EQ(ReadZip(written)[1].mData, large + "tail");
+}
+
+TEST(ZipWriterTest, UnseekableSinkGetsCompletedHeaders) {
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    const std::string data(10'000, 'y');
+    std::string expected;
+    {
+        ZipWriter stringZip{expected};
+        ZipWriter pipeZip{fds[1]};
+        for (ZipWriter* zip : {&stringZip, &pipeZip}) {
+            zip->beginEntry("first.txt");
+            zip->write(data);
+            zip->beginEntry("second.txt");
+            zip->write("second");
+            EXPECT_TRUE(zip->finish());
+        }
+    }
+    ::close(fds[1]);
+
+    std::string written(expected.size() + 1, '\0');
+    std::size_t size = 0;
+    ssize_t bytes = 0;
+    while ((bytes = ::read(fds[0], written.data() + size, written.size() - size)) > 0) {
+        size += static_cast<std::size_t>(bytes);
+    }
+    ::close(fds[0]);
+    ASSERT_EQ(bytes, 0);
+    written.resize(size);
+    EXPECT_EQ(written, expected);
+    EXPECT_EQ(ReadZip(written)[0].mData, data);
+}
+
+} // namespace
+} // namespace taxbroker